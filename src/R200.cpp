@@ -10,7 +10,8 @@
  */
 
 #include "R200.h"
-#include "Config.h"
+#include "config.h"
+#include "log.h"
 
 R200Driver::R200Driver(HardwareSerial &serial) : _serial(serial)
 {
@@ -19,354 +20,743 @@ R200Driver::R200Driver(HardwareSerial &serial) : _serial(serial)
 
 void R200Driver::begin()
 {
+    // O buffer de RX do driver precisa ser definido antes do begin()
+    _serial.setRxBufferSize(R200_RX_BUFFER_SIZE);
+
     // Configura a UART com 8 bits de dados, sem paridade, 1 stop bit (SERIAL_8N1)
     _serial.begin(R200_BAUDRATE, SERIAL_8N1, R200_RX_PIN, R200_TX_PIN);
 
-    // Pequeno delay para garantir que o hardware da UART estabilize
-    delay(100);
+    // Notificações de tag (e frames sem pedido) entregues aos consumidores
+    _frameQueue = xQueueCreate(R200_FRAME_QUEUE_LEN, sizeof(R200Frame));
+    // Comandos aguardando a task dona da UART
+    _commandQueue = xQueueCreate(R200_COMMAND_QUEUE_LEN, sizeof(R200Command));
+
+    // Única task que toca na serial: envia comandos e casa as respostas.
+    // Prioridade de tempo real no núcleo do rádio: nada da aplicação atrasa uma resposta
+    xTaskCreatePinnedToCore(uartTaskEntry, "R200_UART_Task", R200_UART_TASK_STACK, this,
+                            R200_UART_TASK_PRIORITY, &_uartTask, RADIO_CORE);
+
+    // O evento da UART (FIFO cheia ou linha ociosa por 2 símbolos) acorda a task.
+    // Não usamos a detecção de padrão no 0xDD porque esse byte também aparece
+    // dentro de EPCs e TIDs.
+    _serial.setRxTimeout(2);
+    _serial.onReceive([this]()
+                      {
+                          if (_uartTask != NULL)
+                              xTaskNotifyGive(_uartTask);
+                      },
+                      false);
 }
 
-uint8_t R200Driver::calculateChecksum(uint8_t *data, int length)
+void R200Driver::uartTaskEntry(void *parameter)
 {
-    long sum = 0;
-    // Soma acumulativa de todos os bytes do payload
-    for (int i = 0; i < length; i++)
+    static_cast<R200Driver *>(parameter)->uartTaskLoop();
+}
+
+void R200Driver::uartTaskLoop()
+{
+    R200Frame frame;
+
+    for (;;)
     {
-        sum += data[i];
+        // Dorme até a próxima notificação ou até o fim da janela do comando em curso
+        TickType_t wait = portMAX_DELAY;
+        if (_hasInFlight)
+        {
+            TickType_t elapsed = xTaskGetTickCount() - _inFlightSentAt;
+            TickType_t window = pdMS_TO_TICKS(_inFlight.timeoutMs);
+            wait = (elapsed < window) ? window - elapsed : 0;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        // 1. Drena tudo o que chegou; a resposta do comando em curso o conclui
+        while (_serial.available())
+        {
+            _decoder.push(_serial.read());
+            while (_decoder.next(frame, millis()))
+                dispatchFrame(frame);
+        }
+
+        // 2. Janela esgotada sem resposta
+        if (_hasInFlight &&
+            xTaskGetTickCount() - _inFlightSentAt >= pdMS_TO_TICKS(_inFlight.timeoutMs))
+        {
+            completeInFlight(R200_TIMEOUT, NULL);
+        }
+
+        // 3. Pipeline: a linha está livre, envia o próximo comando imediatamente
+        while (!_hasInFlight && xQueueReceive(_commandQueue, &_inFlight, 0) == pdTRUE)
+        {
+            sendCommand(0x00, _inFlight.cmd, _inFlight.params, _inFlight.paramLen);
+            _inFlightSentAt = xTaskGetTickCount();
+
+            if (_inFlight.timeoutMs == 0)
+                completeInFlight(R200_OK, NULL); // Comando sem resposta direta
+            else
+                _hasInFlight = true;
+        }
     }
-    // Retorna apenas os 8 bits menos significativos (LSB)
-    return (uint8_t)(sum & 0xFF);
 }
 
-void R200Driver::sendCommand(uint8_t type, uint8_t cmd, uint8_t *params,
-                             int paramLen)
+bool R200Driver::enqueue(const R200Command &command)
+{
+    if (xQueueSend(_commandQueue, &command, portMAX_DELAY) != pdTRUE)
+        return false;
+    xTaskNotifyGive(_uartTask);
+    return true;
+}
+
+R200Status R200Driver::execute(uint8_t cmd, const uint8_t *params, int paramLen,
+                               uint32_t timeoutMs, R200Frame *response)
 {
-    uint8_t packet[64]; // Buffer temporário para montagem do pacote de envio
-    int idx = 0;
+    if (paramLen > R200_COMMAND_MAX_PARAMS)
+        return R200_ERROR;
+
+    // O semáforo vive na pilha de quem chama: a task dona da UART sempre conclui
+    // o comando (resposta, erro ou timeout), então a espera abaixo é finita.
+    StaticSemaphore_t doneBuffer;
+    R200Status status = R200_TIMEOUT;
+
+    R200Command command;
+    command.cmd = cmd;
+    command.paramLen = paramLen;
+    if (params != NULL && paramLen > 0)
+        memcpy(command.params, params, paramLen);
+    command.timeoutMs = timeoutMs;
+    command.response = response;
+    command.status = &status;
+    command.elapsedMs = NULL;
+    command.done = xSemaphoreCreateBinaryStatic(&doneBuffer);
 
-    packet[idx++] = FRAME_HEAD; // 0xAA
-    packet[idx++] = type;       // Geralmente 0x00
-    packet[idx++] = cmd;        // Código da instrução
+    if (enqueue(command))
+        xSemaphoreTake(command.done, portMAX_DELAY);
 
-    // O comprimento do parâmetro (PL) é de 2 bytes (Big Endian: MSB primeiro)
-    packet[idx++] = (paramLen >> 8) & 0xFF;
-    packet[idx++] = paramLen & 0xFF;
+    return status;
+}
+
+bool R200Driver::submit(uint8_t cmd, const uint8_t *params, int paramLen, uint32_t timeoutMs)
+{
+    if (paramLen > R200_COMMAND_MAX_PARAMS)
+        return false;
 
-    // Copia os parâmetros opcionais para o pacote
+    R200Command command;
+    command.cmd = cmd;
+    command.paramLen = paramLen;
     if (params != NULL && paramLen > 0)
+        memcpy(command.params, params, paramLen);
+    command.timeoutMs = timeoutMs;
+    command.response = NULL;
+    command.status = NULL;
+    command.elapsedMs = NULL;
+    command.done = NULL;
+
+    return enqueue(command);
+}
+
+void R200Driver::completeInFlight(R200Status status, const R200Frame *frame)
+{
+    if (_inFlight.response != NULL && frame != NULL)
+        *_inFlight.response = *frame;
+    if (_inFlight.status != NULL)
+        *_inFlight.status = status;
+    if (_inFlight.elapsedMs != NULL && status != R200_TIMEOUT)
+        *_inFlight.elapsedMs = (xTaskGetTickCount() - _inFlightSentAt) * portTICK_PERIOD_MS;
+    if (_inFlight.done != NULL)
+        xSemaphoreGive(_inFlight.done);
+    _hasInFlight = false;
+}
+
+void R200Driver::dispatchFrame(const R200Frame &frame)
+{
+    // Erros de inventário (0x15) dos ciclos do 0x27 não respondem a nenhum pedido
+    bool roundError = frame.cmd == 0xFF && _multiPolling && frame.params[0] == 0x15;
+    if (roundError)
+        emptyRounds++;
+
+    if (_hasInFlight)
     {
-        for (int i = 0; i < paramLen; i++)
+        // Resposta casada pelo código do comando, ou erro 0xFF do comando em curso
+        if ((frame.type == 0x01 && frame.cmd == _inFlight.cmd) ||
+            (frame.type == 0x01 && frame.cmd == 0xFF && !roundError))
         {
-            packet[idx++] = params[i];
+            completeInFlight(frame.cmd == 0xFF ? R200_ERROR : R200_OK, &frame);
+            return;
         }
+
+        // A primeira notificação de tag também conclui o Single Polling
+        if (frame.type == 0x02 && _inFlight.cmd == 0x22)
+            completeInFlight(R200_OK, &frame);
     }
 
-    // Calcula o checksum.
-    // Nota: O checksum é calculado a partir do 'Type' (índice 1), ignorando o
-    // Header. O tamanho considerado é: Type(1) + Cmd(1) + PL_MSB(1) + PL_LSB(1) +
-    // Params(paramLen)
-    packet[idx] = calculateChecksum(&packet[1], 4 + paramLen);
-    idx++;
+    // Notificações de tag vão para os consumidores; respostas sem pedido
+    // correspondente (ex: chegaram após o timeout) são descartadas.
+    // Sem espera: se ninguém está consumindo, o frame mais novo é descartado
+    if (frame.type == 0x02)
+    {
+        if (xQueueSend(_frameQueue, &frame, 0) != pdTRUE)
+            droppedFrames++;
+    }
+}
 
-    packet[idx++] = FRAME_END; // 0xDD
+void R200Driver::sendCommand(uint8_t type, uint8_t cmd, uint8_t *params,
+                             int paramLen)
+{
+    uint8_t packet[R200_COMMAND_MAX_PARAMS + 7]; // Buffer temporário para montagem do pacote de envio
+    size_t length = r200BuildFrame(type, cmd, params, paramLen, packet);
 
     // Escreve o pacote completo na porta serial
-    _serial.write(packet, idx);
+    _serial.write(packet, length);
 }
 
-void R200Driver::getHardwareVersion()
+bool R200Driver::getHardwareVersion()
 {
     // Protocolo: Header | Type=00 | Cmd=03 | PL=0000 | Cks | End
-    sendCommand(0x00, 0x03, NULL, 0);
+    return execute(0x03, NULL, 0, 100) == R200_OK;
+}
+
+bool R200Driver::handshake(uint32_t timeoutMs, uint8_t *attempts)
+{
+    // Um frame de erro também prova que o módulo está de pé; só o silêncio conta
+    unsigned long start = millis();
+    uint8_t sent = 0;
+    bool answered = false;
+    do
+    {
+        if (sent < UINT8_MAX)
+            sent++;
+        answered = execute(0x03, NULL, 0, R200_HANDSHAKE_WINDOW_MS) != R200_TIMEOUT;
+    } while (!answered && millis() - start < timeoutMs);
+
+    if (attempts)
+        *attempts = sent;
+    return answered;
 }
 
 void R200Driver::singlePoll()
 {
     // Protocolo: Header | Type=00 | Cmd=22 | PL=0000 | Cks | End
-    sendCommand(0x00, 0x22, NULL, 0);
+    // A linha fica ocupada até a primeira tag (ou o erro 0x15 de campo vazio)
+    submit(0x22, NULL, 0, 60);
+}
+
+void R200Driver::startMultiPoll(uint16_t rounds)
+{
+    // Protocolo: Header | Type=00 | Cmd=27 | PL=0003 | Reservado=22 | CNT(2) | Cks | End
+    uint8_t params[3];
+    params[0] = 0x22;
+    params[1] = (rounds >> 8) & 0xFF;
+    params[2] = rounds & 0xFF;
+
+    // Não há resposta direta: os ciclos respondem com notificações 0x22
+    _multiPolling = true;
+    submit(0x27, params, 3, 0);
 }
 
-void R200Driver::setTxPower(uint8_t dbm)
+void R200Driver::stopMultiPoll()
+{
+    // Protocolo: Header | Type=00 | Cmd=28 | PL=0000 | Cks | End
+    execute(0x28, NULL, 0, 50);
+    _multiPolling = false;
+}
+
+void R200Driver::setTagCallback(R200TagCallback callback, void *context)
+{
+    _tagCallback = callback;
+    _tagCallbackContext = context;
+}
+
+bool R200Driver::setTxPower(uint8_t dbm)
 {
     // Limita entre 0 e 30 dBm (0x1E)
     if (dbm > 30)
         dbm = 30;
+    if (dbm == _txPowerDbm)
+        return true;
 
     // Comando 0xB6: Set Transmit Power
-    // Param 1: 0x00 (Open Loop)
-    // Param 2: Valor em dBm
+    // Params: potência em centésimos de dBm, big-endian (2000 = 0x07D0 = 20 dBm)
+    uint16_t centiDbm = (uint16_t)dbm * 100;
     uint8_t params[2];
-    params[0] = 0x00;
-    params[1] = dbm;
+    params[0] = (centiDbm >> 8) & 0xFF;
+    params[1] = centiDbm & 0xFF;
 
-    Serial.print("[R200] Configurando Potencia para: ");
-    Serial.print(dbm);
-    Serial.println(" dBm");
+    LOG_I("[R200] Configurando Potencia para: %d dBm", (int)dbm);
 
-    sendCommand(0x00, 0xB6, params, 2);
+    if (execute(0xB6, params, 2, 100) != R200_OK)
+        return false;
+    _txPowerDbm = dbm;
+    return true;
 }
 
-void R200Driver::setRegionUS()
+bool R200Driver::getQuery(R200QueryParams &query)
 {
-    uint8_t region = 0x01; // US/Brasil (902-928MHz)
-    Serial.println("[R200] Configurando Regiao para US/Brasil...");
-    sendCommand(0x00, 0x07, &region, 1);
+    // Resposta: palavra do Query em 2 bytes
+    R200Frame frame;
+    if (execute(0x0D, NULL, 0, 100, &frame) != R200_OK || frame.paramLen < 2)
+        return false;
+
+    query = r200UnpackQuery((frame.params[0] << 8) | frame.params[1]);
+    _query = query;
+    _haveQuery = true;
+    return true;
 }
 
-String R200Driver::getTID(String expectedEPC)
+bool R200Driver::setQuery(const R200QueryParams &query)
 {
-    // Comando 0x39: Ler Dados -> Banco 0x02 (TID)
-    // O 0x06 no final significa ler 6 Words (12 bytes) para extrair o Número de Série Único!
-    uint8_t params[9] = {0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x06};
+    uint16_t word = r200PackQuery(query);
+    uint8_t params[2];
+    params[0] = (word >> 8) & 0xFF;
+    params[1] = word & 0xFF;
 
-    while (_serial.available())
-        _serial.read();
-    sendCommand(0x00, 0x39, params, 9);
+    // Resposta: 0x00 = sucesso
+    R200Frame frame;
+    if (execute(0x0E, params, 2, 100, &frame) != R200_OK || frame.paramLen < 1 || frame.params[0] != 0x00)
+        return false;
 
-    unsigned long start = millis();
-    int bufIdx = 0;
-    uint8_t buf[64];
+    _query = query;
+    _haveQuery = true;
+    return true;
+}
 
-    while (millis() - start < 150)
-    {
-        if (_serial.available())
-        {
-            uint8_t b = _serial.read();
-            if (bufIdx == 0 && b != FRAME_HEAD)
-                continue;
-            buf[bufIdx++] = b;
+bool R200Driver::setQ(uint8_t q)
+{
+    R200QueryParams query;
+    if (!_haveQuery && !getQuery(query))
+        return false;
+    if (_query.q == q)
+        return true;
+
+    query = _query;
+    query.q = q;
+    return setQuery(query);
+}
 
-            if (bufIdx >= 5)
-            {
-                int payloadLen = (buf[3] << 8) | buf[4];
-                int expectedTotalLen = payloadLen + 7;
-
-                if (expectedTotalLen > 64 || expectedTotalLen < 7)
-                {
-                    bufIdx = 0;
-                    continue;
-                }
-
-                if (bufIdx == expectedTotalLen)
-                {
-                    if (b == FRAME_END)
-                    {
-                        uint8_t type = buf[1];
-                        uint8_t cmd = buf[2];
-
-                        if (type == 0x01 && cmd == 0x39)
-                        {
-                            int epcLen = buf[5];
-                            int tidStart = 5 + 1 + epcLen;
-                            int tidLen = payloadLen - 1 - epcLen;
-
-                            if (tidLen > 0)
-                            {
-                                // 1. Extrai o EPC que o chip informou junto com o TID
-                                String readEPC = "";
-                                int epcBytes = epcLen - 2; // Subtrai o cabeçalho PC (2 bytes)
-                                for (int i = 0; i < epcBytes; i++)
-                                {
-                                    if (buf[8 + i] < 0x10)
-                                        readEPC += "0";
-                                    readEPC += String(buf[8 + i], HEX);
-                                }
-                                readEPC.toUpperCase();
-
-                                // 2. Extrai o TID (Agora os 12 bytes completos!)
-                                String tid = "";
-                                for (int i = 0; i < tidLen; i++)
-                                {
-                                    if (buf[tidStart + i] < 0x10)
-                                        tid += "0";
-                                    tid += String(buf[tidStart + i], HEX);
-                                }
-                                tid.toUpperCase();
-
-                                // 3. O FILTRO DE MENTIRAS (Anti Cross-Talk)
-                                // Impede que uma etiqueta vizinha "roube" a resposta
-                                if (expectedEPC != "" && readEPC != expectedEPC)
-                                {
-                                    return "";
-                                }
-
-                                return tid;
-                            }
-                        }
-                    }
-                    bufIdx = 0;
-                }
-            }
-        }
-    }
-    return "";
+bool R200Driver::cachedQuery(R200QueryParams &query) const
+{
+    if (_haveQuery)
+        query = _query;
+    return _haveQuery;
 }
 
-bool R200Driver::processIncomingData(R200Tag &outputTag)
+bool R200Driver::getTxPower(uint8_t &dbm)
 {
-    while (_serial.available())
-    {
-        uint8_t b = _serial.read();
+    // Resposta: potência em centésimos de dBm, big-endian
+    R200Frame frame;
+    if (execute(0xB7, NULL, 0, 100, &frame) != R200_OK || frame.paramLen < 2)
+        return false;
+
+    dbm = ((frame.params[0] << 8) | frame.params[1]) / 100;
+    _txPowerDbm = dbm;
+    return true;
+}
 
-        // 1. Sincronização (Ignora ruído inicial)
-        if (_bufferIndex == 0 && b != FRAME_HEAD)
-            continue;
+bool R200Driver::setRegion(uint8_t region)
+{
+    if (region == _region)
+        return true;
+
+    LOG_I("[R200] Configurando Regiao 0x%02X...", region);
+    if (execute(0x07, &region, 1, 100) != R200_OK)
+        return false;
+    _region = region;
+    return true;
+}
 
-        // 2. Armazena no buffer
-        _buffer[_bufferIndex++] = b;
+bool R200Driver::getRegion(uint8_t &region)
+{
+    R200Frame frame;
+    if (execute(0x08, NULL, 0, 100, &frame) != R200_OK || frame.paramLen < 1)
+        return false;
 
-        // 3. Verificação Inteligente de Fim de Pacote baseada no tamanho real (PL)
-        // Só avaliamos o pacote quando já recebemos o Cabeçalho que contém o tamanho
-        if (_bufferIndex >= 5)
-        {
-            // O Payload Length (PL) fica nos bytes 3 (MSB) e 4 (LSB)
-            int payloadLen = (_buffer[3] << 8) | _buffer[4];
+    region = frame.params[0];
+    _region = region;
+    return true;
+}
 
-            // O tamanho total esperado do pacote é:
-            // Header(1) + Type(1) + Cmd(1) + PL(2) + Payload + Checksum(1) + End(1) = Payload + 7
-            int expectedTotalLen = payloadLen + 7;
+bool R200Driver::setChannel(uint8_t channel)
+{
+    if (channel == _channel)
+        return true;
+
+    // 0xAD: 0xFF liga o salto automático, 0x00 desliga (para fixar o canal)
+    uint8_t hopping = (channel == R200_CHANNEL_HOPPING) ? 0xFF : 0x00;
+    if (execute(0xAD, &hopping, 1, 100) != R200_OK)
+        return false;
+    if (channel != R200_CHANNEL_HOPPING && execute(0xAB, &channel, 1, 100) != R200_OK)
+        return false;
+
+    LOG_I("[R200] Canal: %s%u", channel == R200_CHANNEL_HOPPING ? "salto automatico " : "",
+          channel == R200_CHANNEL_HOPPING ? 0u : (unsigned)channel);
+    _channel = channel;
+    return true;
+}
 
-            // Prevenção contra lixo e estouro de memória (descarta pacotes impossíveis)
-            if (expectedTotalLen > 255 || expectedTotalLen < 7)
-            {
-                _bufferIndex = 0;
-                continue;
-            }
+void R200Driver::setAccessTimeouts(uint16_t tidMs, uint16_t writeMs)
+{
+    _tidTimeoutMs = tidMs;
+    _writeTimeoutMs = writeMs;
+}
 
-            // Se o buffer chegou no tamanho exato que o pacote DEVE ter
-            if (_bufferIndex == expectedTotalLen)
-            {
-                if (b == FRAME_END) // Agora sim, confirmamos se o último byte é o 0xDD
-                {
-                    uint8_t cmd = _buffer[2];
-                    uint8_t type = _buffer[1];
-
-                    // CASO 1: Leitura de Tag
-                    if (cmd == 0x22 && type == 0x02)
-                    {
-                        parsePacket(_buffer, _bufferIndex, outputTag);
-                        _bufferIndex = 0;
-                        return true;
-                    }
-                    // CASO 2: Resposta de Escrita
-                    else if (cmd == 0x49)
-                    {
-                        writeStatus = 1;
-                        _bufferIndex = 0;
-                    }
-                    // CASO 3: Erro do R200
-                    else if (cmd == 0xFF)
-                    {
-                        writeStatus = _buffer[5];
-                        _bufferIndex = 0;
-                    }
-                    else
-                    {
-                        _bufferIndex = 0; // Ignora
-                    }
-                }
-                else
-                {
-                    // Chegou no tamanho esperado, mas o último byte não era DD. Lixo de rádio!
-                    _bufferIndex = 0;
-                }
-            }
+bool R200Driver::sleep()
+{
+    if (_asleep)
+        return true;
+
+    // Protocolo: Header | Type=00 | Cmd=17 | PL=0000 | Cks | End; resposta 0x00 = sucesso
+    R200Frame frame;
+    if (execute(0x17, NULL, 0, 100, &frame) != R200_OK || frame.paramLen < 1 || frame.params[0] != 0x00)
+        return false;
+    _asleep = true;
+    return true;
+}
+
+bool R200Driver::wake()
+{
+    if (!_asleep)
+        return true;
+
+    for (int i = 0; i < R200_WAKE_ATTEMPTS; i++)
+    {
+        if (execute(0x03, NULL, 0, R200_WAKE_TIMEOUT_MS) == R200_OK)
+        {
+            _asleep = false;
+            return true;
         }
     }
     return false;
 }
 
-void R200Driver::parsePacket(uint8_t *pkt, int length, R200Tag &tag)
+// Comando 0x39: Ler Dados -> Banco 0x02 (TID)
+// O 0x06 no final significa ler 6 Words (12 bytes) para extrair o Número de Série Único!
+static const uint8_t tidReadParams[9] = {0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x06};
+
+bool R200Driver::getTID(R200TID &tid, const R200Tag *expectedTag)
 {
-    tag.rssi = pkt[5];
+    tid.len = 0;
+
+    // Um erro (tag saiu do campo) conclui o comando na hora, sem esperar a janela
+    R200Frame frame;
+    if (execute(0x39, tidReadParams, sizeof(tidReadParams), _tidTimeoutMs, &frame) != R200_OK)
+        return false;
 
-    int paramLen = (pkt[3] << 8) | pkt[4];
-    int epcLen = paramLen - 5;
+    // Resposta com o TID e o EPC de quem respondeu (Anti Cross-Talk)
+    return r200ParseTidResponse(frame, tid, expectedTag);
+}
 
-    // --- Trava de Segurança ---
-    if (epcLen < 0 || epcLen > 64)
+uint8_t R200Driver::resolveTIDs(const R200Tag *tags, uint8_t count, R200TID *tids)
+{
+    if (count > R200_TID_BATCH_MAX)
+        count = R200_TID_BATCH_MAX;
+
+    R200Frame responses[R200_TID_BATCH_MAX];
+    R200Status statuses[R200_TID_BATCH_MAX];
+    StaticSemaphore_t doneBuffer;
+
+    // Comandos são copiados para a fila: o mesmo rascunho serve para todos
+    R200Command command;
+    command.response = NULL;
+    command.status = NULL;
+    command.elapsedMs = NULL;
+    command.done = NULL;
+
+    // 1. Select vale só para leitura/escrita; o inventário continua vendo todas as tags
+    command.cmd = 0x12;
+    command.paramLen = 1;
+    command.params[0] = 0x02;
+    command.timeoutMs = 50;
+    enqueue(command);
+
+    // 2. Um par Select + Leitura por tag, todos na fila de uma vez
+    for (uint8_t i = 0; i < count; i++)
     {
-        tag.valid = false;
-        return;
+        statuses[i] = R200_TIMEOUT;
+        tids[i].len = 0;
+
+        // Sem Select a leitura viria de qualquer tag: essa fica sem TID
+        command.cmd = 0x0C;
+        command.paramLen = r200BuildSelectParams(tags[i], command.params);
+        if (command.paramLen == 0)
+            continue;
+        command.timeoutMs = 50;
+        command.response = NULL;
+        command.status = NULL;
+        enqueue(command);
+
+        command.cmd = 0x39;
+        command.paramLen = sizeof(tidReadParams);
+        memcpy(command.params, tidReadParams, sizeof(tidReadParams));
+        command.timeoutMs = _tidTimeoutMs;
+        command.response = &responses[i];
+        command.status = &statuses[i];
+        enqueue(command);
     }
 
-    tag.epc = "";
-    for (int i = 0; i < epcLen; i++)
+    // 3. Volta para "sem Select"; os comandos concluem em ordem, então o fim
+    // deste garante que todas as leituras acima já foram respondidas
+    command.cmd = 0x12;
+    command.paramLen = 1;
+    command.params[0] = 0x01;
+    command.timeoutMs = 50;
+    command.response = NULL;
+    command.status = NULL;
+    command.done = xSemaphoreCreateBinaryStatic(&doneBuffer);
+    if (enqueue(command))
+        xSemaphoreTake(command.done, portMAX_DELAY);
+
+    uint8_t resolved = 0;
+    for (uint8_t i = 0; i < count; i++)
     {
-        if (pkt[8 + i] < 0x10)
-            tag.epc += "0";
-        tag.epc += String(pkt[8 + i], HEX);
+        if (statuses[i] == R200_OK && r200ParseTidResponse(responses[i], tids[i], &tags[i]))
+            resolved++;
     }
-    tag.epc.toUpperCase();
-    tag.valid = true;
+    return resolved;
 }
 
-uint8_t R200Driver::hexCharToByte(char c)
+bool R200Driver::processIncomingData(R200Tag &outputTag, uint32_t waitMs)
 {
-    if (c >= '0' && c <= '9')
-        return c - '0';
-    if (c >= 'A' && c <= 'F')
-        return c - 'A' + 10;
-    if (c >= 'a' && c <= 'f')
-        return c - 'a' + 10;
-    return 0;
+    R200Frame frame;
+    TickType_t wait = pdMS_TO_TICKS(waitMs);
+
+    // Só o primeiro frame espera; os seguintes são retirados da fila sem bloquear
+    while (xQueueReceive(_frameQueue, &frame, wait) == pdTRUE)
+    {
+        wait = 0;
+
+        // Só notificações de tag interessam; respostas de comando já foram
+        // entregues a quem os executou
+        if (frame.cmd == 0x22 && frame.type == 0x02)
+        {
+            r200ParseTagNotice(frame, outputTag);
+
+            // No inventário contínuo a tag vai para o callback e
+            // seguimos drenando a fila sem perder os próximos frames
+            if (_multiPolling && _tagCallback != NULL)
+            {
+                if (outputTag.valid)
+                    _tagCallback(outputTag, _tagCallbackContext);
+                continue;
+            }
+            return true;
+        }
+    }
+    return false;
 }
 
-void R200Driver::writeEPC(String newEPC, String password)
+bool R200Driver::waitForTag(R200Tag &outputTag, uint32_t timeoutMs)
 {
-    // 1. Tratamento de Padding (Preenchimento Automático)
-    // O protocolo exige blocos de 16 bits (4 caracteres Hex).
-    // Se não for múltiplo de 4, adicionamos '0' à ESQUERDA até corrigir.
-    while (newEPC.length() % 4 != 0)
+    unsigned long start = millis();
+    unsigned long elapsed;
+
+    while ((elapsed = millis() - start) < timeoutMs)
     {
-        newEPC = "0" + newEPC;
+        if (processIncomingData(outputTag, timeoutMs - elapsed))
+            return true;
     }
+    return false;
+}
 
-    Serial.print("[R200] EPC Ajustado para gravar: ");
-    Serial.println(newEPC);
+int R200Driver::writeEPC(const uint8_t *epc, uint8_t epcLen, uint32_t password, const R200TID *target)
+{
+    // 1. Tratamento de Padding (Preenchimento Automático)
+    // O protocolo exige blocos de 16 bits: um byte sobrando ganha um 0x00 à ESQUERDA.
+    uint8_t data[R200_MAX_EPC_BYTES + 1];
+    if (epcLen > R200_MAX_EPC_BYTES)
+        epcLen = R200_MAX_EPC_BYTES;
+    size_t pad = epcLen % 2;
+    data[0] = 0x00;
+    memcpy(data + pad, epc, epcLen);
+    size_t dataBytes = pad + epcLen;
+
+    if (LOG_ENABLED(LOG_LEVEL_DEBUG))
+    {
+        char hex[2 * sizeof(data) + 1];
+        r200BytesToHex(data, dataBytes, hex, sizeof(hex));
+        LOG_D("[R200] EPC Ajustado para gravar: %s", hex);
+    }
 
     // 2. Preparação dos Parâmetros do Comando 0x49
     // Estrutura: [Pass(4)] + [MemBank(1)] + [StartAddr(2)] + [DataLen(2)] + [Data(N)]
+    // Banco EPC (0x01) a partir da Word 2 (pulamos CRC e PC)
+    uint8_t params[R200_COMMAND_MAX_PARAMS];
+    size_t idx = r200BuildWriteParams(password, 0x01, 2, data, dataBytes, params);
 
-    int dataBytes = newEPC.length() / 2;           // Quantos bytes de dados reais
-    int wordCount = dataBytes / 2;                 // Quantas "Words" de 16 bits
-    int totalParamLen = 4 + 1 + 2 + 2 + dataBytes; // Tamanho total do payload
-
-    uint8_t params[64];
-    int idx = 0;
-
-    // A. Password (4 Bytes) - Padrão 00 00 00 00
-    // (Aqui simplificado, convertendo a string de senha se necessario, ou fixo 0)
-    uint32_t pwd = strtoul(password.c_str(), NULL, 16);
-    params[idx++] = (pwd >> 24) & 0xFF;
-    params[idx++] = (pwd >> 16) & 0xFF;
-    params[idx++] = (pwd >> 8) & 0xFF;
-    params[idx++] = pwd & 0xFF;
-
-    // B. Memory Bank (1 Byte)
-    // 0x01 = Banco EPC
-    params[idx++] = 0x01;
-
-    // C. Start Address (2 Bytes)
-    // Começamos no endereço 2 (pulamos CRC e PC)
-    params[idx++] = 0x00;
-    params[idx++] = 0x02;
-
-    // D. Data Length (2 Bytes) - Quantidade de WORDS
-    params[idx++] = (wordCount >> 8) & 0xFF;
-    params[idx++] = wordCount & 0xFF;
-
-    // E. Dados (O novo EPC)
-    // Converte a String Hex em Bytes Reais
-    for (int i = 0; i < newEPC.length(); i += 2)
+    // 3. Envia o comando
+    // Type=00, Cmd=0x49 (Write)
+    R200Frame response;
+    R200Status status = R200_TIMEOUT;
+    if (target == NULL)
+        status = execute(0x49, params, idx, _writeTimeoutMs, &response);
+    else
     {
-        uint8_t high = hexCharToByte(newEPC[i]);
-        uint8_t low = hexCharToByte(newEPC[i + 1]);
-        params[idx++] = (high << 4) | low;
+        StaticSemaphore_t doneBuffer;
+        R200Command command;
+        command.response = NULL;
+        command.status = NULL;
+        command.elapsedMs = NULL;
+        command.done = NULL;
+
+        // Select só para leitura/escrita, casando o TID do chip escolhido
+        command.cmd = 0x12;
+        command.paramLen = 1;
+        command.params[0] = 0x02;
+        command.timeoutMs = 50;
+        enqueue(command);
+
+        command.cmd = 0x0C;
+        command.paramLen = r200BuildTidSelectParams(*target, command.params);
+        enqueue(command);
+
+        command.cmd = 0x49;
+        command.paramLen = idx;
+        memcpy(command.params, params, idx);
+        command.timeoutMs = _writeTimeoutMs;
+        command.response = &response;
+        command.status = &status;
+        enqueue(command);
+
+        // Volta para "sem Select"; concluído em ordem, garante a resposta acima
+        command.cmd = 0x12;
+        command.paramLen = 1;
+        command.params[0] = 0x01;
+        command.timeoutMs = 50;
+        command.response = NULL;
+        command.status = NULL;
+        command.done = xSemaphoreCreateBinaryStatic(&doneBuffer);
+        if (enqueue(command))
+            xSemaphoreTake(command.done, portMAX_DELAY);
     }
+    LOG_D("Comando de Escrita Enviado...");
 
-    // 3. Envia o comando
-    // Type=00, Cmd=0x49 (Write)
-    sendCommand(0x00, 0x49, params, idx);
-    Serial.println("Comando de Escrita Enviado...");
-}
\ No newline at end of file
+    if (status == R200_OK)
+        return 1;
+    if (status == R200_ERROR)
+        return response.params[0];
+    return 0;
+}
+bool R200Driver::writeVerified(const R200Tag &target, const uint8_t *data, uint8_t dataLen,
+                               const R200TID *knownTid, uint16_t writeTimeoutMs,
+                               uint16_t readTimeoutMs, R200WriteOutcome &outcome)
+{
+    R200Frame tidResponse, writeResponse, verifyResponse;
+    R200Status tidStatus = R200_TIMEOUT;
+    StaticSemaphore_t doneBuffer;
+
+    outcome.writeStatus = R200_TIMEOUT;
+    outcome.verifyStatus = R200_TIMEOUT;
+    outcome.errorCode = 0;
+    outcome.verified = false;
+    outcome.tid.len = 0;
+    outcome.tidMs = 0;
+    outcome.writeMs = 0;
+    outcome.verifyMs = 0;
+
+    // Os dois EPCs viram máscara de Select; sem ela a escrita e a conferência
+    // valeriam para qualquer tag do campo
+    if (dataLen == 0 || dataLen > R200_SELECT_MAX_MASK_BYTES || target.epcLen == 0 ||
+        target.epcLen > R200_SELECT_MAX_MASK_BYTES)
+        return false;
+
+    // O EPC novo também serve de máscara para o Select da conferência
+    R200Tag written;
+    memcpy(written.epc, data, dataLen);
+    written.epcLen = dataLen;
+
+    // Comandos são copiados para a fila: o mesmo rascunho serve para todos
+    R200Command command;
+    command.response = NULL;
+    command.status = NULL;
+    command.elapsedMs = NULL;
+    command.done = NULL;
+
+    // 1. Select só para leitura/escrita, casando o EPC visto no inventário
+    command.cmd = 0x12;
+    command.paramLen = 1;
+    command.params[0] = 0x02;
+    command.timeoutMs = 50;
+    enqueue(command);
+
+    command.cmd = 0x0C;
+    command.paramLen = r200BuildSelectParams(target, command.params);
+    enqueue(command);
+
+    // 2. TID antes de gravar (o EPC ainda identifica a tag)
+    if (knownTid == NULL)
+    {
+        command.cmd = 0x39;
+        command.paramLen = sizeof(tidReadParams);
+        memcpy(command.params, tidReadParams, sizeof(tidReadParams));
+        command.timeoutMs = readTimeoutMs;
+        command.response = &tidResponse;
+        command.status = &tidStatus;
+        command.elapsedMs = &outcome.tidMs;
+        enqueue(command);
+    }
+
+    // 3. Escrita no banco EPC a partir da Word 2
+    command.cmd = 0x49;
+    command.paramLen = r200BuildWriteParams(0, 0x01, 2, data, dataLen, command.params);
+    command.timeoutMs = writeTimeoutMs;
+    command.response = &writeResponse;
+    command.status = &outcome.writeStatus;
+    command.elapsedMs = &outcome.writeMs;
+    enqueue(command);
+
+    // 4. Conferência: quem responde pelo EPC novo precisa ser o mesmo chip
+    command.cmd = 0x0C;
+    command.paramLen = r200BuildSelectParams(written, command.params);
+    command.timeoutMs = 50;
+    command.response = NULL;
+    command.status = NULL;
+    command.elapsedMs = NULL;
+    enqueue(command);
+
+    command.cmd = 0x39;
+    command.paramLen = sizeof(tidReadParams);
+    memcpy(command.params, tidReadParams, sizeof(tidReadParams));
+    command.timeoutMs = readTimeoutMs;
+    command.response = &verifyResponse;
+    command.status = &outcome.verifyStatus;
+    command.elapsedMs = &outcome.verifyMs;
+    enqueue(command);
+
+    // 5. Volta para "sem Select"; concluído em ordem, garante as respostas acima
+    command.cmd = 0x12;
+    command.paramLen = 1;
+    command.params[0] = 0x01;
+    command.timeoutMs = 50;
+    command.response = NULL;
+    command.status = NULL;
+    command.elapsedMs = NULL;
+    command.done = xSemaphoreCreateBinaryStatic(&doneBuffer);
+    if (enqueue(command))
+        xSemaphoreTake(command.done, portMAX_DELAY);
+
+    if (outcome.writeStatus == R200_ERROR)
+        outcome.errorCode = writeResponse.params[0];
+
+    R200TID before;
+    before.len = 0;
+    if (knownTid != NULL)
+        before = *knownTid;
+    else if (tidStatus == R200_OK)
+        r200ParseTidResponse(tidResponse, before, &target);
+
+    // A releitura é a prova: o EPC do chip começa com os dados gravados e o TID
+    // bate com o lido antes. Sem TID anterior não há como saber se quem responde
+    // ao EPC novo é o chip gravado; fica sem confirmação e a próxima rodada tenta de novo
+    R200Tag responder;
+    R200TID after;
+    if (outcome.writeStatus != R200_OK || before.len == 0 ||
+        outcome.verifyStatus != R200_OK ||
+        !r200ParseAccessResponder(verifyResponse, responder) ||
+        responder.epcLen < dataLen || memcmp(responder.epc, data, dataLen) != 0 ||
+        !r200ParseTidResponse(verifyResponse, after, NULL))
+        return false;
+
+    if (!before.equals(after))
+        return false;
+
+    outcome.tid = after;
+    outcome.verified = true;
+    return true;
+}
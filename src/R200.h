@@ -15,34 +15,76 @@
 #define R200_H
 
 #include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "r200_protocol.h"
+
+/** @brief Máximo de tags por chamada de resolveTIDs(). */
+#define R200_TID_BATCH_MAX 8
+
+/** @brief Código de região do 0x07 para US/Brasil (902-928 MHz). */
+#define R200_REGION_US 0x01
+
+/** @brief Canal de setChannel() que liga o salto de frequência automático. */
+#define R200_CHANNEL_HOPPING 0xFF
 
 /**
- * @struct R200Tag
- * @brief Estrutura de dados para representar uma Tag RFID lida.
- *
- * Armazena as informações processadas de uma leitura, convertendo
- * os bytes brutos do protocolo em dados legíveis.
+ * @enum R200Status
+ * @brief Resultado de um comando executado pela task dona da UART.
  */
-struct R200Tag
+enum R200Status
 {
-    /** @brief Código Eletrônico do Produto (EPC) em formato String Hexadecimal.
-     */
-    String epc;
-
-    /**
-     * @brief Indicador de Força do Sinal Recebido (RSSI).
-     * @note No R200, valores mais altos (em Hex) indicam sinal mais forte.
-     */
-    int rssi;
+    R200_OK = 0,  ///< O módulo respondeu ao comando.
+    R200_ERROR,   ///< O módulo respondeu com um frame de erro (0xFF).
+    R200_TIMEOUT  ///< Nenhuma resposta dentro da janela do comando.
+};
 
-    /** @brief Flag auxiliar para indicar se o objeto contém dados válidos. */
-    bool valid;
+/**
+ * @struct R200Command
+ * @brief Pedido enfileirado para a task dona da UART.
+ *
+ * A task envia os comandos na ordem da fila e só libera o próximo quando a
+ * resposta do anterior (mesmo código de comando ou erro 0xFF) chega ou a janela
+ * expira. Quem enfileira com `done` fica bloqueado até a conclusão.
+ */
+struct R200Command
+{
+    uint8_t cmd;                              ///< Código do comando (ex: 0x39).
+    uint8_t paramLen;                         ///< Quantidade de bytes válidos em params.
+    uint8_t params[R200_COMMAND_MAX_PARAMS];  ///< Parâmetros do comando.
+    uint16_t timeoutMs;                       ///< Janela de resposta (0 = não espera resposta).
+    R200Frame *response;                      ///< Destino do frame de resposta (ou NULL).
+    R200Status *status;                       ///< Destino do resultado (ou NULL).
+    uint16_t *elapsedMs;                      ///< Destino do tempo envio -> resposta (ou NULL; não escrito no timeout).
+    SemaphoreHandle_t done;                   ///< Liberado ao concluir (NULL = não bloqueia).
+};
 
-    // --- CONSTRUTOR ---
-    // Assim que você declarar "R200Tag tag;", isso roda automaticamente.
-    R200Tag() : epc(""), rssi(0), valid(false) {}
+/**
+ * @struct R200WriteOutcome
+ * @brief Resultado de writeVerified(), com as latências medidas na linha.
+ */
+struct R200WriteOutcome
+{
+    R200Status writeStatus; ///< Resultado do 0x49.
+    uint8_t errorCode;      ///< Código do frame 0xFF quando writeStatus == R200_ERROR.
+    R200Status verifyStatus;///< Resultado da releitura.
+    bool verified;          ///< A releitura confirmou o EPC novo no chip esperado.
+    R200TID tid;            ///< TID do chip confirmado (len = 0 se não confirmou).
+    uint16_t tidMs;         ///< Latência da leitura do TID antes da escrita (0 = não medida).
+    uint16_t writeMs;       ///< Latência do 0x49 (0 = sem resposta).
+    uint16_t verifyMs;      ///< Latência da releitura (0 = sem resposta).
 };
 
+/**
+ * @brief Assinatura do callback chamado a cada tag notificada no modo contínuo.
+ *
+ * @param tag Tag decodificada a partir do frame 0x22 recebido.
+ * @param context Ponteiro opaco registrado junto com o callback.
+ */
+typedef void (*R200TagCallback)(const R200Tag &tag, void *context);
+
 /**
  * @class R200Driver
  * @brief Classe principal para gerenciamento do módulo R200 via UART.
@@ -60,78 +102,331 @@ public:
     /**
      * @brief Inicializa a porta serial e configurações do módulo.
      *
-     * Configura o baudrate, bits de parada e pinos RX/TX definidos no Config.h.
+     * Configura o baudrate, bits de parada e pinos RX/TX definidos no Config.h,
+     * cria as filas e a task dona da UART (R200_UART_Task). Só essa task lê e
+     * escreve na serial: ela dorme até chegar um comando ou o evento de recepção
+     * da UART, envia os comandos em sequência e casa cada resposta com o pedido.
      */
     void begin();
 
+    /**
+     * @brief Executa um comando e bloqueia até a resposta ou o fim da janela.
+     *
+     * O comando entra na fila da task dona da UART e é enviado assim que a
+     * resposta do comando anterior chegar.
+     *
+     * @param cmd Código do comando.
+     * @param params Parâmetros (ou NULL).
+     * @param paramLen Tamanho dos parâmetros (até R200_COMMAND_MAX_PARAMS).
+     * @param timeoutMs Janela de resposta contada a partir do envio.
+     * @param response Destino opcional do frame de resposta.
+     * @return R200Status Resultado do comando.
+     */
+    R200Status execute(uint8_t cmd, const uint8_t *params, int paramLen,
+                       uint32_t timeoutMs, R200Frame *response = NULL);
+
+    /**
+     * @brief Enfileira um comando sem aguardar a conclusão.
+     *
+     * A resposta ainda ocupa a linha até chegar (ou expirar `timeoutMs`), de modo
+     * que o próximo comando da fila nunca atropela este.
+     *
+     * @return true Se o comando coube na fila.
+     */
+    bool submit(uint8_t cmd, const uint8_t *params, int paramLen, uint32_t timeoutMs);
+
     /**
      * @brief Solicita a versão de hardware do módulo.
      *
      * Envia o comando 0x03. Útil para verificar se o módulo está respondendo
      * e se a fiação está correta (Health Check).
+     *
+     * @return true Se o módulo respondeu.
+     */
+    bool getHardwareVersion();
+
+    /**
+     * @brief Espera o módulo responder depois de ligado (boot).
+     *
+     * Recém-alimentado, o R200 ignora a UART até terminar o próprio boot. Em vez
+     * de um delay fixo, envia o 0x03 com janelas de R200_HANDSHAKE_WINDOW_MS até a
+     * primeira resposta, então o tempo gasto é o do módulo e não o do pior caso.
+     *
+     * @param timeoutMs Tempo máximo de espera.
+     * @param attempts Destino opcional do número de 0x03 enviados.
+     * @return true Se o módulo respondeu dentro de `timeoutMs`.
      */
-    void getHardwareVersion();
+    bool handshake(uint32_t timeoutMs, uint8_t *attempts = NULL);
 
     /**
      * @brief Executa uma leitura única de inventário (Single Polling).
      *
      * Envia o comando 0x22. O módulo liga a antena, busca tags brevemente,
      * responde e desliga a antena. Ideal para testes de baixo consumo.
+     * As tags chegam pela fila de frames (processIncomingData / waitForTag).
      */
     void singlePoll();
 
+    /**
+     * @brief Inicia o inventário contínuo (Multiple Polling).
+     *
+     * Envia o comando 0x27. O módulo executa `rounds` ciclos de inventário
+     * seguidos e emite um frame de notificação 0x22 para cada tag que responder,
+     * sem esperar novos comandos. Os frames são entregues ao callback registrado
+     * em setTagCallback() por processIncomingData().
+     *
+     * @param rounds Quantidade de ciclos de inventário (1 a 65535).
+     */
+    void startMultiPoll(uint16_t rounds);
+
+    /**
+     * @brief Interrompe o inventário contínuo.
+     *
+     * Envia o comando 0x28 e aguarda a confirmação. Notificações que já estavam
+     * em trânsito continuam disponíveis na fila de frames.
+     */
+    void stopMultiPoll();
+
+    /** @brief Indica se um inventário contínuo (0x27) está em andamento. */
+    bool isMultiPolling() const { return _multiPolling; }
+
+    /**
+     * @brief Registra o callback que recebe as tags do inventário contínuo.
+     *
+     * Enquanto o inventário contínuo estiver ativo, processIncomingData() repassa
+     * cada tag ao callback e continua drenando a serial, em vez de retornar na
+     * primeira tag encontrada.
+     *
+     * @param callback Função chamada para cada tag (ou NULL para desativar).
+     * @param context Ponteiro opaco repassado ao callback.
+     */
+    void setTagCallback(R200TagCallback callback, void *context = NULL);
+
     /**
      * @brief Processa os dados que chegam na Buffer Serial.
      *
      * Esta função deve ser chamada repetidamente no loop principal. Ela remonta
-     * os pacotes fragmentados, verifica a integridade e extrai a tag.
+     * os pacotes fragmentados, verifica a integridade e extrai a tag. Durante o
+     * inventário contínuo, as tags são entregues ao callback e a função só
+     * retorna quando a serial esvazia.
      *
      * @param outputTag Referência para armazenar os dados da tag caso encontrada.
+     * @param waitMs Tempo máximo de espera pelo primeiro frame (0 = não bloqueia).
      * @return true Se um pacote de tag válido foi decodificado completamente.
      * @return false Se não há dados ou o pacote ainda está incompleto.
      */
-    bool processIncomingData(R200Tag &outputTag);
+    bool processIncomingData(R200Tag &outputTag, uint32_t waitMs = 0);
+
+    /**
+     * @brief Bloqueia até chegar uma notificação de tag ou esgotar o tempo.
+     *
+     * A task fica suspensa na fila de frames; não há varredura periódica.
+     *
+     * @param outputTag Referência para armazenar os dados da tag.
+     * @param timeoutMs Janela máxima de espera em milissegundos.
+     * @return true Se uma tag foi recebida dentro da janela.
+     */
+    bool waitForTag(R200Tag &outputTag, uint32_t timeoutMs);
+
+    /**
+     * @brief Define a potência de transmissão (0-30 dBm).
+     *
+     * O valor confirmado fica guardado: pedir de novo a potência atual não gera
+     * tráfego na UART, então o controle adaptativo pode chamar a cada rodada.
+     *
+     * @return true Se o módulo confirmou (ou a potência já era essa).
+     */
+    bool setTxPower(uint8_t dbm);
 
-    // Função para definir potência (0-30 dBm)
-    void setTxPower(uint8_t dbm);
+    /** @brief Última potência confirmada pelo módulo (0 = ainda não definida). */
+    uint8_t txPower() const { return _txPowerDbm; }
 
-    // Configuração de Região
-    void setRegionUS();
+    /**
+     * @brief Lê a potência de transmissão atual (comando 0xB7).
+     *
+     * O valor lido passa a ser o confirmado: um setTxPower() igual não gera tráfego.
+     *
+     * @return true Se o módulo respondeu.
+     */
+    bool getTxPower(uint8_t &dbm);
+
+    /**
+     * @brief Lê os parâmetros do Query (comando 0x0D).
+     * @return true Se o módulo respondeu; o valor também fica guardado em cachedQuery().
+     */
+    bool getQuery(R200QueryParams &query);
+
+    /**
+     * @brief Grava os parâmetros do Query (comando 0x0E).
+     * @note O módulo não aceita o comando durante o inventário contínuo: pare o
+     * 0x27 antes e reinicie depois.
+     * @return true Se o módulo confirmou.
+     */
+    bool setQuery(const R200QueryParams &query);
+
+    /**
+     * @brief Troca só o Q, mantendo os demais campos do último Query conhecido.
+     * @return true Se o módulo confirmou (ou o Q já era esse).
+     */
+    bool setQ(uint8_t q);
+
+    /**
+     * @brief Último Query lido ou confirmado, sem tráfego na UART.
+     * @return false Se nenhum Query foi lido ou gravado ainda.
+     */
+    bool cachedQuery(R200QueryParams &query) const;
+
+    /**
+     * @brief Grava a região de operação (comando 0x07), ex.: R200_REGION_US.
+     * @return true Se o módulo confirmou (ou a região já era essa).
+     */
+    bool setRegion(uint8_t region);
+
+    /**
+     * @brief Lê a região de operação (comando 0x08); o valor fica guardado como em getTxPower().
+     * @return true Se o módulo respondeu.
+     */
+    bool getRegion(uint8_t &region);
+
+    /**
+     * @brief Fixa o canal de trabalho (0xAD desliga o salto, 0xAB grava o canal)
+     *        ou, com R200_CHANNEL_HOPPING, liga o salto automático (0xAD).
+     *
+     * O módulo não informa se o salto está ligado: o primeiro pedido sempre vai
+     * para a linha; os seguintes iguais ao confirmado não geram tráfego.
+     *
+     * @return true Se o módulo confirmou.
+     */
+    bool setChannel(uint8_t channel);
+
+    /**
+     * @brief Janelas de resposta das leituras de TID (0x39) e da gravação avulsa (0x49).
+     * @note Chame só da task que usa getTID()/resolveTIDs()/writeEPC().
+     */
+    void setAccessTimeouts(uint16_t tidMs, uint16_t writeMs);
+
+    /**
+     * @brief Coloca o módulo em modo sleep (comando 0x17).
+     *
+     * O módulo mantém a configuração (região, potência, Query), então os valores
+     * guardados no driver continuam valendo depois de wake().
+     *
+     * @return true Se o módulo confirmou (ou já estava dormindo).
+     */
+    bool sleep();
+
+    /**
+     * @brief Acorda o módulo depois de sleep().
+     *
+     * Qualquer byte na UART acorda o R200, mas o comando que o acordou pode se
+     * perder: envia o 0x03 até R200_WAKE_ATTEMPTS vezes com uma janela curta.
+     *
+     * @return true Se o módulo respondeu (ou não estava dormindo).
+     */
+    bool wake();
+
+    /** @brief Indica se o módulo está em sleep. */
+    bool isAsleep() const { return _asleep; }
 
     /**
      * @brief Lê o banco de memória TID (Tag ID) da etiqueta em campo.
-     * @return String contendo o TID em Hexadecimal, ou vazio se falhar.
+     *
+     * @param tid Destino dos bytes do TID.
+     * @param expectedTag Se informado, a resposta só é aceita quando o EPC que o
+     * chip devolveu junto com o TID é o desta tag (Anti Cross-Talk).
+     * @return true Se o TID foi lido.
+     */
+    bool getTID(R200TID &tid, const R200Tag *expectedTag = NULL);
+
+    /**
+     * @brief Lê o TID de várias tags já inventariadas, uma transação curta por tag.
+     *
+     * Liga o Select só para operações de acesso (0x12 modo 0x02), enfileira de
+     * uma vez um par Select(EPC) + Leitura(TID) por tag e volta o modo para
+     * "sem Select" (0x01) no fim. A task dona da UART encadeia os comandos sem
+     * intervalo, e cada leitura só é respondida pela tag cujo EPC foi selecionado.
+     * A resposta ainda passa pelo filtro Anti Cross-Talk de getTID().
+     *
+     * @param tags Tags vindas do inventário (até R200_TID_BATCH_MAX).
+     * @param count Quantidade de tags.
+     * @param tids Destino, na mesma ordem (len = 0 para as que falharam).
+     * @return Quantidade de TIDs lidos.
      */
-    String getTID(String expectedEPC = "");
+    uint8_t resolveTIDs(const R200Tag *tags, uint8_t count, R200TID *tids);
 
     /**
      * @brief Escreve um novo código EPC na etiqueta.
      * @note A etiqueta deve estar próxima da antena. Cuidado para não ter várias tags perto!
      *
-     * @param newEPC String hexadecimal com o novo ID (ex: "E2001122").
-     * Deve ter numero par de caracteres (múltiplo de 4 é ideal).
-     * @param password Senha de acesso (Padrão é "00000000").
+     * @param epc Bytes do novo EPC; um número ímpar de bytes ganha um 0x00 à
+     * esquerda para fechar Words de 16 bits.
+     * @param epcLen Quantidade de bytes (até R200_MAX_EPC_BYTES).
+     * @param password Senha de acesso (Padrão é 0x00000000).
+     * @param target Se informado, a escrita vai com Select no TID (0x12 modo 0x02,
+     * Select, Escrita, volta para "sem Select"): só esse chip grava, mesmo com
+     * outras tags no campo.
+     * @return Status da escrita (0=Sem resposta, 1=Sucesso, >1=Código de erro do R200).
      */
-    void writeEPC(String newEPC, String password = "00000000");
-
-    int writeStatus = 0; ///< Status da última operação de escrita (0=Nada, 1=Sucesso, >1=Erro).
-
-private:
-    HardwareSerial &_serial; ///< Referência para a instância da Serial física.
-    uint8_t _buffer[256];    ///< Buffer circular para remontagem de pacotes.
-    int _bufferIndex = 0;    ///< Índice atual de escrita no buffer.
+    int writeEPC(const uint8_t *epc, uint8_t epcLen, uint32_t password = 0, const R200TID *target = NULL);
 
     /**
-     * @brief Calcula o Checksum do protocolo R200.
+     * @brief Grava e confere uma tag numa única sequência de comandos.
+     *
+     * Enfileira de uma vez: Select só para acesso (0x12 modo 0x02), Select no EPC
+     * atual, Leitura do TID (se @p knownTid não vier), Escrita (0x49), Select no
+     * EPC novo, Leitura do TID de conferência e volta para "sem Select". A task
+     * dona da UART encadeia tudo sem idas e voltas à task que chamou.
      *
-     * O checksum é a soma de todos os bytes (Type até o último Parâmetro),
-     * pegando apenas o byte menos significativo (LSB).
+     * A gravação só é dada como confirmada pela releitura: o 0x49 precisa ter sido
+     * aceito e o chip que responde ao EPC novo precisa devolver esse EPC e o mesmo
+     * TID visto antes da escrita. Sem TID anterior (@p knownTid nulo e leitura
+     * falha) a gravação fica sem confirmação.
      *
-     * @param data Ponteiro para o array de bytes.
-     * @param length Quantidade de bytes a somar.
-     * @return uint8_t O byte de checksum calculado.
+     * @param target Tag vinda do inventário (o EPC atual vira a máscara do Select).
+     * @param data Novo EPC (quantidade par de bytes, menos que R200_MAX_EPC_BYTES: vira máscara do Select).
+     * @param dataLen Tamanho do novo EPC em bytes.
+     * @param knownTid TID já conhecido da tag (ou NULL para ler antes de gravar).
+     * @param writeTimeoutMs Janela do 0x49.
+     * @param readTimeoutMs Janela de cada 0x39.
+     * @param outcome Resultado detalhado e latências medidas.
+     * @return true Se a releitura confirmou a gravação.
      */
-    uint8_t calculateChecksum(uint8_t *data, int length);
+    bool writeVerified(const R200Tag &target, const uint8_t *data, uint8_t dataLen,
+                       const R200TID *knownTid, uint16_t writeTimeoutMs,
+                       uint16_t readTimeoutMs, R200WriteOutcome &outcome);
+
+    uint32_t droppedFrames = 0; ///< Frames descartados por falta de espaço na fila.
+    volatile uint32_t emptyRounds = 0; ///< Ciclos do 0x27 que terminaram sem tag (erro 0x15).
+
+    /** @brief Erros de checksum/enquadramento e bytes de ruído vistos na UART. */
+    const R200DecoderStats &lineStats() const { return _decoder.stats(); }
+
+    /** @brief Task dona da UART (NULL antes do begin()), para relatórios de pilha. */
+    TaskHandle_t uartTask() const { return _uartTask; }
+
+private:
+    HardwareSerial &_serial;   ///< Referência para a instância da Serial física.
+    R200FrameDecoder _decoder; ///< Remontador dos frames que chegam da UART.
+
+    QueueHandle_t _frameQueue = NULL;   ///< Notificações de tag aguardando consumo.
+    QueueHandle_t _commandQueue = NULL; ///< Comandos aguardando a vez de ir para a linha.
+    TaskHandle_t _uartTask = NULL;    ///< Task dona da UART (único leitor/escritor).
+
+    R200Command _inFlight;            ///< Comando enviado aguardando resposta.
+    bool _hasInFlight = false;        ///< true enquanto _inFlight ocupa a linha.
+    TickType_t _inFlightSentAt = 0;   ///< Tick em que _inFlight foi enviado.
+
+    volatile bool _multiPolling = false;    ///< true entre startMultiPoll() e stopMultiPoll().
+    volatile bool _asleep = false;          ///< true entre sleep() e um wake() bem-sucedido.
+    volatile uint8_t _txPowerDbm = 0;       ///< Potência confirmada pelo último 0xB6 (ou lida no 0xB7).
+    uint8_t _region = 0;                     ///< Região confirmada (0 = desconhecida).
+    uint16_t _channel = 0x100;               ///< Canal confirmado (0x100 = desconhecido).
+    uint16_t _tidTimeoutMs = 150;            ///< Janela do 0x39 (ver setAccessTimeouts()).
+    uint16_t _writeTimeoutMs = 800;          ///< Janela do 0x49 da gravação avulsa.
+    R200QueryParams _query;                  ///< Último Query lido/confirmado.
+    bool _haveQuery = false;                 ///< true depois do primeiro 0x0D/0x0E bem-sucedido.
+    R200TagCallback _tagCallback = NULL;     ///< Destino das tags do inventário contínuo.
+    void *_tagCallbackContext = NULL;        ///< Contexto repassado ao callback.
 
     /**
      * @brief Monta e envia um frame de comando binário via UART.
@@ -146,19 +441,29 @@ private:
      */
     void sendCommand(uint8_t type, uint8_t cmd, uint8_t *params, int paramLen);
 
+    /** @brief Ponto de entrada FreeRTOS da task dona da UART. */
+    static void uartTaskEntry(void *parameter);
+
     /**
-     * @brief Decodifica um pacote bruto recebido e preenche a estrutura R200Tag.
+     * @brief Laço da task dona da UART.
      *
-     * @param packet Ponteiro para o buffer contendo o frame completo.
-     * @param length Tamanho total do frame.
-     * @param tag Referência para a estrutura onde os dados serão salvos.
+     * Dorme até um comando ser enfileirado, a UART notificar bytes ou a janela do
+     * comando em curso expirar. Drena a serial, conclui o comando respondido e
+     * já envia o próximo da fila.
      */
-    void parsePacket(uint8_t *packet, int length, R200Tag &tag);
+    void uartTaskLoop();
+
+    /** @brief Coloca um comando na fila e acorda a task dona da UART. */
+    bool enqueue(const R200Command &command);
 
     /**
-     * @brief Converte um caractere Hex (0-9, A-F) para valor numérico (0-15).
+     * @brief Entrega um frame completo: conclui o comando em curso se for a
+     * resposta dele, senão publica na fila de frames.
      */
-    uint8_t hexCharToByte(char c);
+    void dispatchFrame(const R200Frame &frame);
+
+    /** @brief Conclui _inFlight e libera quem estiver aguardando. */
+    void completeInFlight(R200Status status, const R200Frame *frame);
 };
 
 #endif // R200_H
\ No newline at end of file
@@ -0,0 +1,55 @@
+/**
+ * @file adaptive_timeout.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the latency-driven response window.
+ * @date 2026-10-14
+ */
+
+#include "adaptive_timeout.h"
+
+AdaptiveTimeout::AdaptiveTimeout(uint16_t initialMs, uint16_t minMs, uint16_t maxMs)
+    : _initialMs(initialMs), _minMs(minMs), _maxMs(maxMs)
+{
+    reset();
+}
+
+void AdaptiveTimeout::reset()
+{
+    _srtt8 = 0;
+    _rttvar8 = 0;
+    setTimeout(_initialMs);
+}
+
+void AdaptiveTimeout::setTimeout(uint32_t ms)
+{
+    if (ms < _minMs)
+        ms = _minMs;
+    if (ms > _maxMs)
+        ms = _maxMs;
+    _timeoutMs = ms;
+}
+
+void AdaptiveTimeout::sample(uint16_t elapsedMs)
+{
+    // 1 ms ticks: an "instant" response still counts as 1 ms
+    uint32_t r8 = (elapsedMs > 0 ? elapsedMs : 1) * 8;
+
+    if (_srtt8 == 0)
+    {
+        _srtt8 = r8;
+        _rttvar8 = r8 / 2;
+    }
+    else
+    {
+        uint32_t diff = (_srtt8 > r8) ? _srtt8 - r8 : r8 - _srtt8;
+        _rttvar8 = _rttvar8 - _rttvar8 / 4 + diff / 4;
+        _srtt8 = _srtt8 - _srtt8 / 8 + r8 / 8;
+    }
+
+    setTimeout((_srtt8 + 4 * _rttvar8 + 7) / 8);
+}
+
+void AdaptiveTimeout::expired()
+{
+    setTimeout((uint32_t)_timeoutMs * 2);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file adaptive_timeout.h
+ * @author Luis Felipe Patrocinio
+ * @brief Response window that follows the measured command latency.
+ * @date 2026-10-14
+ *
+ * @note Same estimator as TCP's retransmission timer (smoothed latency plus four
+ *       times its mean deviation), in integer milliseconds scaled by 8. A command
+ *       that times out doubles the window, up to the maximum, until a response is
+ *       measured again.
+ */
+
+#ifndef ADAPTIVE_TIMEOUT_H
+#define ADAPTIVE_TIMEOUT_H
+
+#include <Arduino.h>
+
+/**
+ * @class AdaptiveTimeout
+ * @brief Tracks one command's latency and proposes its next response window.
+ */
+class AdaptiveTimeout
+{
+public:
+    /**
+     * @param initialMs Window used until the first response is measured.
+     * @param minMs Lower bound (covers tick granularity and slow tags).
+     * @param maxMs Upper bound (the fixed window used before this estimator).
+     */
+    AdaptiveTimeout(uint16_t initialMs, uint16_t minMs, uint16_t maxMs);
+
+    /** @brief Feeds the send -> response time of a command that got an answer. */
+    void sample(uint16_t elapsedMs);
+
+    /** @brief Reports a command that got no answer within timeout(). */
+    void expired();
+
+    /** @brief Forgets the measurements and goes back to the initial window. */
+    void reset();
+
+    /** @brief Window to use for the next command. */
+    uint16_t timeout() const { return _timeoutMs; }
+
+    /** @brief Smoothed latency in milliseconds (0 before the first sample). */
+    uint16_t smoothed() const { return _srtt8 / 8; }
+
+private:
+    uint16_t _initialMs;
+    uint16_t _minMs;
+    uint16_t _maxMs;
+    uint16_t _timeoutMs;
+    uint32_t _srtt8;   ///< Smoothed latency x8 (0 = no sample yet).
+    uint32_t _rttvar8; ///< Mean deviation x8.
+
+    void setTimeout(uint32_t ms);
+};
+
+#endif // ADAPTIVE_TIMEOUT_H
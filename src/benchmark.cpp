@@ -0,0 +1,321 @@
+/**
+ * @file benchmark.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the benchmark counters and report.
+ * @date 2026-10-14
+ */
+
+#include "benchmark.h"
+#include "config.h"
+#include "log.h"
+#include "rtos_comm.h"
+#include "ble_comm.h"
+#include "message_pool.h"
+#include "latency_stats.h"
+#include "tag_dedup.h"
+#include <ArduinoJson.h>
+#include <math.h>
+
+static const char *const phaseNames[BENCH_PHASE_COUNT] = {"inventory", "tid", "write"};
+
+// Pedido e estado visíveis para as outras tasks
+static portMUX_TYPE benchMux = portMUX_INITIALIZER_UNLOCKED;
+static bool queued = false;
+static bool running = false;
+static volatile bool cancelled = false;
+static BenchConfig queuedConfig;
+
+// Contadores da execução: só a task RFID escreve
+static TagDedupSlot seenSlots[BENCH_UNIQUE_CAPACITY];
+static TagDedup seen(seenSlots, BENCH_UNIQUE_CAPACITY, 0);
+static bool inPhase = false;
+static BenchPhase phase = BENCH_INVENTORY;
+static uint32_t phaseStartMs = 0;
+static uint32_t phaseMs[BENCH_PHASE_COUNT];
+static bool phaseRan[BENCH_PHASE_COUNT];
+static uint32_t inventoryReads = 0;
+static uint32_t uniqueTags = 0;
+static uint32_t tidReads = 0;
+static uint32_t writesOk = 0;
+static uint32_t writesFailed = 0;
+static LatencyHistogram tidLatency; // LAT_TID_READ no fim da fase de TID (a gravação também lê TIDs)
+
+/**
+ * @struct BenchBaseline
+ * @brief Counters at the start of the run; the report shows the difference.
+ */
+struct BenchBaseline
+{
+    uint32_t startMs;
+    R200DecoderStats line;
+    uint32_t droppedFrames;
+    MessagePoolStats pool;
+    uint32_t ringDropped;
+    uint32_t logDropped;
+    uint32_t notifiedBytes;
+};
+static BenchBaseline base;
+
+bool benchRequest(const BenchConfig &config)
+{
+    if (config.seconds == 0 || config.seconds > BENCH_MAX_SECONDS)
+        return false;
+
+    bool accepted = false;
+    portENTER_CRITICAL(&benchMux);
+    if (!queued && !running)
+    {
+        queuedConfig = config;
+        queued = true;
+        cancelled = false;
+        accepted = true;
+    }
+    portEXIT_CRITICAL(&benchMux);
+    return accepted;
+}
+
+void benchCancel()
+{
+    cancelled = true;
+}
+
+bool benchRunning()
+{
+    portENTER_CRITICAL(&benchMux);
+    bool busy = queued || running;
+    portEXIT_CRITICAL(&benchMux);
+    return busy;
+}
+
+bool benchBegin(BenchConfig &config)
+{
+    portENTER_CRITICAL(&benchMux);
+    bool claimed = queued;
+    if (claimed)
+    {
+        config = queuedConfig;
+        queued = false;
+        running = true;
+    }
+    portEXIT_CRITICAL(&benchMux);
+    if (!claimed)
+        return false;
+
+    seen.clear();
+    inPhase = false;
+    memset(phaseMs, 0, sizeof(phaseMs));
+    memset(phaseRan, 0, sizeof(phaseRan));
+    memset(&tidLatency, 0, sizeof(tidLatency));
+    inventoryReads = uniqueTags = tidReads = writesOk = writesFailed = 0;
+
+    // Os histogramas passam a medir só esta execução
+    latencyReset();
+    base.startMs = millis();
+    base.line = rfid.lineStats();
+    base.droppedFrames = rfid.droppedFrames;
+    base.pool = messagePoolStats();
+    base.ringDropped = tagRing.dropped();
+    base.logDropped = logDropped();
+    base.notifiedBytes = bleNotifiedBytes();
+
+    LOG_I("[Bench] Inicio: %u s por fase%s.", config.seconds, config.write ? ", com gravacao" : "");
+    return true;
+}
+
+bool benchCancelled()
+{
+    return cancelled;
+}
+
+void benchPhaseBegin(BenchPhase next)
+{
+    phase = next;
+    phaseRan[next] = true;
+    phaseStartMs = millis();
+    inPhase = true;
+}
+
+void benchPhaseEnd()
+{
+    if (!inPhase)
+        return;
+    phaseMs[phase] = millis() - phaseStartMs;
+    if (phase == BENCH_TID)
+        tidLatency = latencySnapshot(LAT_TID_READ);
+    inPhase = false;
+}
+
+void benchOnInventoryRead(const R200Tag &tag)
+{
+    if (!inPhase || phase != BENCH_INVENTORY)
+        return;
+    inventoryReads++;
+    if (!seen.checkAndMark(tag.epc, tag.epcLen, tag.timestamp))
+        uniqueTags++;
+}
+
+void benchOnTidRead()
+{
+    if (inPhase && phase == BENCH_TID)
+        tidReads++;
+}
+
+void benchOnWrite(bool ok)
+{
+    if (!inPhase || phase != BENCH_WRITE)
+        return;
+    if (ok)
+        writesOk++;
+    else
+        writesFailed++;
+}
+
+//==============================================================================
+// REPORT
+//==============================================================================
+
+/** @brief @p count per second over @p ms, to one decimal. */
+static float perSec(uint32_t count, uint32_t ms)
+{
+    return ms ? roundf(count * 10000.0f / ms) / 10.0f : 0;
+}
+
+/** @brief Starts one report message for @p section. */
+static JsonObject beginSection(JsonDocument &doc, const char *section)
+{
+    doc["type"] = "benchmark";
+    JsonObject content = doc["content"].to<JsonObject>();
+    content["section"] = section;
+    return content;
+}
+
+void benchFinish(bool aborted)
+{
+    benchPhaseEnd();
+    uint32_t totalMs = millis() - base.startMs;
+
+    {
+        uint32_t ms = phaseMs[BENCH_INVENTORY];
+        JsonDocument doc;
+        JsonObject out = beginSection(doc, phaseNames[BENCH_INVENTORY]);
+        out["ms"] = ms;
+        out["reads"] = inventoryReads;
+        out["uniqueTags"] = uniqueTags;
+        out["readsPerSec"] = perSec(inventoryReads, ms);
+        out["uniquePerSec"] = perSec(uniqueTags, ms);
+        sendJsonMessage(doc, MESSAGE_RELIABLE);
+        LOG_I("[Bench] Inventario: %lu leituras, %lu tags distintas em %lu ms (%.1f leituras/s, %.1f tags/s)",
+              (unsigned long)inventoryReads, (unsigned long)uniqueTags, (unsigned long)ms,
+              perSec(inventoryReads, ms), perSec(uniqueTags, ms));
+    }
+
+    {
+        uint32_t ms = phaseMs[BENCH_TID];
+        const LatencyHistogram &tid = tidLatency;
+        JsonDocument doc;
+        JsonObject out = beginSection(doc, phaseNames[BENCH_TID]);
+        out["ms"] = ms;
+        out["reads"] = tidReads;
+        out["readsPerSec"] = perSec(tidReads, ms);
+        out["tidReads"] = tid.count;
+        out["misses"] = tid.misses;
+        out["p50Us"] = latencyPercentileUs(tid, 50);
+        out["p90Us"] = latencyPercentileUs(tid, 90);
+        out["p99Us"] = latencyPercentileUs(tid, 99);
+        out["maxUs"] = tid.maxUs;
+        sendJsonMessage(doc, MESSAGE_RELIABLE);
+        LOG_I("[Bench] TID: %lu leituras em %lu ms; p50 %lu us, p90 %lu us, p99 %lu us (%lu lotes, %lu sem resposta)",
+              (unsigned long)tidReads, (unsigned long)ms, (unsigned long)latencyPercentileUs(tid, 50),
+              (unsigned long)latencyPercentileUs(tid, 90), (unsigned long)latencyPercentileUs(tid, 99),
+              (unsigned long)tid.count, (unsigned long)tid.misses);
+    }
+
+    {
+        uint32_t ms = phaseMs[BENCH_WRITE];
+        uint32_t attempts = writesOk + writesFailed;
+        JsonDocument doc;
+        JsonObject out = beginSection(doc, phaseNames[BENCH_WRITE]);
+        if (!phaseRan[BENCH_WRITE])
+            out["skipped"] = true;
+        out["ms"] = ms;
+        out["ok"] = writesOk;
+        out["failed"] = writesFailed;
+        out["successPct"] = attempts ? roundf(writesOk * 1000.0f / attempts) / 10.0f : 0;
+        out["tagsPerSec"] = perSec(writesOk, ms);
+        sendJsonMessage(doc, MESSAGE_RELIABLE);
+        if (phaseRan[BENCH_WRITE])
+            LOG_I("[Bench] Gravacao: %lu ok, %lu falhas em %lu ms (%.1f tags/s)",
+                  (unsigned long)writesOk, (unsigned long)writesFailed, (unsigned long)ms, perSec(writesOk, ms));
+        else
+            LOG_I("[Bench] Gravacao: pulada (sem job em lote).");
+    }
+
+    {
+        const R200DecoderStats &line = rfid.lineStats();
+        MessagePoolStats pool = messagePoolStats();
+        uint32_t messagesDropped = (pool.droppedFull - base.pool.droppedFull) + (pool.droppedOversize - base.pool.droppedOversize);
+        JsonDocument doc;
+        JsonObject out = beginSection(doc, "line");
+        out["frames"] = line.frames - base.line.frames;
+        out["checksumErrors"] = line.checksumErrors - base.line.checksumErrors;
+        out["framingErrors"] = line.framingErrors - base.line.framingErrors;
+        out["discardedBytes"] = line.discardedBytes - base.line.discardedBytes;
+        out["droppedFrames"] = rfid.droppedFrames - base.droppedFrames;
+        out["messagesDropped"] = messagesDropped;
+        out["ringDropped"] = tagRing.dropped() - base.ringDropped;
+        out["logDropped"] = logDropped() - base.logDropped;
+        sendJsonMessage(doc, MESSAGE_RELIABLE);
+        LOG_I("[Bench] Linha: %lu frames, %lu checksum, %lu framing, %lu frames perdidos; descartes: %lu mensagens, %lu anel",
+              (unsigned long)(line.frames - base.line.frames), (unsigned long)(line.checksumErrors - base.line.checksumErrors),
+              (unsigned long)(line.framingErrors - base.line.framingErrors), (unsigned long)(rfid.droppedFrames - base.droppedFrames),
+              (unsigned long)messagesDropped, (unsigned long)(tagRing.dropped() - base.ringDropped));
+    }
+
+    {
+        LatencyHistogram notify = latencySnapshot(LAT_BLE_NOTIFY);
+        uint32_t bytes = bleNotifiedBytes() - base.notifiedBytes;
+        JsonDocument doc;
+        JsonObject out = beginSection(doc, "ble");
+        out["connected"] = (bool)bluetoothConnected;
+        out["notifies"] = notify.count;
+        out["notifiesPerSec"] = perSec(notify.count, totalMs);
+        out["bytes"] = bytes;
+        out["bytesPerSec"] = perSec(bytes, totalMs);
+        out["avgNotifyUs"] = notify.count ? (uint32_t)(notify.sumUs / notify.count) : 0;
+        sendJsonMessage(doc, MESSAGE_RELIABLE);
+        LOG_I("[Bench] BLE: %lu notifies, %lu bytes (%.1f/s, %.1f B/s)", (unsigned long)notify.count,
+              (unsigned long)bytes, perSec(notify.count, totalMs), perSec(bytes, totalMs));
+    }
+
+    {
+        JsonDocument doc;
+        JsonObject out = beginSection(doc, "system");
+        out["aborted"] = aborted;
+        out["totalMs"] = totalMs;
+        out["heapFree"] = ESP.getFreeHeap();
+        out["heapMinFree"] = ESP.getMinFreeHeap();
+        out["heapMaxBlock"] = ESP.getMaxAllocHeap();
+        sendJsonMessage(doc, MESSAGE_RELIABLE);
+        LOG_I("[Bench] Fim%s em %lu ms; heap livre %lu B (minimo %lu B)", aborted ? " (interrompido)" : "",
+              (unsigned long)totalMs, (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMinFreeHeap());
+    }
+
+    {
+        // Pilha livre desde a criação de cada task (não zera com a execução)
+        JsonDocument doc;
+        JsonObject out = beginSection(doc, "tasks");
+        JsonObject stackFree = out["stackFree"].to<JsonObject>();
+        for (uint8_t i = 0; i < APP_TASK_COUNT; i++)
+        {
+            if (appTasks[i] == NULL)
+                continue;
+            stackFree[pcTaskGetName(appTasks[i])] = uxTaskGetStackHighWaterMark(appTasks[i]);
+            LOG_I("[Bench] %-16s %u bytes de pilha livres", pcTaskGetName(appTasks[i]), (unsigned)uxTaskGetStackHighWaterMark(appTasks[i]));
+        }
+        sendJsonMessage(doc, MESSAGE_RELIABLE);
+    }
+
+    portENTER_CRITICAL(&benchMux);
+    running = false;
+    portEXIT_CRITICAL(&benchMux);
+}
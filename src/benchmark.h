@@ -0,0 +1,92 @@
+/**
+ * @file benchmark.h
+ * @author Luis Felipe Patrocinio
+ * @brief Hardware-in-the-loop throughput benchmark: timed inventory, TID and bulk
+ *        write phases on real tags, with an on-device report.
+ * @date 2026-10-14
+ *
+ * @note Builds are compared on the bench by running the same test population
+ *       through the same phases. The "benchmark" command (or 'b' on the serial
+ *       console) queues a run; the RFID engine runs it as if the trigger were held:
+ *         1. inventory: continuous multi-poll, raw reads and distinct EPCs;
+ *         2. TID: read rounds with every TID read over the air (no cache, no flash);
+ *         3. write: the loaded bulk job, if any (skipped otherwise).
+ *
+ *       The report reuses the counters the stats already keep: the latency
+ *       histograms (reset when the run starts), the R200 line counters, the
+ *       message pool, the tag ring and the log, taken as deltas over the run, plus
+ *       heap and task stack high-water marks. It goes out as `benchmark` JSON
+ *       messages, one per section, and to the serial log.
+ *
+ *       Pressing the trigger or sending "cancel" stops the run; the report then
+ *       covers what ran and is marked aborted.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+#include "R200.h"
+
+/** @brief Benchmark phases, in the order they run. */
+enum BenchPhase
+{
+    BENCH_INVENTORY,
+    BENCH_TID,
+    BENCH_WRITE,
+    BENCH_PHASE_COUNT
+};
+
+/**
+ * @struct BenchConfig
+ * @brief What a run does.
+ */
+struct BenchConfig
+{
+    uint16_t seconds; ///< Length of each phase (1 to BENCH_MAX_SECONDS).
+    bool write;       ///< Run the write phase on the loaded bulk job.
+};
+
+/**
+ * @brief Queues a run. Safe from any task; wake the engine with RFID_EVENT_BENCH after it.
+ * @return false if a run is already queued or running, or @p config is out of range.
+ */
+bool benchRequest(const BenchConfig &config);
+
+/** @brief Stops the running (or queued) run at the end of the current cycle. */
+void benchCancel();
+
+/** @brief true from benchRequest() until the report is out. */
+bool benchRunning();
+
+// --- RFID engine side: everything below runs on the RFID task only ---
+
+/**
+ * @brief Claims the queued run and starts it: clears the counters, resets the
+ *        latency histograms and takes the baselines.
+ * @return false if nothing is queued.
+ */
+bool benchBegin(BenchConfig &config);
+
+/** @brief true once benchCancel() was called for this run. */
+bool benchCancelled();
+
+/** @brief Starts timing @p phase; the hooks below only count during a phase. */
+void benchPhaseBegin(BenchPhase phase);
+
+/** @brief Ends the current phase. */
+void benchPhaseEnd();
+
+/** @brief Inventory phase: one tag notice from the multi-poll. */
+void benchOnInventoryRead(const R200Tag &tag);
+
+/** @brief TID phase: one read reported with its TID. */
+void benchOnTidRead();
+
+/** @brief Write phase: one bulk write confirmed (@p ok) or failed. */
+void benchOnWrite(bool ok);
+
+/** @brief Sends the report and frees the benchmark for the next request. */
+void benchFinish(bool aborted);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,68 @@
+/**
+ * @file ble_batch.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the binary tag batch encoder.
+ * @date 2026-10-14
+ */
+
+#include "ble_batch.h"
+
+void TagBatch::reset(size_t maxSize)
+{
+    _maxSize = (maxSize > BLE_BATCH_BUFFER_SIZE) ? BLE_BATCH_BUFFER_SIZE : maxSize;
+    _size = 0;
+    _firstSeq = 0;
+}
+
+void TagBatch::resetSession(size_t maxSize, uint32_t firstSeq)
+{
+    reset(maxSize);
+    _firstSeq = firstSeq;
+}
+
+bool TagBatch::add(const TagReport &report)
+{
+    bool hasTid = report.tid.len > 0;
+    size_t recordSize = 3 + report.tag.epcLen + (hasTid ? 1 + report.tid.len : 0);
+
+    // The header is written lazily with the first record
+    size_t headerSize = _firstSeq ? 6 : 4;
+    size_t needed = (_size ? _size : headerSize) + recordSize;
+    if (needed > _maxSize || count() == 0xFF)
+        return false;
+
+    if (_size == 0 && _firstSeq)
+    {
+        _buffer[0] = BLE_BATCH_TYPE_SESSION;
+        _buffer[1] = 0;
+        for (int i = 0; i < 4; i++)
+            _buffer[2 + i] = (_firstSeq >> (8 * i)) & 0xFF;
+        _size = 6;
+    }
+    else if (_size == 0)
+    {
+        _buffer[0] = BLE_BATCH_TYPE_TAGS;
+        _buffer[1] = 0;
+        _buffer[2] = _sequence & 0xFF;
+        _buffer[3] = _sequence >> 8;
+        _sequence++;
+        _size = 4;
+    }
+
+    uint8_t *p = &_buffer[_size];
+    *p++ = report.flags | (hasTid ? BLE_BATCH_FLAG_TID : 0);
+    *p++ = report.tag.rssi;
+    *p++ = report.tag.epcLen;
+    memcpy(p, report.tag.epc, report.tag.epcLen);
+    p += report.tag.epcLen;
+    if (hasTid)
+    {
+        *p++ = report.tid.len;
+        memcpy(p, report.tid.bytes, report.tid.len);
+        p += report.tid.len;
+    }
+
+    _size = p - _buffer;
+    _buffer[1]++;
+    return true;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file ble_batch.h
+ * @author Luis Felipe Patrocinio
+ * @brief Compact binary batch format that packs many tag reads into one BLE notification.
+ * @date 2026-10-14
+ *
+ * @note Wire format (version 1), all multi-byte fields little-endian:
+ *       - Header: `type(1) = 0x01 | count(1) | sequence(2)`
+ *       - Record: `flags(1) | rssi(1) | epcLen(1) | epc(epcLen) [| tidLen(1) | tid(tidLen)]`
+ *       - `flags` bit 0: record carries a TID. Bit 1: record comes from inventory mode.
+ *         Bit 7: EPC cut to the session store limit (session pulls only).
+ *
+ *       Session pulls (see session_store.h) use the same records under
+ *       `type(1) = 0x02 | count(1) | firstSeq(4)`; record i has sequence firstSeq + i.
+ *
+ *       JSON notifications always start with '{' (0x7B), so a client tells the two
+ *       formats apart by the first byte.
+ */
+
+#ifndef BLE_BATCH_H
+#define BLE_BATCH_H
+
+#include <Arduino.h>
+#include "tag_ring.h"
+
+/** @brief Batch header type byte for tag records. */
+#define BLE_BATCH_TYPE_TAGS 0x01
+
+/** @brief Batch header type byte for stored session reads. */
+#define BLE_BATCH_TYPE_SESSION 0x02
+
+/** @brief Record flag: a TID follows the EPC. */
+#define BLE_BATCH_FLAG_TID 0x01
+
+/** @brief Record flag: read produced by continuous inventory (no TID lookup). */
+#define BLE_BATCH_FLAG_INVENTORY 0x02
+
+/** @brief Record flag: the EPC was longer than the session store keeps. */
+#define BLE_BATCH_FLAG_TRUNCATED 0x80
+
+/** @brief Largest ATT notification payload (MTU 517 - 3). */
+#define BLE_BATCH_BUFFER_SIZE 514
+
+/**
+ * @class TagBatch
+ * @brief Accumulates encoded TagReport records until the notification is full.
+ */
+class TagBatch
+{
+public:
+    TagBatch() : _size(0), _maxSize(BLE_BATCH_BUFFER_SIZE), _sequence(0), _firstSeq(0) {}
+
+    /**
+     * @brief Starts an empty batch of live reads.
+     * @param maxSize Payload limit for this batch (link MTU - 3, at most BLE_BATCH_BUFFER_SIZE).
+     */
+    void reset(size_t maxSize);
+
+    /**
+     * @brief Starts an empty batch of session reads whose first record is @p firstSeq.
+     * @param maxSize Payload limit, as in reset().
+     */
+    void resetSession(size_t maxSize, uint32_t firstSeq);
+
+    /**
+     * @brief Appends one record.
+     * @return false If the record does not fit; flush and retry on a fresh batch.
+     */
+    bool add(const TagReport &report);
+
+    /** @brief Number of records in the batch. */
+    uint8_t count() const { return _size ? _buffer[1] : 0; }
+
+    /** @brief Encoded batch. Valid until the next reset(). */
+    const uint8_t *data() const { return _buffer; }
+
+    /** @brief Encoded size in bytes (0 = empty). */
+    size_t size() const { return _size; }
+
+private:
+    uint8_t _buffer[BLE_BATCH_BUFFER_SIZE];
+    size_t _size;
+    size_t _maxSize;
+    uint16_t _sequence; ///< Incremented per batch so the client can detect gaps.
+    uint32_t _firstSeq; ///< Session batch: sequence of the first record (0 = live batch).
+};
+
+#endif // BLE_BATCH_H
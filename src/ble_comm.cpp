@@ -9,6 +9,7 @@
 // Arduino & ESP32 Includes
 //==============================================================================
 #include <ArduinoJson.h>
+#include "json_arena.h"
 
 //==============================================================================
 // Project Header Includes
@@ -27,18 +28,223 @@
 // Project Header Includes
 //==============================================================================
 #include "ble_comm.h"
+#include "ble_batch.h"
+#include "message_pool.h"
+#include "latency_stats.h"
+#include "tag_store.h"
+#include "session_store.h"
+#include "reader_profile.h"
+#include "tag_output.h"
+#include "power_manager.h"
+#include "rfid_handler.h"
+#include "ui_handler.h"
+#include "benchmark.h"
 #include "rtos_comm.h"
+#include "log.h"
 
 //==============================================================================
 // DEFINITIONS
 //==============================================================================
 #define SERVICE_UUID "12345678-1234-1234-1234-1234567890ab"
-#define CHARACTERISTIC_UUID "abcdefab-1234-5678-1234-abcdefabcdef"
+#define CHARACTERISTIC_UUID "abcdefab-1234-5678-1234-abcdefabcdef"         // Results stream (notify; still takes legacy commands)
+#define COMMAND_CHARACTERISTIC_UUID "abcdefab-1234-5678-1234-abcdefabc0de" // Commands (write / write without response) and their acks
+#define SESSION_CHARACTERISTIC_UUID "abcdefab-1234-5678-1234-abcdefab5e55" // Session pulls (notify only)
 extern const char *DEVICE_ID; // Use the device ID from main.cpp
 
 // BLE server pointer
 static BLEServer *pServer = nullptr;
 
+// Negotiated link parameters, reported to the app and used to size binary batches
+static volatile uint16_t linkMtu = 23;     // ATT MTU (23 until the client asks for more)
+static volatile uint16_t linkInterval = 0; // Connection interval (units of 1.25 ms)
+static volatile uint16_t linkLatency = 0;  // Peripheral latency (connection events)
+static volatile uint16_t linkTimeout = 0;  // Supervision timeout (units of 10 ms)
+
+// Command and bulk characteristics (the results stream is pCharacteristic) and their CCCDs
+static BLECharacteristic *commandCharacteristic = nullptr;
+static BLECharacteristic *sessionCharacteristic = nullptr;
+static BLE2902 *resultsCccd = nullptr;
+static BLE2902 *sessionCccd = nullptr;
+
+// Stack's flow control on the link
+static volatile bool linkCongested = false;
+
+/** @brief true if the client is connected and enabled notifications through @p cccd. */
+static bool subscribed(BLE2902 *cccd)
+{
+    return bluetoothConnected && cccd != nullptr && cccd->getNotifications();
+}
+
+// Fixed memory for parsing a command and building its ack (command task only)
+static uint8_t commandArenaBuffer[COMMAND_ARENA_BYTES] __attribute__((aligned(4)));
+static JsonArena commandArena(commandArenaBuffer, sizeof(commandArenaBuffer));
+static volatile uint32_t commandsDropped = 0; // Writes that found the command queue full
+
+// Session pull asked for by a command; the BLE task streams it between live reads
+static portMUX_TYPE pullMux = portMUX_INITIALIZER_UNLOCKED;
+static bool pullRequested = false;
+static uint32_t pullRequestFrom = 0;
+static uint32_t pullRequestCount = 0;
+
+//==============================================================================
+// LINK INFO REPORTING
+//==============================================================================
+
+/**
+ * @brief Queues a `linkInfo` JSON with the current MTU and connection parameters.
+ *
+ * Called from BLE stack callbacks, so it never waits for queue space.
+ */
+static void queueLinkInfo()
+{
+    JsonDocument doc;
+    doc["type"] = "linkInfo";
+    doc["content"]["mtu"] = linkMtu;
+    doc["content"]["intervalMs"] = linkInterval * 1.25f;
+    doc["content"]["latency"] = linkLatency;
+    doc["content"]["timeoutMs"] = linkTimeout * 10;
+
+    sendJsonMessage(doc, MESSAGE_BEST_EFFORT);
+}
+
+/**
+ * @brief GAP hook: records the connection parameters the central settled on.
+ */
+static void gapEventHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param)
+{
+    if (event == ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT &&
+        param->update_conn_params.status == ESP_BT_STATUS_SUCCESS)
+    {
+        linkInterval = param->update_conn_params.conn_int;
+        linkLatency = param->update_conn_params.latency;
+        linkTimeout = param->update_conn_params.timeout;
+        queueLinkInfo();
+    }
+}
+
+/**
+ * @brief GATTS hook: pauses session pulls while the controller's buffers are full.
+ */
+static void gattsEventHandler(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf, esp_ble_gatts_cb_param_t *param)
+{
+    if (event == ESP_GATTS_CONGEST_EVT)
+    {
+        linkCongested = param->congest.congested;
+        // The BLE task sleeps while congested; the doorbell resumes the pull
+        if (!linkCongested)
+            xSemaphoreGive(tagReportDoorbell);
+    }
+}
+
+//==============================================================================
+// STATS REPORTING
+//==============================================================================
+
+/**
+ * @brief Queues one `stats` JSON per latency stage plus the message pool and R200 line counters.
+ *        The table form stays on the serial console ('s'), off the command task.
+ */
+static void queueStats()
+{
+    for (uint8_t s = 0; s < LAT_STAGE_COUNT; s++)
+    {
+        JsonDocument doc;
+        doc["type"] = "stats";
+        latencyStageToJson((LatencyStage)s, doc["content"]);
+        sendJsonMessage(doc, MESSAGE_RELIABLE);
+    }
+
+    MessagePoolStats pool = messagePoolStats();
+    JsonDocument doc;
+    doc["type"] = "stats";
+    doc["content"]["stage"] = "messages";
+    doc["content"]["sent"] = pool.sent;
+    doc["content"]["droppedFull"] = pool.droppedFull;
+    doc["content"]["droppedOversize"] = pool.droppedOversize;
+    doc["content"]["highWater"] = pool.highWater;
+    doc["content"]["ringDropped"] = tagRing.dropped();
+    doc["content"]["ringHighWater"] = tagRing.highWater();
+    doc["content"]["commandsDropped"] = commandsDropped;
+    doc["content"]["commandArenaHighWater"] = commandArena.highWater();
+    doc["content"]["logDropped"] = logDropped();
+    sendJsonMessage(doc, MESSAGE_RELIABLE);
+
+    JsonDocument taskDoc;
+    taskDoc["type"] = "stats";
+    taskDoc["content"]["stage"] = "tasks";
+    JsonObject stackFree = taskDoc["content"]["stackFree"].to<JsonObject>();
+    for (uint8_t i = 0; i < APP_TASK_COUNT; i++)
+    {
+        if (appTasks[i] != NULL)
+            stackFree[pcTaskGetName(appTasks[i])] = uxTaskGetStackHighWaterMark(appTasks[i]);
+    }
+    sendJsonMessage(taskDoc, MESSAGE_RELIABLE);
+
+    const R200DecoderStats &line = rfid.lineStats();
+    JsonDocument lineDoc;
+    lineDoc["type"] = "stats";
+    lineDoc["content"]["stage"] = "r200";
+    lineDoc["content"]["frames"] = line.frames;
+    lineDoc["content"]["checksumErrors"] = line.checksumErrors;
+    lineDoc["content"]["framingErrors"] = line.framingErrors;
+    lineDoc["content"]["discardedBytes"] = line.discardedBytes;
+    lineDoc["content"]["droppedFrames"] = rfid.droppedFrames;
+    lineDoc["content"]["txPowerDbm"] = rfid.txPower();
+    lineDoc["content"]["emptyRounds"] = rfid.emptyRounds;
+    R200QueryParams query;
+    if (rfid.cachedQuery(query))
+        lineDoc["content"]["q"] = query.q;
+    sendJsonMessage(lineDoc, MESSAGE_RELIABLE);
+
+    TagStoreStats store = tagStoreStats();
+    JsonDocument storeDoc;
+    storeDoc["type"] = "stats";
+    storeDoc["content"]["stage"] = "tagStore";
+    storeDoc["content"]["mounted"] = store.mounted;
+    storeDoc["content"]["records"] = store.records;
+    storeDoc["content"]["hits"] = store.hits;
+    storeDoc["content"]["misses"] = store.misses;
+    storeDoc["content"]["ambiguous"] = store.ambiguous;
+    sendJsonMessage(storeDoc, MESSAGE_RELIABLE);
+
+    SessionStoreStats session = sessionStoreStats();
+    JsonDocument sessionDoc;
+    sessionDoc["type"] = "stats";
+    sessionDoc["content"]["stage"] = "session";
+    sessionDoc["content"]["mounted"] = session.mounted;
+    sessionDoc["content"]["first"] = session.first;
+    sessionDoc["content"]["next"] = session.next;
+    sessionDoc["content"]["pending"] = session.pending;
+    sessionDoc["content"]["flushes"] = session.flushes;
+    sendJsonMessage(sessionDoc, MESSAGE_RELIABLE);
+
+    PowerStats power = powerStats();
+    JsonDocument powerDoc;
+    powerDoc["type"] = "stats";
+    powerDoc["content"]["stage"] = "power";
+    powerDoc["content"]["lightSleep"] = power.lightSleep;
+    powerDoc["content"]["cpuMinMhz"] = power.cpuMinMhz;
+    powerDoc["content"]["activeMs"] = power.stateMs[POWER_RADIO_ACTIVE];
+    powerDoc["content"]["idleMs"] = power.stateMs[POWER_RADIO_IDLE];
+    powerDoc["content"]["r200SleepMs"] = power.stateMs[POWER_RADIO_ASLEEP];
+    powerDoc["content"]["r200Sleeps"] = power.r200Sleeps;
+    powerDoc["content"]["lastWakeMs"] = power.lastWakeMs;
+    powerDoc["content"]["modelMa"] = power.modelMa;
+    if (power.measuredMa >= 0)
+        powerDoc["content"]["measuredMa"] = power.measuredMa;
+    sendJsonMessage(powerDoc, MESSAGE_RELIABLE);
+
+    JsonDocument bootDoc;
+    bootDoc["type"] = "stats";
+    bootDoc["content"]["stage"] = "boot";
+    bootDoc["content"]["radioMs"] = bootTimes.radioMs;
+    bootDoc["content"]["bleMs"] = bootTimes.bleMs;
+    bootDoc["content"]["readyMs"] = bootTimes.readyMs;
+    bootDoc["content"]["handshakeAttempts"] = bootTimes.handshakeAttempts;
+    bootDoc["content"]["radioOk"] = bootTimes.radioOk;
+    sendJsonMessage(bootDoc, MESSAGE_RELIABLE);
+}
+
 //==============================================================================
 // BLE SERVER CALLBACKS
 //==============================================================================
@@ -48,14 +254,45 @@ class MyServerCallbacks : public BLEServerCallbacks
     {
         // Set the global flag to indicate BLE client is connected
         bluetoothConnected = true;
-        Serial.println("BLE Client Connected.");
+        uiNotify(UI_EVENT_LINK);
+        LOG_I("BLE Client Connected.");
+    }
+
+    void onConnect(BLEServer *server, esp_ble_gatts_cb_param_t *param) override
+    {
+        linkMtu = 23;
+        linkInterval = param->connect.conn_params.interval;
+        linkLatency = param->connect.conn_params.latency;
+        linkTimeout = param->connect.conn_params.timeout;
+
+        // Ask the central for a short connection interval for sustained notifies.
+        // The result arrives in gapEventHandler().
+        server->updateConnParams(param->connect.remote_bda, BLE_CONN_INTERVAL_MIN,
+                                 BLE_CONN_INTERVAL_MAX, BLE_CONN_LATENCY, BLE_CONN_TIMEOUT);
+
+#if CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+        // 2M PHY only exists on BLE 5 controllers (ESP32-C3/S3); the ESP32 is BLE 4.2.
+        // all_phys_mask = 0: the NO_PREFER bits would make the controller ignore the 2M masks
+        esp_ble_gap_set_prefered_phy(param->connect.remote_bda, 0, ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                     ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+#endif
+    }
+
+    void onMtuChanged(BLEServer *server, esp_ble_gatts_cb_param_t *param) override
+    {
+        // Only the client can start the MTU exchange; this is the agreed value
+        linkMtu = param->mtu.mtu;
+        LOG_I("BLE MTU negotiated: %u", (unsigned)linkMtu);
+        queueLinkInfo();
     }
 
     void onDisconnect(BLEServer *server) override
     {
         // Clear the global flag when BLE client disconnects
         bluetoothConnected = false;
-        Serial.println("BLE Client Disconnected.");
+        linkCongested = false;
+        uiNotify(UI_EVENT_LINK);
+        LOG_I("BLE Client Disconnected.");
         // Restart advertising so new clients can connect
         BLEDevice::startAdvertising(); // Keep advertising
     }
@@ -64,101 +301,347 @@ class MyServerCallbacks : public BLEServerCallbacks
 //==============================================================================
 // BLE CHARACTERISTIC CALLBACKS
 //==============================================================================
-class MyCallbacks : public BLECharacteristicCallbacks
+/**
+ * @brief Parses and runs one command written by the client, then acks it.
+ */
+static void handleCommand(const BleCommand &command)
 {
-    void onWrite(BLECharacteristic *characteristic) override
-    {
-        std::string rxValue = characteristic->getValue();
-        if (rxValue.empty())
-            return;
+    LOG_D("Received over BLE: %s", command.data);
 
-        Serial.print("Received over BLE: ");
-        Serial.println(rxValue.c_str());
+    // Both documents live in the arena, reset once they are out of scope
+    JsonDocument doc(&commandArena);
+    DeserializationError error = deserializeJson(doc, command.data, command.length);
 
-        String received = String(rxValue.c_str());
-        received.trim();
+    JsonDocument feedbackDoc(&commandArena);
+    bool statsRequested = false;
+    bool modeChanged = false;
+    bool profileChanged = false;
+    bool benchQueued = false;
 
-        // Parse the received JSON string
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, received);
-
-        JsonDocument feedbackDoc;
-        String feedbackJson;
+    if (error)
+    {
+        // If JSON is invalid, prepare error feedback
+        feedbackDoc["type"] = "feedback";
+        feedbackDoc["content"]["status"] = "error";
+        feedbackDoc["content"]["message"] = (error == DeserializationError::NoMemory) ? "Command too large" : "Invalid JSON received";
+    }
+    else
+    {
+        const char *type = doc["type"];
+        const char *content = doc["content"];
 
-        if (error)
+        // Flash and NVS commands keep their own locks and run without writeDataMutex,
+        // which the bulk write cycle waits on between tags
+        // Handle persistent tag store reset (known TIDs and write log)
+        if (type && strcmp(type, "clearTagStore") == 0)
+        {
+            tagStoreClear();
+            feedbackDoc["content"]["message"] = "Tag store cleared";
+        }
+        // Handle session reset (sequence numbers keep counting)
+        else if (type && strcmp(type, "clearSession") == 0)
         {
-            // If JSON is invalid, prepare error feedback
-            feedbackDoc["type"] = "feedback";
-            feedbackDoc["content"]["status"] = "error";
-            feedbackDoc["content"]["message"] = "Invalid JSON received";
+            sessionStoreClear();
+            feedbackDoc["content"]["next"] = sessionStoreStats().next;
+            feedbackDoc["content"]["message"] = "Session cleared";
         }
-        else
+        // Handle reader profile change: a preset name, or fields over the current
+        // profile (starting from "preset" if given); stored in NVS
+        else if (type && strcmp(type, "setProfile") == 0)
         {
-            const char *type = doc["type"];
-            const char *content = doc["content"];
+            ReaderProfile next = profileCurrent();
+            const char *preset = content ? content : doc["content"]["preset"].as<const char *>();
+            bool valid = !preset || profilePreset(preset, next);
+            if (valid && !content)
+                profileFromJson(doc["content"], next);
 
-            // Protect shared state with mutex before handling commands
-            if (xSemaphoreTake(writeDataMutex, portMAX_DELAY) == pdTRUE)
+            if (valid && profileSet(next))
+            {
+                profileChanged = true;
+                profileToJson(next, feedbackDoc["content"]["profile"]);
+                feedbackDoc["content"]["message"] = "Profile applied";
+            }
+            else
+            {
+                feedbackDoc["content"]["status"] = "error";
+                feedbackDoc["content"]["message"] = "Invalid profile";
+            }
+        }
+        // Protect shared state with mutex before handling the other commands
+        else if (xSemaphoreTake(writeDataMutex, portMAX_DELAY) == pdTRUE)
+        {
+            // Handle mode change command
+            if (type && strcmp(type, "changeMode") == 0)
             {
-                // Handle mode change command
-                if (type && strcmp(type, "changeMode") == 0)
+                modeChanged = true;
+                if (content && strcmp(content, "write") == 0)
+                {
+                    // Enable write mode and clear previous data
+                    bulkJob.cancel(millis());
+                    writeMode = true;
+                    inventoryMode = false;
+                    dataToRecord = "";
+                    feedbackDoc["content"]["mode"] = "write";
+                    feedbackDoc["content"]["message"] = "Write mode activated";
+                }
+                else if (content && strcmp(content, "stop") == 0)
+                {
+                    // Disable write mode and clear previous data
+                    bulkJob.cancel(millis());
+                    writeMode = false;
+                    inventoryMode = false;
+                    dataToRecord = "";
+                    feedbackDoc["content"]["mode"] = "read";
+                    feedbackDoc["content"]["message"] = "Write mode stopped";
+                }
+                else if (content && strcmp(content, "inventory") == 0)
+                {
+                    // Enable continuous inventory (multi-poll) on the trigger
+                    bulkJob.cancel(millis());
+                    writeMode = false;
+                    inventoryMode = true;
+                    dataToRecord = "";
+                    feedbackDoc["content"]["mode"] = "inventory";
+                    feedbackDoc["content"]["message"] = "Inventory mode activated";
+                }
+            }
+            // Handle data to be written to RFID tag
+            else if (type && strcmp(type, "writeData") == 0 && writeMode)
+            {
+                dataToRecord = String(content);
+                modeChanged = true;
+                feedbackDoc["content"]["message"] = "Data for writing received";
+                feedbackDoc["content"]["data"] = dataToRecord;
+            }
+            // Handle bulk encoding job (payload list or template, or "cancel")
+            else if (type && strcmp(type, "bulkWrite") == 0)
+            {
+                modeChanged = true;
+                if (content && strcmp(content, "cancel") == 0)
+                {
+                    bulkJob.cancel(millis());
+                    writeMode = false;
+                    dataToRecord = "";
+                    feedbackDoc["content"]["mode"] = "read";
+                    feedbackDoc["content"]["message"] = "Bulk job cancelled";
+                }
+                else
                 {
-                    if (content && strcmp(content, "write") == 0)
+                    JsonVariant job = doc["content"];
+                    bool append = job["append"] | false;
+                    // A running job is only extended with "append"; anything else replaces it
+                    if (!append || bulkJob.state() != BULK_RUNNING)
+                        bulkJob.clear();
+
+                    bool valid = true;
+                    JsonArray items = job["items"];
+                    for (JsonVariant item : items)
                     {
-                        // Enable write mode and clear previous data
-                        writeMode = true;
-                        dataToRecord = "";
-                        feedbackDoc["content"]["mode"] = "write";
-                        feedbackDoc["content"]["message"] = "Write mode activated";
+                        const char *data = item.as<const char *>();
+                        valid = valid && data && bulkJob.addItem(data);
+                    }
+
+                    const char *pattern = job["template"];
+                    if (valid && pattern)
+                        valid = bulkJob.addTemplate(pattern, job["start"] | 1, job["count"] | 0, job["width"] | 0);
+
+                    if (!valid || bulkJob.total() == 0)
+                    {
+                        bulkJob.clear();
+                        feedbackDoc["content"]["status"] = "error";
+                        feedbackDoc["content"]["message"] = "Invalid bulk job";
                     }
-                    else if (content && strcmp(content, "stop") == 0)
+                    else
                     {
-                        // Disable write mode and clear previous data
-                        writeMode = false;
+                        writeMode = true;
+                        inventoryMode = false;
                         dataToRecord = "";
-                        feedbackDoc["content"]["mode"] = "read";
-                        feedbackDoc["content"]["message"] = "Write mode stopped";
+                        feedbackDoc["content"]["mode"] = "bulk";
+                        feedbackDoc["content"]["total"] = bulkJob.total();
+                        feedbackDoc["content"]["message"] = "Bulk job loaded";
                     }
                 }
-                // Handle data to be written to RFID tag
-                else if (type && strcmp(type, "writeData") == 0 && writeMode)
-                {
-                    dataToRecord = String(content);
-                    feedbackDoc["content"]["message"] = "Data for writing received";
-                    feedbackDoc["content"]["data"] = dataToRecord;
-                }
-                // Handle sound toggle command
-                else if (type && strcmp(type, "toggleSound") == 0)
+            }
+            // Handle output format negotiation (legacy apps keep JSON)
+            else if (type && strcmp(type, "setFormat") == 0)
+            {
+                binaryOutput = (content && strcmp(content, "binary") == 0);
+                feedbackDoc["content"]["format"] = binaryOutput ? "binary" : "json";
+                feedbackDoc["content"]["message"] = binaryOutput ? "Binary batches enabled" : "JSON output enabled";
+            }
+            // Handle link report request
+            else if (type && strcmp(type, "getLinkInfo") == 0)
+            {
+                feedbackDoc["content"]["mtu"] = linkMtu;
+                feedbackDoc["content"]["intervalMs"] = linkInterval * 1.25f;
+                feedbackDoc["content"]["latency"] = linkLatency;
+                feedbackDoc["content"]["timeoutMs"] = linkTimeout * 10;
+            }
+            // Handle latency/drop statistics request (reports are queued after the feedback)
+            else if (type && strcmp(type, "getStats") == 0)
+            {
+                statsRequested = true;
+                feedbackDoc["content"]["message"] = "Stats queued";
+            }
+            // Handle session pull: stored reads from a cursor, streamed on the session characteristic
+            else if (type && strcmp(type, "sessionPull") == 0 && !subscribed(sessionCccd))
+            {
+                feedbackDoc["content"]["status"] = "error";
+                feedbackDoc["content"]["message"] = "Subscribe to the session characteristic first";
+            }
+            else if (type && strcmp(type, "sessionPull") == 0)
+            {
+                SessionStoreStats session = sessionStoreStats();
+                uint32_t from = doc["content"]["from"] | session.first;
+                if (from < session.first)
+                    from = session.first;
+
+                portENTER_CRITICAL(&pullMux);
+                pullRequested = true;
+                pullRequestFrom = from;
+                pullRequestCount = doc["content"]["count"] | 0;
+                portEXIT_CRITICAL(&pullMux);
+                xSemaphoreGive(tagReportDoorbell);
+
+                feedbackDoc["content"]["first"] = session.first;
+                feedbackDoc["content"]["next"] = session.next;
+                feedbackDoc["content"]["from"] = from;
+                feedbackDoc["content"]["message"] = "Session pull started";
+            }
+            // Handle reader profile report
+            else if (type && strcmp(type, "getProfile") == 0)
+            {
+                profileToJson(profileCurrent(), feedbackDoc["content"]["profile"]);
+            }
+            // Handle benchmark run (timed inventory, TID and bulk write phases) or "cancel"
+            else if (type && strcmp(type, "benchmark") == 0 && content && strcmp(content, "cancel") == 0)
+            {
+                benchCancel();
+                feedbackDoc["content"]["message"] = "Benchmark cancelled";
+            }
+            else if (type && strcmp(type, "benchmark") == 0)
+            {
+                // Out of range (0 included) is refused by benchRequest()
+                uint32_t seconds = doc["content"]["seconds"] | (uint32_t)BENCH_DEFAULT_SECONDS;
+                BenchConfig config;
+                config.seconds = seconds > BENCH_MAX_SECONDS ? 0 : seconds;
+                config.write = doc["content"]["write"] | true;
+                if (benchRequest(config))
                 {
-                    // Update global soundEnabled flag based on received content
-                    soundEnabled = (content && strcmp(content, "on") == 0);
-                    feedbackDoc["content"]["message"] = soundEnabled ? "Sound enabled" : "Sound disabled";
+                    benchQueued = true;
+                    feedbackDoc["content"]["seconds"] = config.seconds;
+                    feedbackDoc["content"]["message"] = "Benchmark started";
                 }
                 else
                 {
-                    // Unknown command
                     feedbackDoc["content"]["status"] = "error";
-                    feedbackDoc["content"]["message"] = "Unknown type";
+                    feedbackDoc["content"]["message"] = benchRunning() ? "Benchmark already running" : "Invalid benchmark";
                 }
-
-                // If no error, set status to ok
-                if (!feedbackDoc["content"]["status"])
-                    feedbackDoc["content"]["status"] = "ok";
-                feedbackDoc["type"] = "feedback";
-                // Release mutex after handling command
-                xSemaphoreGive(writeDataMutex);
             }
+            // Handle sound toggle command
+            else if (type && strcmp(type, "toggleSound") == 0)
+            {
+                // Update global soundEnabled flag based on received content
+                soundEnabled = (content && strcmp(content, "on") == 0);
+                feedbackDoc["content"]["message"] = soundEnabled ? "Sound enabled" : "Sound disabled";
+            }
+            else
+            {
+                // Unknown command
+                feedbackDoc["content"]["status"] = "error";
+                feedbackDoc["content"]["message"] = "Unknown type";
+            }
+
+            // Release mutex after handling command
+            xSemaphoreGive(writeDataMutex);
         }
 
-        // Send feedback JSON to BLE client
-        serializeJson(feedbackDoc, feedbackJson);
-        characteristic->setValue(feedbackJson.c_str());
-        characteristic->notify();
-        // Signal buzzer task to provide feedback
-        xSemaphoreGive(buzzerSemaphore);
+        // If no error, set status to ok
+        if (!feedbackDoc["content"]["status"])
+            feedbackDoc["content"]["status"] = "ok";
+        feedbackDoc["type"] = "feedback";
+
+        // The RFID engine only re-reads the mode when told to
+        if (modeChanged)
+            rfidNotify(RFID_EVENT_MODE);
+        if (profileChanged)
+            rfidNotify(RFID_EVENT_PROFILE);
+        if (benchQueued)
+            rfidNotify(RFID_EVENT_BENCH);
+    }
+
+    // On the command channel the ack is notified right here and never waits behind
+    // the results stream. A legacy command is acked in-stream through the BLE task,
+    // which owns the results characteristic
+    if (command.origin == commandCharacteristic)
+    {
+        static char ack[BLE_COMMAND_MAX_BYTES];
+        size_t length = serializeJson(feedbackDoc, ack, sizeof(ack));
+        commandCharacteristic->setValue((uint8_t *)ack, length);
+        commandCharacteristic->notify();
+    }
+    else
+        sendJsonMessage(feedbackDoc, MESSAGE_RELIABLE);
+    const char *status = feedbackDoc["content"]["status"];
+    uiPlay(status && strcmp(status, "error") == 0 ? UI_PATTERN_ERROR : UI_PATTERN_SINGLE);
+
+    if (statsRequested)
+    {
+        queueStats();
+        // "reset" starts a fresh measurement window after this report
+        const char *content = doc["content"];
+        if (content && strcmp(content, "reset") == 0)
+        {
+            latencyReset();
+            powerReset();
+        }
+    }
+}
+
+class MyCallbacks : public BLECharacteristicCallbacks
+{
+    void onWrite(BLECharacteristic *characteristic) override
+    {
+        // Bluedroid context: copy the write and hand it over, nothing here may block
+        static BleCommand incoming;
+        size_t length = characteristic->getLength();
+        if (length == 0)
+            return;
+        if (length > BLE_COMMAND_MAX_BYTES)
+            length = BLE_COMMAND_MAX_BYTES; // Cut short: answered as invalid JSON
+
+        incoming.origin = characteristic;
+        incoming.length = length;
+        memcpy(incoming.data, characteristic->getData(), length);
+        incoming.data[length] = '\0';
+
+        if (xQueueSend(commandQueue, &incoming, 0) != pdPASS)
+        {
+            commandsDropped++;
+            // Fixed text: refusing costs no parsing and no allocation
+            static const char busy[] = "{\"type\":\"feedback\",\"content\":{\"status\":\"error\",\"message\":\"Busy, command dropped\"}}";
+            if (characteristic == commandCharacteristic)
+            {
+                characteristic->setValue((uint8_t *)busy, sizeof(busy) - 1);
+                characteristic->notify();
+            }
+        }
     }
 };
 
+void commandTask(void *parameter)
+{
+    static BleCommand command;
+
+    for (;;)
+    {
+        if (xQueueReceive(commandQueue, &command, portMAX_DELAY) != pdPASS)
+            continue;
+        handleCommand(command);
+        commandArena.reset();
+    }
+}
+
 //==============================================================================
 // BLE SETUP FUNCTION
 //==============================================================================
@@ -166,24 +649,43 @@ void setupBLE()
 {
     // Initialize BLE device with custom name
     BLEDevice::init(DEVICE_ID);
+    // Accept a large ATT MTU when the client requests the exchange
+    BLEDevice::setMTU(BLE_LOCAL_MTU);
+    // Track the connection parameters the central actually applies
+    BLEDevice::setCustomGapHandler(gapEventHandler);
+    // Flow control for the session pulls
+    BLEDevice::setCustomGattsHandler(gattsEventHandler);
     // Create BLE server and set connection callbacks
     pServer = BLEDevice::createServer();
     pServer->setCallbacks(new MyServerCallbacks());
     // Create BLE service with custom UUID
     BLEService *pService = pServer->createService(SERVICE_UUID);
 
-    // Create BLE characteristic with read, write, notify, and indicate properties
+    MyCallbacks *commandCallbacks = new MyCallbacks();
+
+    // Command channel: writes with or without response, acks notified back on it
+    commandCharacteristic = pService->createCharacteristic(
+        COMMAND_CHARACTERISTIC_UUID,
+        BLECharacteristic::PROPERTY_WRITE |
+            BLECharacteristic::PROPERTY_WRITE_NR |
+            BLECharacteristic::PROPERTY_NOTIFY);
+    commandCharacteristic->addDescriptor(new BLE2902());
+    commandCharacteristic->setCallbacks(commandCallbacks);
+
+    // Results stream: tag reads, write/bulk results, stats and link info. It keeps
+    // taking writes so apps from before the split still work (acked in-stream)
     pCharacteristic = pService->createCharacteristic(
         CHARACTERISTIC_UUID,
-        BLECharacteristic::PROPERTY_READ |
-            BLECharacteristic::PROPERTY_WRITE |
-            BLECharacteristic::PROPERTY_NOTIFY |
-            BLECharacteristic::PROPERTY_INDICATE);
-
-    // Add descriptor for BLE notifications
-    pCharacteristic->addDescriptor(new BLE2902());
-    // Set custom callbacks for BLE characteristic
-    pCharacteristic->setCallbacks(new MyCallbacks());
+        BLECharacteristic::PROPERTY_WRITE |
+            BLECharacteristic::PROPERTY_NOTIFY);
+    resultsCccd = new BLE2902();
+    pCharacteristic->addDescriptor(resultsCccd);
+    pCharacteristic->setCallbacks(commandCallbacks);
+
+    // Bulk channel: binary session batches only, so they never mix with the JSON stream
+    sessionCharacteristic = pService->createCharacteristic(SESSION_CHARACTERISTIC_UUID, BLECharacteristic::PROPERTY_NOTIFY);
+    sessionCccd = new BLE2902();
+    sessionCharacteristic->addDescriptor(sessionCccd);
     // Start BLE service
     pService->start();
 
@@ -191,34 +693,277 @@ void setupBLE()
     BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
     pAdvertising->addServiceUUID(SERVICE_UUID);
     pAdvertising->setScanResponse(true);
-    pAdvertising->setMinPreferred(0x06);
-    pAdvertising->setMinPreferred(0x12);
+    pAdvertising->setMinPreferred(BLE_CONN_INTERVAL_MIN);
+    pAdvertising->setMaxPreferred(BLE_CONN_INTERVAL_MAX);
     // Start advertising so clients can discover the device
     BLEDevice::startAdvertising();
-    Serial.println("BLE service started, waiting for client...");
+    LOG_I("BLE service started, waiting for client...");
 }
 
 //==============================================================================
 // BLUETOOTH SENDER TASK
 //==============================================================================
+
+// Payload bytes notified on the results and session streams (BLE task only)
+static uint32_t notifiedBytes = 0;
+
+uint32_t bleNotifiedBytes()
+{
+    return notifiedBytes;
+}
+
+/**
+ * @brief Notifies @p length bytes on @p characteristic, timed as LAT_BLE_NOTIFY.
+ */
+static void notifyValue(BLECharacteristic *characteristic, const uint8_t *data, size_t length)
+{
+    int64_t notifyStart = latencyNow();
+    characteristic->setValue((uint8_t *)data, length);
+    characteristic->notify();
+    latencyRecord(LAT_BLE_NOTIFY, notifyStart);
+    notifiedBytes += length;
+}
+
+/**
+ * @brief Notifies the pending binary batch (if any) and starts a new one.
+ */
+static void flushBatch(TagBatch &batch)
+{
+    if (batch.size() > 0 && subscribed(resultsCccd))
+        notifyValue(pCharacteristic, batch.data(), batch.size());
+    // Size the next batch to what the link can carry in one notification
+    batch.reset(linkMtu - 3);
+}
+
+/**
+ * @brief Sends one tag read as readResult/inventoryResult JSON, right from the BLE task.
+ */
+static void notifyTagJson(const TagReport &report)
+{
+    // Nobody listening: skip the serialization too
+    if (!subscribed(resultsCccd))
+        return;
+
+    static char json[MESSAGE_BUFFER_SIZE];
+    size_t length = tagOutputJson(report, json, sizeof(json));
+    if (length == 0)
+        return;
+
+    LOG_D("Sending via BLE: %s", json);
+    notifyValue(pCharacteristic, (const uint8_t *)json, length);
+    if (report.originUs != 0)
+        latencyRecord(LAT_POLL_TO_NOTIFY, report.originUs);
+}
+
+//==============================================================================
+// SESSION PULLS
+//==============================================================================
+
+// Pull being streamed (BLE task only)
+static bool pulling = false;
+static uint32_t pullNext = 0;
+static uint32_t pullEnd = 0;
+static uint32_t pullSent = 0;
+static SessionRead pullReads[SESSION_PULL_READS];
+static TagBatch pullBatch;
+
+/**
+ * @brief Takes a pull handed over by the command task. The range ends at what
+ *        was stored when the pull started; later reads go live as usual.
+ */
+static void startPull()
+{
+    uint32_t from, count;
+    portENTER_CRITICAL(&pullMux);
+    bool requested = pullRequested;
+    pullRequested = false;
+    from = pullRequestFrom;
+    count = pullRequestCount;
+    portEXIT_CRITICAL(&pullMux);
+
+    if (!requested)
+        return;
+
+    // Reads still in RAM become visible to sessionStoreRead()
+    sessionStoreFlush();
+    uint32_t next = sessionStoreStats().next;
+    if (from > next)
+        from = next;
+
+    pulling = true;
+    pullNext = from;
+    pullEnd = (count > 0 && count < next - from) ? from + count : next;
+    pullSent = 0;
+}
+
+static void finishPull(const char *status)
+{
+    pulling = false;
+
+    JsonDocument doc;
+    doc["type"] = "sessionPullDone";
+    doc["content"]["status"] = status;
+    doc["content"]["sent"] = pullSent;
+    doc["content"]["next"] = pullNext;
+    sendJsonMessage(doc, MESSAGE_RELIABLE);
+}
+
+/**
+ * @brief Sends one notification of the pull: as many consecutive stored reads as
+ *        the link MTU carries.
+ */
+static void sendPullChunk()
+{
+    if (!subscribed(sessionCccd))
+    {
+        finishPull("error");
+        return;
+    }
+
+    uint32_t wanted = pullEnd - pullNext;
+    uint16_t count = sessionStoreRead(pullNext, pullReads, wanted < SESSION_PULL_READS ? wanted : SESSION_PULL_READS);
+    if (count == 0)
+    {
+        finishPull("ok");
+        return;
+    }
+
+    // Records of one batch are consecutive: a gap (lost block or rotation) starts a new one
+    pullBatch.resetSession(linkMtu - 3, pullReads[0].seq);
+    uint16_t added = 0;
+    while (added < count && pullReads[added].seq == pullReads[0].seq + added &&
+           pullReads[added].seq < pullEnd && pullBatch.add(pullReads[added].report))
+        added++;
+
+    if (added == 0)
+    {
+        // One record does not fit in the payload: the client must request a bigger MTU
+        finishPull("error");
+        return;
+    }
+
+    notifyValue(sessionCharacteristic, pullBatch.data(), pullBatch.size());
+
+    pullSent += added;
+    pullNext = pullReads[added - 1].seq + 1;
+    if (pullNext >= pullEnd)
+        finishPull("ok");
+}
+
 void bluetoothTask(void *parameter)
 {
-    char receivedJson[256];
+    MessageHandle message;
+    TagReport report;
+    TagBatch batch;
+    TickType_t batchStartedAt = 0;
+    TickType_t storedAt = 0;
+
+    batch.reset(linkMtu - 3);
+
     for (;;)
     {
-        // Wait for JSON data from the queue (produced by other tasks)
-        if (xQueueReceive(jsonDataQueue, &receivedJson, portMAX_DELAY) == pdPASS)
+        // Sleep until a message arrives or the pending batch is due
+        TickType_t wait = portMAX_DELAY;
+        if (batch.count() > 0)
+        {
+            TickType_t elapsed = xTaskGetTickCount() - batchStartedAt;
+            TickType_t window = pdMS_TO_TICKS(BLE_BATCH_FLUSH_MS);
+            wait = (elapsed < window) ? window - elapsed : 0;
+        }
+        if (sessionStorePending() > 0)
+        {
+            TickType_t elapsed = xTaskGetTickCount() - storedAt;
+            TickType_t window = pdMS_TO_TICKS(SESSION_STORE_FLUSH_MS);
+            TickType_t due = (elapsed < window) ? window - elapsed : 0;
+            if (due < wait)
+                wait = due;
+        }
+        if (tagStorePending() > 0)
+        {
+            uint32_t age = tagStorePendingMs();
+            TickType_t due = pdMS_TO_TICKS(age < TAG_STORE_FLUSH_MS ? TAG_STORE_FLUSH_MS - age : 0);
+            if (due < wait)
+                wait = due;
+        }
+        // A pull only yields to live traffic; congestion parks it until the stack drains
+        if (pulling && !linkCongested)
+            wait = 0;
+
+        QueueSetMemberHandle_t ready = xQueueSelectFromSet(bleQueueSet, wait);
+
+        if (ready == tagReportDoorbell && xSemaphoreTake(tagReportDoorbell, 0) == pdTRUE)
+        {
+            // One doorbell may stand for many pushes: drain the ring
+            while (tagRing.pop(report))
+            {
+                // Trigger released: the reads and TIDs of the pull go to flash now
+                if (report.endOfSession)
+                {
+                    sessionStoreFlush();
+                    tagStoreFlush();
+                }
+                if (!tagOutputAccept(report))
+                    continue;
+                // Inventory bursts tick at a capped rate instead of queueing beeps
+                uiPlay(inventoryMode ? UI_PATTERN_TICK : UI_PATTERN_SINGLE);
+
+                // Every reported read is kept for session pulls, sent live or not
+                sessionStoreAppend(report);
+                storedAt = xTaskGetTickCount();
+
+                if (!binaryOutput)
+                {
+                    flushBatch(batch);
+                    notifyTagJson(report);
+                    continue;
+                }
+
+                // Full batch: send it and start the next one with this record.
+                // A record larger than the whole payload (default 23-byte MTU with a TID)
+                // is dropped: the client must request a bigger MTU for binary output.
+                if (!batch.add(report))
+                {
+                    flushBatch(batch);
+                    batch.add(report);
+                }
+                if (batch.count() == 1)
+                    batchStartedAt = xTaskGetTickCount();
+            }
+        }
+        else if (ready == jsonDataQueue && xQueueReceive(jsonDataQueue, &message, 0) == pdPASS)
         {
-            // Only send data if BLE client is connected and characteristic is valid
-            if (bluetoothConnected && pCharacteristic != nullptr)
+            // Keep ordering: tag reads queued before this message go out first
+            flushBatch(batch);
+            latencyRecord(LAT_QUEUE_WAIT, messageQueuedAt(message));
+
+            // Only send data if the client is subscribed to the results stream
+            if (subscribed(resultsCccd))
             {
-                Serial.print("Sending via BLE: ");
-                Serial.println(receivedJson);
-                // Set characteristic value and notify client
-                pCharacteristic->setValue((uint8_t *)receivedJson, strlen(receivedJson));
-                pCharacteristic->notify();
+                const char *json = messageData(message);
+                LOG_D("Sending via BLE: %s", json);
+                // Set characteristic value and notify client (the stack copies it)
+                notifyValue(pCharacteristic, (const uint8_t *)json, strlen(json));
+                if (messageOriginAt(message) != 0)
+                    latencyRecord(LAT_POLL_TO_NOTIFY, messageOriginAt(message));
             }
             // If not connected, discard the message (no notification sent)
+            releaseMessage(message);
         }
+
+        // Partial batch whose flush window expired
+        if (batch.count() > 0 && xTaskGetTickCount() - batchStartedAt >= pdMS_TO_TICKS(BLE_BATCH_FLUSH_MS))
+            flushBatch(batch);
+
+        // Reads in RAM with nothing new for a while: write the block
+        if (sessionStorePending() > 0 && xTaskGetTickCount() - storedAt >= pdMS_TO_TICKS(SESSION_STORE_FLUSH_MS))
+            sessionStoreFlush();
+
+        // TIDs and writes logged by the radio core: written here, off the radio path
+        if (tagStorePending() > 0 && tagStorePendingMs() >= TAG_STORE_FLUSH_MS)
+            tagStoreFlush();
+
+        startPull();
+        if (pulling && !linkCongested)
+            sendPullChunk();
     }
-}
\ No newline at end of file
+}
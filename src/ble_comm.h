@@ -8,6 +8,22 @@
 #ifndef BLE_COMM_H
 #define BLE_COMM_H
 
+#include <Arduino.h>
+#include "config.h"
+
+class BLECharacteristic;
+
+/**
+ * @struct BleCommand
+ * @brief One client write, copied out of the Bluedroid callback for the command task.
+ */
+struct BleCommand
+{
+    BLECharacteristic *origin;            ///< Characteristic written (the ack goes back through it).
+    uint16_t length;                      ///< Bytes in @p data, without the terminator.
+    char data[BLE_COMMAND_MAX_BYTES + 1]; ///< The JSON text, NUL-terminated.
+};
+
 /**
  * @brief Initializes the BLE server, service, characteristic, and starts advertising.
  */
@@ -19,4 +35,13 @@ void setupBLE();
  */
 void bluetoothTask(void *parameter);
 
+/**
+ * @brief FreeRTOS task that parses and runs the commands queued by the BLE write callback.
+ * @param parameter Unused task parameter.
+ */
+void commandTask(void *parameter);
+
+/** @brief Payload bytes notified on the results and session streams since boot. */
+uint32_t bleNotifiedBytes();
+
 #endif // BLE_COMM_H
\ No newline at end of file
@@ -0,0 +1,194 @@
+/**
+ * @file bulk_job.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the bulk encoding job.
+ * @date 2026-10-14
+ */
+
+#include "bulk_job.h"
+
+BulkJob::BulkJob(TagDedupSlot *doneTidSlots, uint16_t doneTidCapacity)
+    : _doneTids(doneTidSlots, doneTidCapacity, 0)
+{
+    clear();
+}
+
+void BulkJob::clear()
+{
+    memset(_doneBits, 0, sizeof(_doneBits));
+    _doneTids.clear();
+    _state = BULK_IDLE;
+    _total = 0;
+    _done = 0;
+    _failures = 0;
+    _cursor = 0;
+    _started = false;
+    _startedAt = 0;
+    _finishedAt = 0;
+}
+
+uint32_t BulkJob::hashPayload(const uint8_t *bytes)
+{
+    // FNV-1a 32 bits over the payload
+    uint32_t hash = 0x811C9DC5;
+    for (uint8_t i = 0; i < WRITE_PAYLOAD_BYTES; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+void BulkJob::appendPayload(const uint8_t *bytes)
+{
+    uint16_t index = _total++;
+    memcpy(_items[index], bytes, WRITE_PAYLOAD_BYTES);
+
+    // Insertion keeps _byHash sorted; equal hashes stay in index order
+    uint32_t hash = hashPayload(bytes);
+    uint16_t pos = index;
+    while (pos > 0 && _byHash[pos - 1].hash > hash)
+    {
+        _byHash[pos] = _byHash[pos - 1];
+        pos--;
+    }
+    _byHash[pos].hash = hash;
+    _byHash[pos].index = index;
+
+    _state = BULK_RUNNING;
+}
+
+bool BulkJob::addItem(const char *data)
+{
+    if (_total >= BULK_JOB_CAPACITY)
+        return false;
+
+    uint8_t bytes[WRITE_PAYLOAD_BYTES] = {};
+    encodeWritePayload(data, bytes, sizeof(bytes));
+    appendPayload(bytes);
+    return true;
+}
+
+bool BulkJob::addTemplate(const char *pattern, uint32_t first, uint16_t count, uint8_t width)
+{
+    if (count == 0 || count > BULK_JOB_CAPACITY - _total || strlen(pattern) > BULK_TEMPLATE_MAX)
+        return false;
+
+    const char *slot = strstr(pattern, "{n}");
+    int prefixLen = slot ? (int)(slot - pattern) : (int)strlen(pattern);
+    const char *suffix = slot ? slot + 3 : "";
+
+    // Só os primeiros WRITE_PAYLOAD_BYTES caracteres viram payload: o resto pode ser cortado
+    char text[BULK_TEMPLATE_MAX + 2 * 10 + 1];
+    for (uint16_t i = 0; i < count; i++)
+    {
+        int length = snprintf(text, sizeof(text), "%.*s%0*lu%s", prefixLen, pattern, (int)width,
+                              (unsigned long)(first + i), suffix);
+        if (length < 0)
+            return false;
+
+        uint8_t bytes[WRITE_PAYLOAD_BYTES] = {};
+        encodeWritePayload(text, bytes, sizeof(bytes));
+        appendPayload(bytes);
+    }
+    return true;
+}
+
+void BulkJob::cancel(uint32_t nowMs)
+{
+    if (_state != BULK_RUNNING)
+        return;
+    _state = BULK_CANCELLED;
+    _finishedAt = nowMs;
+}
+
+int BulkJob::nextPayload(R200Tag &payload) const
+{
+    uint16_t index = _cursor;
+    while (index < _total && isDone(index))
+        index++;
+    if (index >= _total)
+        return -1;
+
+    payloadAt(index, payload);
+    return index;
+}
+
+void BulkJob::payloadAt(uint16_t index, R200Tag &payload) const
+{
+    memcpy(payload.epc, _items[index], WRITE_PAYLOAD_BYTES);
+    payload.epcLen = WRITE_PAYLOAD_BYTES;
+}
+
+int BulkJob::classify(const R200Tag &tag) const
+{
+    // What writeEPC() leaves from word 2 on is the payload, even on longer EPCs
+    if (tag.epcLen < WRITE_PAYLOAD_BYTES)
+        return BULK_TAG_NEW;
+
+    uint32_t hash = hashPayload(tag.epc);
+
+    // First entry with this hash
+    uint16_t lo = 0, hi = _total;
+    while (lo < hi)
+    {
+        uint16_t mid = (lo + hi) / 2;
+        if (_byHash[mid].hash < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    bool sawDone = false;
+    for (uint16_t i = lo; i < _total && _byHash[i].hash == hash; i++)
+    {
+        uint16_t index = _byHash[i].index;
+        if (memcmp(_items[index], tag.epc, WRITE_PAYLOAD_BYTES) != 0)
+            continue;
+        if (!isDone(index))
+            return index;
+        sawDone = true;
+    }
+    return sawDone ? BULK_TAG_DONE : BULK_TAG_NEW;
+}
+
+bool BulkJob::doneTid(const R200TID &tid)
+{
+    return _doneTids.contains(tid.bytes, tid.len, 0);
+}
+
+void BulkJob::markAttempt(uint32_t nowMs)
+{
+    if (_started)
+        return;
+    _started = true;
+    _startedAt = nowMs;
+}
+
+void BulkJob::markDone(uint16_t index, const R200TID &tid, uint32_t nowMs)
+{
+    if (index >= _total || isDone(index))
+        return;
+
+    _doneBits[index / 8] |= (1 << (index % 8));
+    _done++;
+    _doneTids.mark(tid.bytes, tid.len, 0);
+
+    while (_cursor < _total && isDone(_cursor))
+        _cursor++;
+
+    if (_done == _total && _state == BULK_RUNNING)
+    {
+        _state = BULK_DONE;
+        _finishedAt = nowMs;
+    }
+}
+
+uint32_t BulkJob::elapsedMs(uint32_t nowMs) const
+{
+    if (!_started)
+        return 0;
+    if (_state == BULK_DONE || _state == BULK_CANCELLED)
+        return _finishedAt - _startedAt;
+    return nowMs - _startedAt;
+}
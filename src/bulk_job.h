@@ -0,0 +1,148 @@
+/**
+ * @file bulk_job.h
+ * @author Luis Felipe Patrocinio
+ * @brief Payload list or template assigned to tags by the bulk encoding mode.
+ * @date 2026-10-14
+ *
+ * @note A job holds up to BULK_JOB_CAPACITY payloads, either loaded one by one or
+ *       generated from a template such as "BOX-{n}". Payloads are handed out in
+ *       order; every tag already carrying one of them is recognized by its EPC
+ *       (hash index over the encoded payloads), so a job restarted after a reboot
+ *       only confirms the tags that are done instead of overwriting them.
+ *
+ *       The same payload may appear several times in a list, so a tag carrying it
+ *       is only counted once: the caller confirms it by TID (doneTid()).
+ */
+
+#ifndef BULK_JOB_H
+#define BULK_JOB_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "r200_protocol.h"
+#include "tag_dedup.h"
+#include "text_codec.h"
+
+/** @brief Longest template accepted by addTemplate(), without the terminating NUL. */
+#define BULK_TEMPLATE_MAX 24
+
+/** @brief classify() result: the tag is blank or foreign and gets the next payload. */
+#define BULK_TAG_NEW -1
+
+/** @brief classify() result: every job index with the tag's payload is already done. */
+#define BULK_TAG_DONE -2
+
+/** @brief Job lifecycle. */
+enum BulkJobState
+{
+    BULK_IDLE,     ///< No job loaded.
+    BULK_RUNNING,  ///< Payloads left to write.
+    BULK_DONE,     ///< Every payload was written and confirmed.
+    BULK_CANCELLED ///< Cancelled by the app or a mode change.
+};
+
+/**
+ * @class BulkJob
+ * @brief Job payloads, per-index progress and throughput counters.
+ */
+class BulkJob
+{
+public:
+    /**
+     * @param doneTidSlots Storage for the TIDs confirmed in this job (not owned).
+     * @param doneTidCapacity Number of slots; a power of two >= 4/3 of BULK_JOB_CAPACITY.
+     */
+    BulkJob(TagDedupSlot *doneTidSlots, uint16_t doneTidCapacity);
+
+    /** @brief Drops the job and goes back to BULK_IDLE. */
+    void clear();
+
+    /**
+     * @brief Appends one payload (same encoding as writeData) and starts the job.
+     * @return false if the job is full.
+     */
+    bool addItem(const char *data);
+
+    /**
+     * @brief Appends @p count payloads generated from @p pattern.
+     *
+     * "{n}" in the pattern is replaced by first, first + 1, ... left-padded with
+     * zeros to @p width digits; without "{n}" the number is appended.
+     *
+     * @return false (nothing added) if the pattern is too long or the payloads do not fit.
+     */
+    bool addTemplate(const char *pattern, uint32_t first, uint16_t count, uint8_t width);
+
+    /** @brief Stops a running job; the caller reports it and clear()s. */
+    void cancel(uint32_t nowMs);
+
+    BulkJobState state() const { return _state; }
+
+    /** @brief Payloads in the job. */
+    uint16_t total() const { return _total; }
+
+    /** @brief Payloads written (or found already written) and confirmed. */
+    uint16_t done() const { return _done; }
+
+    /** @brief Write attempts that the readback did not confirm. */
+    uint16_t failures() const { return _failures; }
+
+    /**
+     * @brief Next payload to write (lowest index not done yet).
+     * @return Its index, or -1 when nothing is left.
+     */
+    int nextPayload(R200Tag &payload) const;
+
+    /** @brief Encoded payload of job index @p index. */
+    void payloadAt(uint16_t index, R200Tag &payload) const;
+
+    /**
+     * @brief Tells what to do with a tag seen in the field.
+     * @return A pending index whose payload the tag already carries (confirm it by
+     *         TID), BULK_TAG_NEW (write the next payload) or BULK_TAG_DONE (skip).
+     */
+    int classify(const R200Tag &tag) const;
+
+    /** @brief true if @p tid was already confirmed in this job. */
+    bool doneTid(const R200TID &tid);
+
+    /** @brief First attempt on a tag; starts the throughput clock. */
+    void markAttempt(uint32_t nowMs);
+
+    /** @brief Index @p index is on the chip @p tid; finishes the job after the last one. */
+    void markDone(uint16_t index, const R200TID &tid, uint32_t nowMs);
+
+    /** @brief A write the readback did not confirm. */
+    void markFailure() { _failures++; }
+
+    /** @brief Milliseconds from the first attempt to now (or to the end of the job). */
+    uint32_t elapsedMs(uint32_t nowMs) const;
+
+private:
+    /** @brief Hash index entry, sorted by hash for binary search. */
+    struct IndexEntry
+    {
+        uint32_t hash;
+        uint16_t index;
+    };
+
+    uint8_t _items[BULK_JOB_CAPACITY][WRITE_PAYLOAD_BYTES];
+    IndexEntry _byHash[BULK_JOB_CAPACITY];
+    uint8_t _doneBits[(BULK_JOB_CAPACITY + 7) / 8];
+    TagDedup _doneTids;
+
+    BulkJobState _state;
+    uint16_t _total;
+    uint16_t _done;
+    uint16_t _failures;
+    uint16_t _cursor; ///< Lowest index that may still be pending.
+    bool _started;
+    uint32_t _startedAt;
+    uint32_t _finishedAt;
+
+    static uint32_t hashPayload(const uint8_t *bytes);
+    bool isDone(uint16_t index) const { return _doneBits[index / 8] & (1 << (index % 8)); }
+    void appendPayload(const uint8_t *bytes);
+};
+
+#endif // BULK_JOB_H
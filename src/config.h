@@ -23,6 +23,8 @@
 #define READ_BUTTON_PIN 21
 #define LED_PIN 2
 
+#define TRIGGER_DEBOUNCE_MS 20 // Janela de repique do gatilho após cada mudança reportada (ver trigger.h)
+
 //==============================================================================
 // R200 PROTOCOL CONSTANTS (Faltavam estas linhas!)
 //==============================================================================
@@ -30,6 +32,183 @@
 #define FRAME_HEAD 0xAA // Cabeçalho do pacote
 #define FRAME_END 0xDD  // Rodapé do pacote
 
+// Task dona da UART (ver R200Driver::begin)
+#define R200_RX_BUFFER_SIZE 1024  // Buffer de RX do driver da UART (bursts do 0x27)
+#define R200_FRAME_QUEUE_LEN 16   // Notificações de tag aguardando consumo
+#define R200_COMMAND_QUEUE_LEN 8  // Comandos aguardando a vez na linha
+
+// Boot: o 0x03 é repetido até o R200 responder (ver R200Driver::handshake)
+#define R200_HANDSHAKE_WINDOW_MS 20 // Janela de cada tentativa
+#define R200_BOOT_TIMEOUT_MS 1500   // Sem resposta nesse tempo, o boot segue sem o R200
+
+// Ciclos por comando de inventário contínuo (0x27), padrão dos perfis (ver reader_profile.h).
+// O valor máximo do protocolo é 65535; 10000 ciclos cobrem vários minutos de gatilho pressionado.
+#define R200_MULTI_POLL_ROUNDS 10000
+
+// Ajuste automático do Q do inventário contínuo (ver q_tuner.h)
+#define Q_TUNE_WINDOW_MS 500       // Janela de medição entre ajustes
+#define Q_TUNE_MIN 1               // Limites do Q escolhido (2^Q slots por ciclo)
+#define Q_TUNE_MAX 8
+#define Q_TUNE_SEEN_CAPACITY 512   // EPCs distintos contados por janela (potência de 2, 16 bytes cada)
+
+//==============================================================================
+// TASK TOPOLOGY (ver main.cpp)
+//==============================================================================
+// Núcleo do rádio: UART do R200 e lógica de leitura/gravação. Núcleo de saída:
+// controlador BT e Bluedroid (fixos no 0 pelo IDF), task BLE (filtro de
+// repetição, JSON/lotes, notify), task de comandos e UI.
+#define RADIO_CORE 1
+#define OUTPUT_CORE 0
+
+#define R200_UART_TASK_PRIORITY 18 // Tempo real: acima de toda a aplicação, abaixo das tasks do IDF (ipc, esp_timer)
+#define RFID_TASK_PRIORITY 2
+#define BLE_TASK_PRIORITY 2
+#define COMMAND_TASK_PRIORITY 3    // Acima da task BLE: o ack não espera o fluxo de leituras
+#define UI_TASK_PRIORITY 1
+#define LOG_TASK_PRIORITY 1        // Só escoa o log; qualquer outra task passa na frente
+
+// Pilhas em bytes. Ajuste pelo pico medido (stats "tasks", ou 's' no console) com ~1 KB de folga
+#define R200_UART_TASK_STACK 4096
+#define RFID_TASK_STACK 6144       // Lote de TIDs na pilha (leitura, gravação e lote na mesma task)
+#define BLE_TASK_STACK 5120        // Lote binário + JSON das leituras
+#define COMMAND_TASK_STACK 4096    // Documentos na arena estática, não na pilha
+#define UI_TASK_STACK 2048
+#define LOG_TASK_STACK 2048
+
+#define TAG_RING_CAPACITY 64       // Leituras em trânsito até a task BLE (potência de 2, ~72 bytes cada)
+
+//==============================================================================
+// TAG DEDUPLICATION (ver tag_dedup.h)
+//==============================================================================
+#define TAG_DEDUP_CAPACITY 2048        // Slots do filtro de leitura (potência de 2, 16 bytes cada)
+#define TAG_DEDUP_WINDOW_MS 3000       // Tag fora do campo por mais que isso é reportada de novo (padrão do perfil)
+#define TAG_WRITE_SESSION_CAPACITY 256 // Slots da memória de sessão de gravação
+
+// Cache EPC -> TID do modo leitura (limpo ao soltar o gatilho, ver tid_cache.h)
+#define TID_CACHE_CAPACITY 64          // Entradas (potência de 2, ~52 bytes cada)
+#define TID_ROUND_GAP_MS 8             // Silêncio que encerra a rajada de notificações de uma rodada
+
+// Mapa EPC -> TID e log de gravações persistidos na flash (LittleFS, ver tag_store.h)
+#define TAG_STORE_CAPACITY 256           // EPCs mantidos em RAM (potência de 2, ~52 bytes cada)
+#define TAG_STORE_AMBIGUOUS_CAPACITY 256 // EPCs vistos em mais de um chip (potência de 2, 16 bytes cada)
+#define TAG_STORE_ROTATE_RECORDS 2048    // Registros (36 bytes) por arquivo antes de rotacionar o log
+#define TAG_STORE_FLUSH_RECORDS 16       // Registros juntados em RAM; cheio, o próprio núcleo do rádio grava
+#define TAG_STORE_FLUSH_MS 1000          // Idade do registro mais antigo em RAM antes da task do BLE gravar
+
+//==============================================================================
+// INVENTORY SESSION STORE (ver session_store.h)
+//==============================================================================
+#define SESSION_STORE_ROTATE_RECORDS 8192 // Leituras (40 bytes) por arquivo; guarda entre 8192 e 16384
+#define SESSION_STORE_FLUSH_RECORDS 32    // Leituras juntadas em RAM por gravação na flash
+#define SESSION_STORE_FLUSH_MS 500        // Bloco parcial vai para a flash após esse tempo sem leituras
+#define SESSION_PULL_READS 24             // Leituras lidas da flash por notificação de um pull
+
+//==============================================================================
+// BULK ENCODING (ver bulk_job.h)
+//==============================================================================
+#define BULK_JOB_CAPACITY 256          // Payloads por job (lista ou modelo)
+#define BULK_DONE_TID_CAPACITY 512     // TIDs confirmados no job (potência de 2, >= 4/3 do job)
+#define BULK_POLL_WINDOW_MS 80         // Janela de coleta das tags de cada rodada
+#define BULK_WRITE_TIMEOUT_MIN_MS 40   // Limites da janela adaptativa do 0x49
+#define BULK_WRITE_TIMEOUT_MAX_MS 800
+#define BULK_READ_TIMEOUT_MIN_MS 20    // Limites da janela adaptativa do 0x39
+#define BULK_READ_TIMEOUT_MAX_MS 150
+
+//==============================================================================
+// TX POWER / RSSI (ver power_control.h)
+//==============================================================================
+#define TX_POWER_MIN_DBM 15        // Piso do controle de potência (leitura/gravação)
+#define TX_POWER_MAX_DBM 26        // Teto do controle e potência do boot (padrão do perfil)
+#define TX_POWER_START_DBM 20      // Ponto de partida do controle de tag mais próxima
+#define TX_POWER_INVENTORY_DBM 26  // Inventário fica na potência máxima (alcance; padrão do perfil)
+#define TX_POWER_STEP_DB 1         // Passo de cada ajuste
+#define TX_POWER_EMPTY_ROUNDS 3    // Rodadas seguidas sem tag antes de subir a potência
+#define RSSI_NEAREST_MIN_DBM -70   // Tags mais fracas são ignoradas na leitura/gravação (antes do dedup)
+#define RSSI_INVENTORY_MIN_DBM -90 // Idem no inventário
+#define RSSI_TARGET_HIGH_DBM -45   // Tag mais forte acima disso: potência sobrando, desce
+#define RSSI_TARGET_LOW_DBM -60    // Tag mais forte abaixo disso: sobe
+#define RSSI_NEAREST_MARGIN_DB 6   // Vizinha a menos disso da mais forte conta como colisão
+
+// Escolha da tag alvo da gravação avulsa (ver write_target.h)
+#define WRITE_TARGET_MARGIN_DB 6   // Vantagem mínima, em dB, do alvo sobre a segunda tag da rodada
+#define WRITE_ATTEMPTS 3           // Tentativas do 0x49 com Select no TID antes de desistir
+
+//==============================================================================
+// POWER MANAGEMENT (ver power_manager.h)
+//==============================================================================
+#define POWER_CPU_MAX_MHZ 240      // Frequência com trabalho (DFS)
+#define POWER_CPU_MIN_MHZ 80       // Frequência ociosa (mínimo com BLE ativo)
+#define POWER_LIGHT_SLEEP true     // Light sleep automático no idle (exige tickless idle no sdkconfig)
+
+#define R200_SLEEP_IDLE_MS 30000   // Gatilho solto por mais que isso: R200 em sleep (0 = nunca; padrão do perfil)
+#define R200_WAKE_TIMEOUT_MS 20    // Janela de cada tentativa de acordar o R200
+#define R200_WAKE_ATTEMPTS 3       // Tentativas antes de desistir da rodada
+
+// Corrente medida: amplificador de shunt num pino ADC (-1 = sem sensor, só o modelo)
+#define POWER_SENSE_PIN -1
+#define POWER_SENSE_MA_PER_MV 0.2f // Ex.: shunt de 0,1 ohm com ganho 50 = 5 mV/mA
+#define POWER_SENSE_SAMPLES 32     // Leituras do ADC por medida
+
+// Modelo de consumo por estado em mA (referência: meça a sua placa e ajuste)
+#define POWER_MODEL_ESP32_MA 45          // ESP32 com BLE conectado
+#define POWER_MODEL_R200_ACTIVE_MA 180   // RF ligado (poll, inventário, gravação)
+#define POWER_MODEL_R200_IDLE_MA 40      // Acordado, RF desligado
+#define POWER_MODEL_R200_SLEEP_MA 1      // Sleep (0x17)
+
+//==============================================================================
+// JSON MESSAGE POOL (ver message_pool.h)
+//==============================================================================
+#define MESSAGE_POOL_SIZE 16       // Buffers de 256 bytes para mensagens JSON
+#define MESSAGE_POOL_RESERVED 4    // Buffers que leituras de inventário não podem usar
+#define MESSAGE_RELIABLE_WAIT_MS 50 // Espera máxima por buffer para resultados de leitura/gravação
+
+//==============================================================================
+// BLE LINK TUNING (ver setupBLE)
+//==============================================================================
+#define BLE_LOCAL_MTU 517          // MTU máximo aceito na troca pedida pelo cliente
+#define BLE_CONN_INTERVAL_MIN 6    // 7.5 ms (unidades de 1.25 ms)
+#define BLE_CONN_INTERVAL_MAX 12   // 15 ms
+#define BLE_CONN_LATENCY 0         // Eventos de conexão que o periférico pode pular
+#define BLE_CONN_TIMEOUT 400       // 4 s (unidades de 10 ms)
+
+//==============================================================================
+// BLE BINARY BATCHING (ver ble_batch.h)
+//==============================================================================
+#define BLE_BATCH_FLUSH_MS 50      // Lote parcial é enviado após esse tempo
+
+//==============================================================================
+// BLE COMMANDS (ver ble_comm.h)
+//==============================================================================
+#define BLE_COMMAND_MAX_BYTES 512  // Maior escrita aceita; o resto é cortado
+#define BLE_COMMAND_QUEUE_DEPTH 4  // Comandos à espera da task; cheia = recusado com "Busy"
+#define COMMAND_ARENA_BYTES 6144   // Arena do JSON do comando e do ack (ver json_arena.h)
+
+//==============================================================================
+// LOG (ver log.h)
+//==============================================================================
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO   // Nível compilado; -DLOG_LEVEL=LOG_LEVEL_DEBUG nos build_flags mostra cada leitura
+#endif
+#define LOG_RING_BYTES 4096        // Buffer das linhas à espera da serial (potência de 2); cheio = linha descartada
+#define LOG_LINE_MAX 256           // Maior linha formatada (na pilha de quem loga); o resto é cortado
+
+//==============================================================================
+// BENCHMARK (ver benchmark.h)
+//==============================================================================
+#define BENCH_DEFAULT_SECONDS 10   // Duração de cada fase ('b' no console, ou o comando sem "seconds")
+#define BENCH_MAX_SECONDS 300
+#define BENCH_UNIQUE_CAPACITY 512  // Slots do conjunto de EPCs distintos (potência de 2; 3/4 usáveis)
+
+//==============================================================================
+// UI FEEDBACK (ver ui_handler.h)
+//==============================================================================
+#define BUZZER_PASSIVE false       // true = buzzer passivo (o LEDC gera o tom); false = ativo (só liga/desliga)
+#define BUZZER_LEDC_CHANNEL 0
+#define BUZZER_TONE_HZ 2700        // Tom das confirmações (buzzer passivo)
+#define BUZZER_ERROR_TONE_HZ 900   // Tom dos erros (buzzer passivo)
+#define UI_PATTERN_QUEUE_LEN 4     // Padrões à espera do buzzer; cheia = padrão descartado
+#define UI_TICK_INTERVAL_MS 80     // Intervalo mínimo entre ticks do inventário
+
 //==============================================================================
 // GLOBAL FLAGS
 //==============================================================================
@@ -0,0 +1,64 @@
+/**
+ * @file json_arena.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the fixed-capacity ArduinoJson allocator.
+ * @date 2026-10-14
+ */
+
+#include "json_arena.h"
+
+// Each block is preceded by its size, so a moved block knows how much to copy
+static const size_t HEADER = sizeof(uint32_t);
+
+static inline size_t align4(size_t n) { return (n + 3) & ~(size_t)3; }
+
+void *JsonArena::allocate(size_t size)
+{
+    size_t needed = HEADER + align4(size);
+    if (needed > _size - _used)
+        return nullptr;
+
+    _last = _used;
+    *(uint32_t *)(_buffer + _last) = size;
+    _used += needed;
+    if (_used > _highWater)
+        _highWater = _used;
+    return _buffer + _last + HEADER;
+}
+
+void JsonArena::deallocate(void *ptr)
+{
+    // Only the newest block goes back; the rest waits for reset()
+    if (ptr && (uint8_t *)ptr == _buffer + _last + HEADER)
+        _used = _last;
+}
+
+void *JsonArena::reallocate(void *ptr, size_t newSize)
+{
+    if (!ptr)
+        return allocate(newSize);
+
+    uint8_t *block = (uint8_t *)ptr - HEADER;
+    size_t oldSize = *(uint32_t *)block;
+
+    // The newest block grows or shrinks in place
+    if (block == _buffer + _last)
+    {
+        size_t needed = HEADER + align4(newSize);
+        if (needed > _size - _last)
+            return nullptr;
+        *(uint32_t *)block = newSize;
+        _used = _last + needed;
+        if (_used > _highWater)
+            _highWater = _used;
+        return ptr;
+    }
+
+    if (newSize <= oldSize)
+        return ptr;
+
+    void *moved = allocate(newSize);
+    if (moved)
+        memcpy(moved, ptr, oldSize);
+    return moved;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file json_arena.h
+ * @author Luis Felipe Patrocinio
+ * @brief Fixed-capacity ArduinoJson allocator over a caller-provided buffer.
+ * @date 2026-10-14
+ *
+ * @note ArduinoJson 7 dropped StaticJsonDocument; a JsonDocument built with this
+ *       allocator gets the same bounded, heap-free behaviour. Blocks are carved
+ *       from the buffer in order and only the newest one can grow or be given
+ *       back, which is how a document fills up while it parses. Everything else
+ *       is reclaimed at once with reset() once the documents using it are gone.
+ *       A full arena makes deserializeJson() return NoMemory.
+ */
+
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * @class JsonArena
+ * @brief Bump allocator for the JsonDocuments of one unit of work.
+ */
+class JsonArena : public ArduinoJson::Allocator
+{
+public:
+    /**
+     * @param buffer Backing storage (not owned, 4-byte aligned).
+     * @param size Size of @p buffer in bytes.
+     */
+    JsonArena(uint8_t *buffer, size_t size) : _buffer(buffer), _size(size), _used(0), _last(0), _highWater(0) {}
+
+    void *allocate(size_t size) override;
+    void deallocate(void *ptr) override;
+    void *reallocate(void *ptr, size_t newSize) override;
+
+    /** @brief Frees every block. Only while no document still uses the arena. */
+    void reset() { _used = _last = 0; }
+
+    /** @brief Most bytes ever in use (tune the buffer with it). */
+    size_t highWater() const { return _highWater; }
+
+private:
+    uint8_t *_buffer;
+    size_t _size;
+    size_t _used;      ///< Bytes carved so far.
+    size_t _last;      ///< Offset of the newest block's header.
+    size_t _highWater;
+};
+
+#endif // JSON_ARENA_H
@@ -0,0 +1,113 @@
+/**
+ * @file latency_stats.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the hot-path latency histograms.
+ * @date 2026-10-14
+ */
+
+#include "latency_stats.h"
+
+static const uint32_t bucketLimitUs[LATENCY_BUCKET_COUNT - 1] = {
+    1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000};
+
+static const char *const stageNames[LAT_STAGE_COUNT] = {
+    "pollToTag", "tidRead", "epcWrite", "queueWait", "bleNotify", "pollToNotify"};
+
+static LatencyHistogram histograms[LAT_STAGE_COUNT];
+static portMUX_TYPE histogramMux = portMUX_INITIALIZER_UNLOCKED;
+
+void latencyRecord(LatencyStage stage, int64_t startUs)
+{
+    int64_t elapsed = esp_timer_get_time() - startUs;
+    uint32_t us = (elapsed < 0) ? 0 : (elapsed > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)elapsed;
+
+    uint8_t bucket = 0;
+    while (bucket < LATENCY_BUCKET_COUNT - 1 && us >= bucketLimitUs[bucket])
+        bucket++;
+
+    portENTER_CRITICAL(&histogramMux);
+    LatencyHistogram &h = histograms[stage];
+    if (h.count == 0 || us < h.minUs)
+        h.minUs = us;
+    if (us > h.maxUs)
+        h.maxUs = us;
+    h.count++;
+    h.sumUs += us;
+    h.buckets[bucket]++;
+    portEXIT_CRITICAL(&histogramMux);
+}
+
+void latencyRecordMiss(LatencyStage stage)
+{
+    portENTER_CRITICAL(&histogramMux);
+    histograms[stage].misses++;
+    portEXIT_CRITICAL(&histogramMux);
+}
+
+void latencyReset()
+{
+    portENTER_CRITICAL(&histogramMux);
+    memset(histograms, 0, sizeof(histograms));
+    portEXIT_CRITICAL(&histogramMux);
+}
+
+LatencyHistogram latencySnapshot(LatencyStage stage)
+{
+    portENTER_CRITICAL(&histogramMux);
+    LatencyHistogram snapshot = histograms[stage];
+    portEXIT_CRITICAL(&histogramMux);
+    return snapshot;
+}
+
+uint32_t latencyPercentileUs(const LatencyHistogram &h, uint8_t percent)
+{
+    if (h.count == 0)
+        return 0;
+
+    // Posição da amostra (arredondada para cima), depois o bucket que a contém
+    uint32_t rank = ((uint64_t)h.count * percent + 99) / 100;
+    if (rank == 0)
+        rank = 1;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < LATENCY_BUCKET_COUNT - 1; i++)
+    {
+        seen += h.buckets[i];
+        if (seen >= rank)
+            return bucketLimitUs[i] < h.maxUs ? bucketLimitUs[i] : h.maxUs;
+    }
+    return h.maxUs;
+}
+
+const char *latencyStageName(LatencyStage stage)
+{
+    return stageNames[stage];
+}
+
+void latencyStageToJson(LatencyStage stage, JsonVariant out)
+{
+    LatencyHistogram h = latencySnapshot(stage);
+
+    out["stage"] = stageNames[stage];
+    out["count"] = h.count;
+    out["misses"] = h.misses;
+    out["avgUs"] = h.count ? (uint32_t)(h.sumUs / h.count) : 0;
+    out["minUs"] = h.minUs;
+    out["maxUs"] = h.maxUs;
+    JsonArray buckets = out["buckets"].to<JsonArray>();
+    for (uint8_t i = 0; i < LATENCY_BUCKET_COUNT; i++)
+        buckets.add(h.buckets[i]);
+}
+
+void latencyPrint(Print &out)
+{
+    out.println("stage         count  miss   avg_us   min_us   max_us | <1 <2 <5 <10 <20 <50 <100 <200 <500 <1000 >=1000 ms");
+    for (uint8_t s = 0; s < LAT_STAGE_COUNT; s++)
+    {
+        LatencyHistogram h = latencySnapshot((LatencyStage)s);
+        out.printf("%-12s %6u %5u %8u %8u %8u |", stageNames[s], (unsigned)h.count, (unsigned)h.misses,
+                   (unsigned)(h.count ? h.sumUs / h.count : 0), (unsigned)h.minUs, (unsigned)h.maxUs);
+        for (uint8_t i = 0; i < LATENCY_BUCKET_COUNT; i++)
+            out.printf(" %u", (unsigned)h.buckets[i]);
+        out.println();
+    }
+}
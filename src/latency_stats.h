@@ -0,0 +1,82 @@
+/**
+ * @file latency_stats.h
+ * @author Luis Felipe Patrocinio
+ * @brief Fixed-bucket latency histograms for the read/write/notify hot path.
+ * @date 2026-10-14
+ *
+ * @note Probes take an `esp_timer` timestamp (microseconds, shared by both cores)
+ *       at the start of a stage and call latencyRecord() when it ends. Recording
+ *       is a few adds under a spinlock, cheap enough to leave on in production.
+ *       Bucket upper bounds (ms): 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, +inf.
+ */
+
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_timer.h>
+
+/** @brief Number of histogram buckets (the last one is open-ended). */
+#define LATENCY_BUCKET_COUNT 11
+
+/** @brief Instrumented stages. */
+enum LatencyStage
+{
+    LAT_POLL_TO_TAG,    ///< singlePoll() sent until a valid EPC arrives (60/80 ms windows).
+    LAT_TID_READ,       ///< TID read: one getTID() (write) or a resolveTIDs() batch (read).
+    LAT_EPC_WRITE,      ///< One writeEPC() attempt (800 ms timeout).
+    LAT_QUEUE_WAIT,     ///< Message queued until the BLE task picks it up.
+    LAT_BLE_NOTIFY,     ///< setValue() + notify() on the characteristic.
+    LAT_POLL_TO_NOTIFY, ///< singlePoll() of the cycle until its result is notified.
+    LAT_STAGE_COUNT
+};
+
+/**
+ * @struct LatencyHistogram
+ * @brief Accumulated samples of one stage.
+ */
+struct LatencyHistogram
+{
+    uint32_t count;                          ///< Samples recorded.
+    uint32_t misses;                         ///< Stage gave up (window/timeout expired).
+    uint64_t sumUs;                          ///< Sum of samples, for the mean.
+    uint32_t minUs;                          ///< Fastest sample (0 if none).
+    uint32_t maxUs;                          ///< Slowest sample.
+    uint32_t buckets[LATENCY_BUCKET_COUNT];  ///< Sample count per bucket.
+};
+
+/** @brief Timestamp to pass to latencyRecord() later. */
+inline int64_t latencyNow()
+{
+    return esp_timer_get_time();
+}
+
+/** @brief Records the time elapsed since @p startUs for @p stage. */
+void latencyRecord(LatencyStage stage, int64_t startUs);
+
+/** @brief Counts a stage that ended without a result (e.g. no tag in the window). */
+void latencyRecordMiss(LatencyStage stage);
+
+/** @brief Clears all histograms. */
+void latencyReset();
+
+/** @brief Consistent copy of one histogram. */
+LatencyHistogram latencySnapshot(LatencyStage stage);
+
+/**
+ * @brief Estimates the @p percent percentile of @p h from its buckets.
+ * @return Upper bound of the bucket holding it, capped at maxUs (0 with no samples).
+ */
+uint32_t latencyPercentileUs(const LatencyHistogram &h, uint8_t percent);
+
+/** @brief Short name used in the JSON and serial reports. */
+const char *latencyStageName(LatencyStage stage);
+
+/** @brief Fills @p out with `stage`, `count`, `misses`, `avgUs`, `minUs`, `maxUs`, `buckets`. */
+void latencyStageToJson(LatencyStage stage, JsonVariant out);
+
+/** @brief Prints every histogram as a table. */
+void latencyPrint(Print &out);
+
+#endif // LATENCY_STATS_H
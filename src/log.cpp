@@ -0,0 +1,100 @@
+/**
+ * @file log.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the deferred serial log sink.
+ * @date 2026-10-14
+ */
+
+#include "log.h"
+#include <stdarg.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static_assert((LOG_RING_BYTES & (LOG_RING_BYTES - 1)) == 0, "LOG_RING_BYTES must be a power of two");
+
+// Free-running byte counters: writers (any task, either core) advance head under the
+// spinlock, only the log task advances tail
+static char ring[LOG_RING_BYTES];
+static uint32_t head = 0;
+static uint32_t tail = 0;
+static portMUX_TYPE ringMux = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t volatile logTaskHandle = NULL;
+static volatile uint32_t dropped = 0;
+
+void logWrite(const char *fmt, ...)
+{
+    char line[LOG_LINE_MAX];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line, sizeof(line) - 1, fmt, args);
+    va_end(args);
+    if (n < 0)
+        return;
+
+    // Long lines are cut, the newline always goes
+    size_t length = (size_t)n < sizeof(line) - 2 ? (size_t)n : sizeof(line) - 2;
+    line[length++] = '\n';
+
+    TaskHandle_t task = logTaskHandle;
+    if (task == NULL)
+    {
+        Serial.write((const uint8_t *)line, length);
+        return;
+    }
+
+    bool queued = false;
+    portENTER_CRITICAL(&ringMux);
+    if (LOG_RING_BYTES - (head - tail) >= length)
+    {
+        uint32_t start = head & (LOG_RING_BYTES - 1);
+        size_t first = LOG_RING_BYTES - start;
+        if (first > length)
+            first = length;
+        memcpy(ring + start, line, first);
+        memcpy(ring, line + first, length - first);
+        head += length;
+        queued = true;
+    }
+    else
+        dropped++;
+    portEXIT_CRITICAL(&ringMux);
+
+    if (queued)
+        xTaskNotifyGive(task);
+}
+
+uint32_t logDropped()
+{
+    return dropped;
+}
+
+void logTask(void *parameter)
+{
+    logTaskHandle = xTaskGetCurrentTaskHandle();
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        for (;;)
+        {
+            portENTER_CRITICAL(&ringMux);
+            uint32_t end = head;
+            portEXIT_CRITICAL(&ringMux);
+            if (end == tail)
+                break;
+
+            // Straight from the ring: writers never touch bytes before tail moves
+            uint32_t start = tail & (LOG_RING_BYTES - 1);
+            size_t length = end - tail;
+            if (length > LOG_RING_BYTES - start)
+                length = LOG_RING_BYTES - start;
+            Serial.write((const uint8_t *)ring + start, length);
+
+            portENTER_CRITICAL(&ringMux);
+            tail += length;
+            portEXIT_CRITICAL(&ringMux);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * @file log.h
+ * @author Luis Felipe Patrocinio
+ * @brief Leveled log macros with compile-time elimination and a deferred serial sink.
+ * @date 2026-10-14
+ *
+ * @note At 115200 baud a single line holds the calling task for milliseconds, which
+ *       is longer than a whole poll round. The macros format into a RAM ring and
+ *       return; logTask() drains the ring to the serial port at the lowest
+ *       application priority. A line that does not fit is dropped and counted,
+ *       never waited for.
+ *
+ *       LOG_LEVEL (config.h, or -DLOG_LEVEL=... in build_flags) picks the most
+ *       verbose level compiled in. Macros above it become dead code that the
+ *       compiler drops, arguments included (they are still type-checked, never
+ *       evaluated), so per-tag debug logging costs nothing in a production build.
+ *       Work done only to feed a log line goes under LOG_ENABLED() for the same
+ *       reason.
+ *
+ *       Until logTask() is running, lines go straight to the serial port, so
+ *       early boot and fatal messages are never lost. Not for use in ISRs.
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#include "config.h"
+
+/** @brief true if lines of @p level are compiled in (a constant: dead code is removed). */
+#define LOG_ENABLED(level) (LOG_LEVEL >= (level))
+
+// A level compiled out: no code, but the format and arguments still count as used
+#define LOG_DISCARD(fmt, ...) do { if (0) logWrite(fmt, ##__VA_ARGS__); } while (0)
+
+#if LOG_ENABLED(LOG_LEVEL_ERROR)
+#define LOG_E(fmt, ...) logWrite(fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(fmt, ...) LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_WARN)
+#define LOG_W(fmt, ...) logWrite(fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(fmt, ...) LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_INFO)
+#define LOG_I(fmt, ...) logWrite(fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(fmt, ...) LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_DEBUG)
+#define LOG_D(fmt, ...) logWrite(fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(fmt, ...) LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
+
+/**
+ * @brief Formats one line (printf style, newline added) into the ring. Never blocks.
+ *        Use the LOG_* macros rather than calling it directly.
+ */
+void logWrite(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/** @brief Lines dropped since boot because the ring was full. */
+uint32_t logDropped();
+
+/**
+ * @brief FreeRTOS task that writes the queued lines to the serial port. Lines
+ *        are deferred to it from the moment it starts.
+ * @param parameter Unused task parameter.
+ */
+void logTask(void *parameter);
+
+#endif // LOG_H
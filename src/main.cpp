@@ -24,9 +24,19 @@
 #include "config.h"
 #include "rtos_comm.h"
 #include "ble_comm.h"
+#include "log.h"
 #include "rfid_handler.h"
 #include "ui_handler.h"
+#include "trigger.h"
+#include "power_manager.h"
 #include "R200.h"
+#include "ble_batch.h"
+#include "message_pool.h"
+#include "latency_stats.h"
+#include "tag_store.h"
+#include "session_store.h"
+#include "reader_profile.h"
+#include "benchmark.h"
 
 //======================='=======================================================
 // GLOBAL OBJECTS & CONSTANTS (DEFINITIONS)
@@ -38,20 +48,48 @@ R200Driver rfid(Serial2);
 
 BLECharacteristic *pCharacteristic = nullptr;
 
+// Tag reads crossing from the radio core to the output core
+static TagReport tagRingSlots[TAG_RING_CAPACITY];
+TagRing tagRing(tagRingSlots, TAG_RING_CAPACITY);
+
 //==============================================================================
 // GLOBAL STATE VARIABLES (DEFINITIONS)
 //==============================================================================
 volatile bool bluetoothConnected = false;
 volatile bool writeMode = false;
+volatile bool inventoryMode = false;
+volatile bool binaryOutput = false;
 String dataToRecord = "";
+static TagDedupSlot bulkDoneTidSlots[BULK_DONE_TID_CAPACITY];
+BulkJob bulkJob(bulkDoneTidSlots, BULK_DONE_TID_CAPACITY);
 volatile bool soundEnabled = true;
+BootTimes bootTimes = {};
 
 //==============================================================================
 // FreeRTOS HANDLES (DEFINITIONS)
 //==============================================================================
 QueueHandle_t jsonDataQueue;
-SemaphoreHandle_t buzzerSemaphore;
+SemaphoreHandle_t tagReportDoorbell;
+QueueSetHandle_t bleQueueSet;
 SemaphoreHandle_t writeDataMutex;
+QueueHandle_t commandQueue;
+TaskHandle_t appTasks[APP_TASK_COUNT];
+
+// Arduino loop task: sleeps until the console receives something
+static TaskHandle_t loopTaskHandle = NULL;
+
+/**
+ * @brief Prints the unused stack of every application task (the 's' console dump).
+ */
+static void printTaskStacks()
+{
+    Serial.println("Task                 stackFree (bytes)");
+    for (uint8_t i = 0; i < APP_TASK_COUNT; i++)
+    {
+        if (appTasks[i] != NULL)
+            Serial.printf("%-20s %u\n", pcTaskGetName(appTasks[i]), (unsigned)uxTaskGetStackHighWaterMark(appTasks[i]));
+    }
+}
 
 //==============================================================================
 // SETUP FUNCTION
@@ -59,52 +97,76 @@ SemaphoreHandle_t writeDataMutex;
 void setup()
 {
     Serial.begin(115200);
+    loopTaskHandle = xTaskGetCurrentTaskHandle();
+    Serial.onReceive([]() { xTaskNotifyGive(loopTaskHandle); });
 
     // Initialize UID Generator
     randomSeed(analogRead(0));
 
-    Serial.println("System Initializing...");
+    LOG_I("System Initializing...");
 
     // --- Hardware and Peripheral Initialization ---
-    pinMode(BUZZER_PIN, OUTPUT);
     pinMode(LED_PIN, OUTPUT);
     pinMode(READ_BUTTON_PIN, INPUT_PULLUP);
+    if (!triggerBegin())
+        LOG_W("Trigger interrupt unavailable.");
 
-    Serial.println("Inicializando Módulo R200...");
+    // UART do R200 e sua task dona; o handshake e o perfil ficam com a task RFID
     rfid.begin();
-    rfid.getHardwareVersion(); // Health Check
+    // Perfil salvo na NVS (região, canal, potência, Q); só vai para o R200 o que difere
+    profileBegin();
 
-    // --- CONFIGURAÇÕES VITAIS DO MÓDULO ---
-    delay(200);
-    rfid.setRegionUS(); 
-    delay(100);
-    rfid.setTxPower(26); // Potência de 26 dBm (Ideal para escrita)
-    delay(100);
-    // --------------------------------------
+    // DFS e light sleep automático; o gatilho acorda o chip (ver power_manager.h)
+    powerBegin();
 
-    Serial.println("Peripherals initialized.");
+    LOG_I("Peripherals initialized.");
 
     // --- RTOS Primitives Initialization ---
-    jsonDataQueue = xQueueCreate(5, sizeof(char[256]));
-    buzzerSemaphore = xSemaphoreCreateBinary();
+    // One slot per pool buffer, so queuing a handle never fails
+    jsonDataQueue = xQueueCreate(MESSAGE_POOL_SIZE, sizeof(MessageHandle));
+    tagReportDoorbell = xSemaphoreCreateBinary();
+    bleQueueSet = xQueueCreateSet(MESSAGE_POOL_SIZE + 1);
     writeDataMutex = xSemaphoreCreateMutex();
-    if (!jsonDataQueue || !buzzerSemaphore || !writeDataMutex)
+    commandQueue = xQueueCreate(BLE_COMMAND_QUEUE_DEPTH, sizeof(BleCommand));
+    if (!messagePoolBegin() || !jsonDataQueue || !tagReportDoorbell || !bleQueueSet || !writeDataMutex ||
+        !commandQueue)
     {
-        Serial.println("Error creating RTOS primitives! Restarting...");
+        LOG_E("Error creating RTOS primitives! Restarting...");
         ESP.restart();
     }
-    Serial.println("RTOS primitives created.");
+    xQueueAddToSet(jsonDataQueue, bleQueueSet);
+    xQueueAddToSet(tagReportDoorbell, bleQueueSet);
+    LOG_I("RTOS primitives created.");
+
+    // --- Task Creation ---
+    // The log sink first: from here on no task waits on the serial port
+    xTaskCreatePinnedToCore(logTask, "Log_Task", LOG_TASK_STACK, NULL, LOG_TASK_PRIORITY, &appTasks[5], OUTPUT_CORE);
+    // Radio core: the R200 UART owner (created in rfid.begin()) and the RFID engine.
+    // The engine brings the R200 up now, in parallel with the flash and BLE below,
+    // and waits for RFID_EVENT_START before serving the trigger.
+    appTasks[0] = rfid.uartTask();
+    xTaskCreatePinnedToCore(rfidTask, "RFID_Task", RFID_TASK_STACK, NULL, RFID_TASK_PRIORITY, &appTasks[1], RADIO_CORE);
 
     // --- Module Initialization ---
+    // EPC -> TID conhecidos e log de gravações das sessões anteriores
+    if (!tagStoreBegin())
+        LOG_W("Tag store unavailable, running from RAM only.");
+    // Leituras das sessões de inventário, para o App buscar por cursor
+    if (!sessionStoreBegin())
+        LOG_W("Session store unavailable, reads are not kept.");
+
     setupBLE(); // Initializes and starts BLE services
+    bootTimes.bleMs = millis();
 
-    // --- Task Creation ---
-    xTaskCreatePinnedToCore(rfidTask, "RFID_Task", 4096, NULL, 2, NULL, 1);
-    xTaskCreatePinnedToCore(rfidWriteTask, "RFID_Write_Task", 4096, NULL, 2, NULL, 1);
-    xTaskCreatePinnedToCore(bluetoothTask, "Bluetooth_Task", 4096, NULL, 1, NULL, 1);
-    xTaskCreatePinnedToCore(buzzerTask, "Buzzer_Task", 1024, NULL, 1, NULL, 1);
-    xTaskCreatePinnedToCore(ledTask, "LED_Task", 2048, NULL, 1, NULL, 1);
-    Serial.println("FreeRTOS tasks created. System is running.");
+    // Output core: BLE encoding/notify, command handling and UI, next to the BT controller.
+    xTaskCreatePinnedToCore(bluetoothTask, "Bluetooth_Task", BLE_TASK_STACK, NULL, BLE_TASK_PRIORITY, &appTasks[2], OUTPUT_CORE);
+    xTaskCreatePinnedToCore(uiTask, "UI_Task", UI_TASK_STACK, NULL, UI_TASK_PRIORITY, &appTasks[3], OUTPUT_CORE);
+    xTaskCreatePinnedToCore(commandTask, "Command_Task", COMMAND_TASK_STACK, NULL, COMMAND_TASK_PRIORITY, &appTasks[4], OUTPUT_CORE);
+    LOG_I("FreeRTOS tasks created. System is running.");
+
+    // Straight to the handle: the bit waits there even if the engine has not run yet.
+    // Time-to-ready is logged by the engine once the R200 is up as well.
+    xTaskNotify(appTasks[1], RFID_EVENT_START, eSetBits);
 }
 
 //==============================================================================
@@ -112,6 +174,26 @@ void setup()
 //==============================================================================
 void loop()
 {
-    // FreeRTOS handles tasks; main loop remains empty.
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    // FreeRTOS handles tasks; the loop only serves the serial console ('s' stats
+    // dump, 'b' benchmark) and blocks until the UART receive callback wakes it,
+    // so it never wakes idle.
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while (Serial.available())
+    {
+        char key = Serial.read();
+        if (key == 's')
+        {
+            latencyPrint(Serial);
+            printTaskStacks();
+        }
+        else if (key == 'b')
+        {
+            // Same run as the BLE command without options; the report goes to the log
+            BenchConfig config = {BENCH_DEFAULT_SECONDS, true};
+            bool started = benchRequest(config);
+            if (started)
+                rfidNotify(RFID_EVENT_BENCH);
+            Serial.println(started ? "Benchmark started." : "Benchmark already running.");
+        }
+    }
 }
\ No newline at end of file
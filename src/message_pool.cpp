@@ -0,0 +1,111 @@
+/**
+ * @file message_pool.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the pooled JSON message buffers.
+ * @date 2026-10-14
+ */
+
+#include "message_pool.h"
+#include "config.h"
+#include "rtos_comm.h"
+#include "latency_stats.h"
+
+static char buffers[MESSAGE_POOL_SIZE][MESSAGE_BUFFER_SIZE];
+static int64_t queuedAt[MESSAGE_POOL_SIZE];
+static int64_t originAt[MESSAGE_POOL_SIZE];
+
+// Handles of the free buffers; a queue so RELIABLE producers can block on it
+static QueueHandle_t freeQueue = NULL;
+
+static MessagePoolStats stats = {};
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+bool messagePoolBegin()
+{
+    freeQueue = xQueueCreate(MESSAGE_POOL_SIZE, sizeof(MessageHandle));
+    if (!freeQueue)
+        return false;
+
+    for (MessageHandle i = 0; i < MESSAGE_POOL_SIZE; i++)
+        xQueueSend(freeQueue, &i, 0);
+    return true;
+}
+
+static bool acquire(MessagePriority priority, MessageHandle &handle)
+{
+    if (priority == MESSAGE_RELIABLE)
+        return xQueueReceive(freeQueue, &handle, pdMS_TO_TICKS(MESSAGE_RELIABLE_WAIT_MS)) == pdPASS;
+
+    // Best effort leaves the reserve for results the user is waiting on
+    if (uxQueueMessagesWaiting(freeQueue) <= MESSAGE_POOL_RESERVED)
+        return false;
+    return xQueueReceive(freeQueue, &handle, 0) == pdPASS;
+}
+
+bool sendJsonMessage(const JsonDocument &doc, MessagePriority priority, int64_t originUs)
+{
+    // A truncated document is useless to the app, so refuse it before taking a buffer
+    if (measureJson(doc) >= MESSAGE_BUFFER_SIZE)
+    {
+        portENTER_CRITICAL(&statsMux);
+        stats.droppedOversize++;
+        portEXIT_CRITICAL(&statsMux);
+        return false;
+    }
+
+    MessageHandle handle;
+    if (!acquire(priority, handle))
+    {
+        portENTER_CRITICAL(&statsMux);
+        stats.droppedFull++;
+        portEXIT_CRITICAL(&statsMux);
+        return false;
+    }
+
+    serializeJson(doc, buffers[handle], MESSAGE_BUFFER_SIZE);
+    originAt[handle] = originUs;
+    queuedAt[handle] = latencyNow();
+
+    portENTER_CRITICAL(&statsMux);
+    stats.sent++;
+    stats.inUse++;
+    if (stats.inUse > stats.highWater)
+        stats.highWater = stats.inUse;
+    portEXIT_CRITICAL(&statsMux);
+
+    // jsonDataQueue holds MESSAGE_POOL_SIZE handles, so this never blocks
+    xQueueSend(jsonDataQueue, &handle, 0);
+    return true;
+}
+
+const char *messageData(MessageHandle handle)
+{
+    return buffers[handle];
+}
+
+int64_t messageQueuedAt(MessageHandle handle)
+{
+    return queuedAt[handle];
+}
+
+int64_t messageOriginAt(MessageHandle handle)
+{
+    return originAt[handle];
+}
+
+void releaseMessage(MessageHandle handle)
+{
+    portENTER_CRITICAL(&statsMux);
+    stats.inUse--;
+    portEXIT_CRITICAL(&statsMux);
+
+    xQueueSend(freeQueue, &handle, 0);
+}
+
+MessagePoolStats messagePoolStats()
+{
+    portENTER_CRITICAL(&statsMux);
+    MessagePoolStats snapshot = stats;
+    portEXIT_CRITICAL(&statsMux);
+    return snapshot;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file message_pool.h
+ * @author Luis Felipe Patrocinio
+ * @brief Fixed pool of JSON message buffers passed to the BLE task by index.
+ * @date 2026-10-14
+ *
+ * @note Producers serialize straight into a pool buffer and queue only its
+ *       one-byte handle on `jsonDataQueue`; the BLE task notifies from the same
+ *       buffer and releases it. Nothing is copied through the queues.
+ *
+ *       Back-pressure policy:
+ *       - MESSAGE_BEST_EFFORT (inventory reads, link reports) never waits and may not
+ *         take the last MESSAGE_POOL_RESERVED buffers; when none is left it is dropped.
+ *       - MESSAGE_RELIABLE (read/write results) may use the reserve and waits up to
+ *         MESSAGE_RELIABLE_WAIT_MS for a buffer before being dropped.
+ *       Every drop is counted in MessagePoolStats.
+ */
+
+#ifndef MESSAGE_POOL_H
+#define MESSAGE_POOL_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+/** @brief Size of one message buffer, including the terminating NUL. */
+#define MESSAGE_BUFFER_SIZE 256
+
+/** @brief Index of a pool buffer; this is what travels on `jsonDataQueue`. */
+typedef uint8_t MessageHandle;
+
+/** @brief How hard a producer tries to get a buffer (see the file note). */
+enum MessagePriority
+{
+    MESSAGE_BEST_EFFORT,
+    MESSAGE_RELIABLE
+};
+
+/**
+ * @struct MessagePoolStats
+ * @brief Counters since boot.
+ */
+struct MessagePoolStats
+{
+    uint32_t sent;            ///< Messages queued for the BLE task.
+    uint32_t droppedFull;     ///< Dropped because no buffer was available in time.
+    uint32_t droppedOversize; ///< Dropped because the JSON did not fit a buffer.
+    uint8_t inUse;            ///< Buffers currently held by producers or the BLE task.
+    uint8_t highWater;        ///< Most buffers ever in use at once.
+};
+
+/**
+ * @brief Creates the free list. Call once before any task uses the pool.
+ * @return false if the RTOS queue could not be allocated.
+ */
+bool messagePoolBegin();
+
+/**
+ * @brief Serializes @p doc into a pool buffer and queues it on `jsonDataQueue`.
+ * @param originUs latencyNow() of the poll cycle that produced the message, or 0.
+ * @return true if queued, false if dropped (counted in the stats).
+ */
+bool sendJsonMessage(const JsonDocument &doc, MessagePriority priority, int64_t originUs = 0);
+
+/** @brief NUL-terminated JSON held by @p handle. */
+const char *messageData(MessageHandle handle);
+
+/** @brief latencyNow() when @p handle was queued. */
+int64_t messageQueuedAt(MessageHandle handle);
+
+/** @brief Origin timestamp given to sendJsonMessage() (0 if none). */
+int64_t messageOriginAt(MessageHandle handle);
+
+/** @brief Returns a buffer received from `jsonDataQueue` to the pool. */
+void releaseMessage(MessageHandle handle);
+
+/** @brief Snapshot of the pool counters. */
+MessagePoolStats messagePoolStats();
+
+#endif // MESSAGE_POOL_H
@@ -0,0 +1,98 @@
+/**
+ * @file power_control.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the nearest-tag transmit power controller.
+ * @date 2026-10-14
+ */
+
+#include "power_control.h"
+#include "config.h"
+
+PowerController::PowerController(uint8_t minDbm, uint8_t maxDbm, uint8_t startDbm, int8_t floorDbm)
+    : _minDbm(minDbm), _maxDbm(maxDbm), _powerDbm(startDbm), _floorDbm(floorDbm),
+      _accepted(0), _strongest(-128), _second(-128), _smoothed4(0), _haveSmoothed(false),
+      _emptyRounds(0), _adjustments(0)
+{
+}
+
+void PowerController::beginRound()
+{
+    _accepted = 0;
+    _strongest = -128;
+    _second = -128;
+}
+
+void PowerController::observe(int8_t rssi)
+{
+    if (rssi >= _floorDbm)
+        _accepted++;
+
+    if (rssi > _strongest)
+    {
+        _second = _strongest;
+        _strongest = rssi;
+    }
+    else if (rssi > _second)
+        _second = rssi;
+}
+
+void PowerController::setMaxPower(uint8_t maxDbm)
+{
+    _maxDbm = maxDbm < _minDbm ? _minDbm : maxDbm;
+    if (_powerDbm > _maxDbm)
+        step((int)_maxDbm - (int)_powerDbm);
+}
+
+int8_t PowerController::smoothedRssi() const
+{
+    return _haveSmoothed ? (int8_t)(_smoothed4 / 4) : _floorDbm;
+}
+
+bool PowerController::step(int delta)
+{
+    int next = (int)_powerDbm + delta;
+    if (next < _minDbm)
+        next = _minDbm;
+    if (next > _maxDbm)
+        next = _maxDbm;
+    if (next == _powerDbm)
+        return false;
+
+    _powerDbm = next;
+    _adjustments++;
+    // The RSSI scale moved with the power: smooth again from the next round
+    _haveSmoothed = false;
+    _emptyRounds = 0;
+    return true;
+}
+
+bool PowerController::endRound()
+{
+    if (_accepted == 0)
+    {
+        if (++_emptyRounds >= TX_POWER_EMPTY_ROUNDS)
+            return step(TX_POWER_STEP_DB);
+        return false;
+    }
+    _emptyRounds = 0;
+
+    // A neighbour that would also pass the filter this close to the strongest
+    // tag means the reader cannot tell which one is meant
+    if (_accepted > 1 && _strongest - _second < RSSI_NEAREST_MARGIN_DB)
+        return step(-TX_POWER_STEP_DB);
+
+    if (!_haveSmoothed)
+    {
+        _smoothed4 = _strongest * 4;
+        _haveSmoothed = true;
+    }
+    else
+        _smoothed4 += _strongest - _smoothed4 / 4;
+
+    int8_t level = smoothedRssi();
+    if (level > RSSI_TARGET_HIGH_DBM)
+        return step(-TX_POWER_STEP_DB);
+    if (level < RSSI_TARGET_LOW_DBM)
+        return step(TX_POWER_STEP_DB);
+    return false;
+}
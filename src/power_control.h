@@ -0,0 +1,86 @@
+/**
+ * @file power_control.h
+ * @author Luis Felipe Patrocinio
+ * @brief Transmit power controller that keeps only the nearest tag in reach.
+ * @date 2026-10-14
+ *
+ * @note Read and write modes want one tag answering, not every tag on the shelf.
+ *       The controller looks at the RSSI of each poll round and steps the power
+ *       down when a neighbour answers almost as loud as the strongest tag or when
+ *       the strongest one is louder than needed (less current per round), and
+ *       steps it up after a few empty rounds or when the strongest tag is weak.
+ *       Inventory keeps the fixed TX_POWER_INVENTORY_DBM instead.
+ *
+ *       The R200 reports RSSI as a signed dBm byte (0xC2 = -62 dBm).
+ */
+
+#ifndef POWER_CONTROL_H
+#define POWER_CONTROL_H
+
+#include <Arduino.h>
+
+/** @brief Signed dBm carried in the RSSI byte of an R200 tag notice. */
+inline int8_t rssiDbm(uint8_t raw) { return (int8_t)raw; }
+
+/**
+ * @class PowerController
+ * @brief Per-round RSSI statistics and the power they call for.
+ */
+class PowerController
+{
+public:
+    /**
+     * @param minDbm Lowest power the controller may pick.
+     * @param maxDbm Highest power the controller may pick.
+     * @param startDbm Power used until the first adjustment.
+     * @param floorDbm RSSI below which a tag is ignored (same as the caller's filter).
+     */
+    PowerController(uint8_t minDbm, uint8_t maxDbm, uint8_t startDbm, int8_t floorDbm);
+
+    /** @brief Starts collecting a new poll round. */
+    void beginRound();
+
+    /** @brief Feeds one tag of the round, including those below the floor. */
+    void observe(int8_t rssi);
+
+    /**
+     * @brief Closes the round and adjusts the power.
+     * @return true if power() changed.
+     */
+    bool endRound();
+
+    /** @brief true if a tag with @p rssi passes the RSSI filter. */
+    bool accepts(int8_t rssi) const { return rssi >= _floorDbm; }
+
+    /** @brief Power to use for the next round. */
+    uint8_t power() const { return _powerDbm; }
+
+    /** @brief Smoothed RSSI of the strongest tag (floor before the first one). */
+    int8_t smoothedRssi() const;
+
+    /** @brief Power changes since boot. */
+    uint32_t adjustments() const { return _adjustments; }
+
+    /** @brief Changes the ceiling (reader profile); a power above it comes down at once. */
+    void setMaxPower(uint8_t maxDbm);
+
+private:
+    uint8_t _minDbm;
+    uint8_t _maxDbm;
+    uint8_t _powerDbm;
+    int8_t _floorDbm;
+
+    // Round being collected
+    uint8_t _accepted;  ///< Tags at or above the floor.
+    int8_t _strongest;
+    int8_t _second;
+
+    int16_t _smoothed4;   ///< Strongest RSSI x4 (EWMA); restarted on every change.
+    bool _haveSmoothed;
+    uint8_t _emptyRounds;
+    uint32_t _adjustments;
+
+    bool step(int delta);
+};
+
+#endif // POWER_CONTROL_H
@@ -0,0 +1,142 @@
+/**
+ * @file power_manager.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of frequency scaling, light sleep and R200 power-state accounting.
+ * @date 2026-10-14
+ */
+
+#include "power_manager.h"
+#include "config.h"
+#include "log.h"
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include "freertos/FreeRTOS.h"
+
+static portMUX_TYPE powerMux = portMUX_INITIALIZER_UNLOCKED;
+static PowerStats stats = {};
+static PowerRadioState radioState = POWER_RADIO_IDLE;
+static uint32_t stateSince = 0;
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t awakeLock = NULL;
+#endif
+static bool awakeHeld = false;
+
+bool powerBegin()
+{
+    stats.cpuMinMhz = getCpuFrequencyMhz();
+    stateSince = millis();
+
+#if CONFIG_PM_ENABLE
+    esp_pm_config_esp32_t pm = {};
+    pm.max_freq_mhz = POWER_CPU_MAX_MHZ;
+    pm.min_freq_mhz = POWER_CPU_MIN_MHZ;
+    pm.light_sleep_enable = POWER_LIGHT_SLEEP;
+
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err != ESP_OK && pm.light_sleep_enable)
+    {
+        // Sem tickless idle no sdkconfig: fica só a troca de frequência
+        pm.light_sleep_enable = false;
+        err = esp_pm_configure(&pm);
+    }
+    if (err == ESP_OK)
+    {
+        stats.cpuMinMhz = POWER_CPU_MIN_MHZ;
+        stats.lightSleep = pm.light_sleep_enable;
+    }
+
+    esp_sleep_enable_gpio_wakeup();
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "r200", &awakeLock);
+#endif
+
+    LOG_I("[Power] CPU %u-%u MHz, light sleep %s.", (unsigned)stats.cpuMinMhz,
+          (unsigned)POWER_CPU_MAX_MHZ, stats.lightSleep ? "on" : "off");
+    return stats.lightSleep;
+}
+
+void powerStayAwake(bool awake)
+{
+    if (awake == awakeHeld)
+        return;
+    awakeHeld = awake;
+
+#if CONFIG_PM_ENABLE
+    if (!awakeLock)
+        return;
+    if (awake)
+        esp_pm_lock_acquire(awakeLock);
+    else
+        esp_pm_lock_release(awakeLock);
+#endif
+}
+
+void powerRadioState(PowerRadioState state)
+{
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&powerMux);
+    if (state != radioState)
+    {
+        stats.stateMs[radioState] += now - stateSince;
+        stateSince = now;
+        radioState = state;
+        if (state == POWER_RADIO_ASLEEP)
+            stats.r200Sleeps++;
+    }
+    portEXIT_CRITICAL(&powerMux);
+}
+
+void powerRecordWake(uint32_t ms)
+{
+    portENTER_CRITICAL(&powerMux);
+    stats.lastWakeMs = ms;
+    portEXIT_CRITICAL(&powerMux);
+}
+
+/** @brief Mean of POWER_SENSE_SAMPLES readings of the shunt amplifier, or -1 without one. */
+static float senseMa()
+{
+    if (POWER_SENSE_PIN < 0)
+        return -1;
+
+    uint32_t sum = 0;
+    for (int i = 0; i < POWER_SENSE_SAMPLES; i++)
+        sum += analogReadMilliVolts(POWER_SENSE_PIN);
+    return (float)sum / POWER_SENSE_SAMPLES * POWER_SENSE_MA_PER_MV;
+}
+
+PowerStats powerStats()
+{
+    static const float r200Ma[POWER_RADIO_STATES] = {
+        POWER_MODEL_R200_ACTIVE_MA, POWER_MODEL_R200_IDLE_MA, POWER_MODEL_R200_SLEEP_MA};
+
+    uint32_t now = millis();
+    PowerStats snapshot;
+
+    portENTER_CRITICAL(&powerMux);
+    snapshot = stats;
+    snapshot.stateMs[radioState] += now - stateSince;
+    portEXIT_CRITICAL(&powerMux);
+
+    uint32_t totalMs = 0;
+    float weighted = 0;
+    for (int s = 0; s < POWER_RADIO_STATES; s++)
+    {
+        totalMs += snapshot.stateMs[s];
+        weighted += r200Ma[s] * snapshot.stateMs[s];
+    }
+    snapshot.modelMa = POWER_MODEL_ESP32_MA + (totalMs > 0 ? weighted / totalMs : r200Ma[radioState]);
+    snapshot.measuredMa = senseMa();
+    return snapshot;
+}
+
+void powerReset()
+{
+    portENTER_CRITICAL(&powerMux);
+    for (int s = 0; s < POWER_RADIO_STATES; s++)
+        stats.stateMs[s] = 0;
+    stats.r200Sleeps = 0;
+    stateSince = millis();
+    portEXIT_CRITICAL(&powerMux);
+}
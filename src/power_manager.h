@@ -0,0 +1,73 @@
+/**
+ * @file power_manager.h
+ * @author Luis Felipe Patrocinio
+ * @brief CPU frequency scaling, automatic light sleep and R200 power-state accounting.
+ * @date 2026-10-14
+ *
+ * @note powerBegin() lets the IDF power manager drop the CPU to POWER_CPU_MIN_MHZ and
+ *       enter light sleep whenever every task is blocked; the trigger interrupt is
+ *       a wake source (see trigger.h). Light sleep needs tickless idle in the
+ *       sdkconfig, and while Bluedroid is up the controller only allows it with
+ *       modem sleep on a low-power clock; otherwise the chip just scales frequency.
+ *
+ *       The UART is not clocked in light sleep, so the RFID engine holds the chip
+ *       awake (powerStayAwake()) while it talks to the R200. It also reports the
+ *       R200 state, and the time spent in each one drives a per-state current
+ *       model. A shunt amplifier on POWER_SENSE_PIN adds a measured reading, so
+ *       configurations can be compared on the bench.
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+
+/** @brief R200 power states, as driven by the RFID engine. */
+enum PowerRadioState
+{
+    POWER_RADIO_ACTIVE, ///< Trigger pressed: polls, inventory or writes on the air.
+    POWER_RADIO_IDLE,   ///< Awake, RF off, waiting for the trigger.
+    POWER_RADIO_ASLEEP, ///< In R200 sleep (command 0x17).
+    POWER_RADIO_STATES
+};
+
+/**
+ * @struct PowerStats
+ * @brief Counters since boot or the last powerReset().
+ */
+struct PowerStats
+{
+    bool lightSleep;                      ///< Automatic light sleep was accepted by the IDF.
+    uint16_t cpuMinMhz;                   ///< Lowest CPU frequency configured.
+    uint32_t stateMs[POWER_RADIO_STATES]; ///< Time spent in each R200 state.
+    uint32_t r200Sleeps;                  ///< Times the R200 was put to sleep.
+    uint32_t lastWakeMs;                  ///< Duration of the last R200 wake.
+    float modelMa;                        ///< Average current of the window from the per-state model.
+    float measuredMa;                     ///< Current read on POWER_SENSE_PIN now (-1 = no sensor).
+};
+
+/**
+ * @brief Configures frequency scaling and light sleep. Call once from setup(),
+ *        after triggerBegin().
+ * @return true if light sleep is enabled (frequency scaling may still be on otherwise).
+ */
+bool powerBegin();
+
+/**
+ * @brief Keeps the chip out of light sleep while @p awake. Repeating the current value does nothing.
+ */
+void powerStayAwake(bool awake);
+
+/** @brief Records an R200 state change. Only the RFID engine calls this. */
+void powerRadioState(PowerRadioState state);
+
+/** @brief Records a completed R200 wake that took @p ms. */
+void powerRecordWake(uint32_t ms);
+
+/** @brief Snapshot of the counters, including the ongoing state. */
+PowerStats powerStats();
+
+/** @brief Starts a new measurement window. */
+void powerReset();
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,66 @@
+/**
+ * @file q_tuner.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the inventory Q tuner.
+ * @date 2026-10-14
+ */
+
+#include "q_tuner.h"
+
+QTuner::QTuner(uint8_t minQ, uint8_t maxQ, uint32_t windowMs, TagDedupSlot *seenSlots, uint16_t seenCapacity)
+    : _minQ(minQ), _maxQ(maxQ), _q(minQ), _windowMs(windowMs), _windowStart(0), _replies(0),
+      _seen(seenSlots, seenCapacity, 0), _lastRepliesPerSec(0), _lastPopulation(0)
+{
+}
+
+void QTuner::begin(uint8_t q, uint32_t nowMs)
+{
+    _q = q;
+    _windowStart = nowMs;
+    _replies = 0;
+    _seen.clear();
+}
+
+void QTuner::onReply(const uint8_t *epc, uint8_t epcLen, uint32_t nowMs)
+{
+    _replies++;
+    _seen.mark(epc, epcLen, nowMs);
+}
+
+bool QTuner::endWindow(uint32_t emptyRounds, uint32_t nowMs)
+{
+    uint32_t elapsed = nowMs - _windowStart;
+    uint16_t population = _seen.size();
+
+    _lastRepliesPerSec = elapsed > 0 ? _replies * 1000 / elapsed : 0;
+    _lastPopulation = population;
+    _windowStart = nowMs;
+    _replies = 0;
+    _seen.clear();
+
+    // Nobody answered: an empty field and a total collision look the same, keep Q
+    if (population == 0)
+        return false;
+
+    // Smallest Q whose frame holds the whole population
+    uint8_t target = 0;
+    while (target < 15 && (1u << target) < population)
+        target++;
+
+    // Empty cycles with several tags in the field: their replies collided
+    if (emptyRounds > 0 && population > 1 && target <= _q)
+        target = _q + 1;
+
+    if (target < _minQ)
+        target = _minQ;
+    if (target > _maxQ)
+        target = _maxQ;
+
+    if (target > _q)
+        _q++;
+    else if (target + 1 < _q)
+        _q--;
+    else
+        return false;
+    return true;
+}
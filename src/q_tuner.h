@@ -0,0 +1,78 @@
+/**
+ * @file q_tuner.h
+ * @author Luis Felipe Patrocinio
+ * @brief Picks the Gen2 Q value of the continuous inventory from the observed population.
+ * @date 2026-10-14
+ *
+ * @note Each inventory cycle offers 2^Q reply slots. With far more tags than slots
+ *       most slots collide and whole cycles come back empty (R200 error 0x15);
+ *       with far more slots than tags the cycles get long and mostly silent.
+ *       Framed slotted ALOHA reads the most tags per second with about one slot
+ *       per tag, so the tuner counts the distinct EPCs that replied in each
+ *       window and moves Q one step per window towards log2 of that count.
+ *       Empty cycles while several tags are known to be in the field are taken
+ *       as collisions and push Q up. Q only goes down once the population has
+ *       fallen to a quarter of the frame, so it does not flap between two values.
+ */
+
+#ifndef Q_TUNER_H
+#define Q_TUNER_H
+
+#include <Arduino.h>
+#include "tag_dedup.h"
+
+/**
+ * @class QTuner
+ * @brief Per-window reply statistics and the Q they call for.
+ */
+class QTuner
+{
+public:
+    /**
+     * @param minQ Lowest Q the tuner may pick.
+     * @param maxQ Highest Q the tuner may pick.
+     * @param windowMs Length of one measurement window.
+     * @param seenSlots Storage for the EPCs seen in a window (not owned).
+     * @param seenCapacity Number of slots (power of two, bounds the population estimate to 3/4 of it).
+     */
+    QTuner(uint8_t minQ, uint8_t maxQ, uint32_t windowMs, TagDedupSlot *seenSlots, uint16_t seenCapacity);
+
+    /** @brief Starts measuring from the module's current @p q. */
+    void begin(uint8_t q, uint32_t nowMs);
+
+    /** @brief Counts one tag notice of the inventory. */
+    void onReply(const uint8_t *epc, uint8_t epcLen, uint32_t nowMs);
+
+    /** @brief true once the current window has run for windowMs. */
+    bool windowDone(uint32_t nowMs) const { return nowMs - _windowStart >= _windowMs; }
+
+    /**
+     * @brief Closes the window and picks the next Q.
+     * @param emptyRounds Inventory cycles that ended without a tag during the window.
+     * @return true if q() changed.
+     */
+    bool endWindow(uint32_t emptyRounds, uint32_t nowMs);
+
+    /** @brief Q to use for the next window. */
+    uint8_t q() const { return _q; }
+
+    /** @brief Tag notices per second in the last closed window. */
+    uint32_t repliesPerSec() const { return _lastRepliesPerSec; }
+
+    /** @brief Distinct EPCs in the last closed window. */
+    uint16_t population() const { return _lastPopulation; }
+
+private:
+    uint8_t _minQ;
+    uint8_t _maxQ;
+    uint8_t _q;
+    uint32_t _windowMs;
+    uint32_t _windowStart;
+    uint32_t _replies;
+    TagDedup _seen;
+
+    uint32_t _lastRepliesPerSec;
+    uint16_t _lastPopulation;
+};
+
+#endif // Q_TUNER_H
@@ -0,0 +1,351 @@
+/**
+ * @file r200_protocol.cpp
+ * @version 1.0
+ * @date 2026-10-14
+ * @brief Implementação da camada de protocolo do R200 (sem dependência de FreeRTOS).
+ */
+
+#include "r200_protocol.h"
+#include "config.h"
+
+// Os dois dígitos de cada byte: uma leitura de tabela por byte, sem desvios
+static const char hexPairs[] =
+    "000102030405060708090A0B0C0D0E0F"
+    "101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F"
+    "303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F"
+    "505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F"
+    "707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F"
+    "909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAF"
+    "B0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF"
+    "D0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF"
+    "F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+// Valor de cada caractere ASCII como dígito hexadecimal (-1 = não é dígito)
+static const int8_t hexValues[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+size_t r200BytesToHex(const uint8_t *data, size_t length, char *out, size_t outSize)
+{
+    if (outSize == 0)
+        return 0;
+    if (length > (outSize - 1) / 2)
+        length = (outSize - 1) / 2;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        const char *pair = &hexPairs[2 * data[i]];
+        out[2 * i] = pair[0];
+        out[2 * i + 1] = pair[1];
+    }
+    out[2 * length] = '\0';
+    return 2 * length;
+}
+
+int r200HexValue(char c)
+{
+    return hexValues[(uint8_t)c];
+}
+
+size_t r200HexToBytes(const char *hex, uint8_t *out, size_t outSize)
+{
+    size_t n = 0;
+    while (n < outSize)
+    {
+        int high = hexValues[(uint8_t)hex[2 * n]];
+        if (high < 0)
+            break;
+        int low = hexValues[(uint8_t)hex[2 * n + 1]];
+        if (low < 0)
+            break;
+        out[n++] = (uint8_t)((high << 4) | low);
+    }
+    return n;
+}
+
+uint8_t r200Checksum(const uint8_t *data, size_t length)
+{
+    uint8_t sum = 0;
+    // Soma acumulativa de todos os bytes do payload (só o LSB interessa)
+    for (size_t i = 0; i < length; i++)
+        sum += data[i];
+    return sum;
+}
+
+size_t r200BuildFrame(uint8_t type, uint8_t cmd, const uint8_t *params, uint16_t paramLen, uint8_t *out)
+{
+    size_t idx = 0;
+
+    out[idx++] = FRAME_HEAD; // 0xAA
+    out[idx++] = type;       // Geralmente 0x00
+    out[idx++] = cmd;        // Código da instrução
+
+    // O comprimento do parâmetro (PL) é de 2 bytes (Big Endian: MSB primeiro)
+    out[idx++] = (paramLen >> 8) & 0xFF;
+    out[idx++] = paramLen & 0xFF;
+
+    // Copia os parâmetros opcionais para o pacote
+    if (params != NULL && paramLen > 0)
+    {
+        memcpy(&out[idx], params, paramLen);
+        idx += paramLen;
+    }
+
+    // O checksum vai do 'Type' (índice 1) ao último parâmetro, ignorando o Header
+    out[idx] = r200Checksum(&out[1], 4 + paramLen);
+    idx++;
+
+    out[idx++] = FRAME_END; // 0xDD
+    return idx;
+}
+
+void R200FrameDecoder::push(uint8_t b)
+{
+    // Fora de frame e não é Header: ruído, nem entra no buffer
+    if (_count == 0 && b != FRAME_HEAD)
+    {
+        _stats.discardedBytes++;
+        return;
+    }
+
+    // Não acontece com next() chamado a cada byte (um candidato nunca passa do
+    // maior frame), mas nunca sobrescreve dados: abre espaço pelo byte mais antigo
+    if (_count == R200_DECODER_RING_SIZE)
+    {
+        drop(1);
+        _stats.discardedBytes++;
+    }
+
+    _ring[(_head + _count) & (R200_DECODER_RING_SIZE - 1)] = b;
+    _count++;
+}
+
+bool R200FrameDecoder::next(R200Frame &frame, uint32_t now)
+{
+    while (_count > 0)
+    {
+        // 1. Sincronização: todo candidato começa em um Header
+        if (at(0) != FRAME_HEAD)
+        {
+            drop(1);
+            _stats.discardedBytes++;
+            continue;
+        }
+
+        // 2. O Payload Length (PL) fica nos bytes 3 (MSB) e 4 (LSB)
+        if (_count < 5)
+            return false;
+        uint16_t payloadLen = (at(3) << 8) | at(4);
+
+        // Pacote impossível: não era um Header de verdade, procura o próximo
+        if (payloadLen > R200_FRAME_MAX_PARAMS)
+        {
+            rejectCandidate(_stats.framingErrors);
+            continue;
+        }
+
+        // Header(1) + Type(1) + Cmd(1) + PL(2) + Payload + Checksum(1) + End(1)
+        uint16_t totalLen = payloadLen + 7;
+        if (_count < totalLen)
+            return false;
+
+        // 3. Validação: End na posição certa e checksum de Type até o último parâmetro
+        if (at(totalLen - 1) != FRAME_END)
+        {
+            rejectCandidate(_stats.framingErrors);
+            continue;
+        }
+
+        uint8_t sum = 0;
+        for (uint16_t i = 1; i < totalLen - 2; i++)
+            sum += at(i);
+        if (sum != at(totalLen - 2))
+        {
+            rejectCandidate(_stats.checksumErrors);
+            continue;
+        }
+
+        // 4. Frame válido: copia os parâmetros (podem dar a volta no buffer)
+        frame.type = at(1);
+        frame.cmd = at(2);
+        frame.paramLen = payloadLen;
+        frame.receivedAt = now;
+        for (uint16_t i = 0; i < payloadLen; i++)
+            frame.params[i] = at(5 + i);
+
+        drop(totalLen);
+        _stats.frames++;
+        return true;
+    }
+    return false;
+}
+
+size_t r200BuildSelectParams(const R200Tag &tag, uint8_t *out)
+{
+    // MaskLen 0 selecionaria todas as tags em vez de recusar
+    if (tag.epcLen == 0 || tag.epcLen > R200_SELECT_MAX_MASK_BYTES)
+        return 0;
+
+    size_t idx = 0;
+    out[idx++] = 0x01; // SelParam: Target S0 | Action 000 | MemBank EPC
+    out[idx++] = 0x00; // Ptr (4 bytes, endereço em bits): 0x00000020
+    out[idx++] = 0x00;
+    out[idx++] = 0x00;
+    out[idx++] = 0x20;
+    out[idx++] = tag.epcLen * 8; // MaskLen em bits
+    out[idx++] = 0x00;           // Truncate desligado
+    memcpy(&out[idx], tag.epc, tag.epcLen);
+    return idx + tag.epcLen;
+}
+
+size_t r200BuildTidSelectParams(const R200TID &tid, uint8_t *out)
+{
+    size_t idx = 0;
+    out[idx++] = 0x02; // SelParam: Target S0 | Action 000 | MemBank TID
+    out[idx++] = 0x00; // Ptr (4 bytes, endereço em bits): início do banco
+    out[idx++] = 0x00;
+    out[idx++] = 0x00;
+    out[idx++] = 0x00;
+    out[idx++] = tid.len * 8; // MaskLen em bits
+    out[idx++] = 0x00;        // Truncate desligado
+    memcpy(&out[idx], tid.bytes, tid.len);
+    return idx + tid.len;
+}
+
+size_t r200BuildWriteParams(uint32_t password, uint8_t memBank, uint16_t wordAddr,
+                            const uint8_t *data, uint8_t dataLen, uint8_t *out)
+{
+    uint16_t words = dataLen / 2;
+    size_t idx = 0;
+    out[idx++] = (password >> 24) & 0xFF;
+    out[idx++] = (password >> 16) & 0xFF;
+    out[idx++] = (password >> 8) & 0xFF;
+    out[idx++] = password & 0xFF;
+    out[idx++] = memBank;
+    out[idx++] = (wordAddr >> 8) & 0xFF;
+    out[idx++] = wordAddr & 0xFF;
+    out[idx++] = (words >> 8) & 0xFF;
+    out[idx++] = words & 0xFF;
+    memcpy(&out[idx], data, 2 * words);
+    return idx + 2 * words;
+}
+
+uint16_t r200PackQuery(const R200QueryParams &query)
+{
+    return ((query.dr & 0x01) << 15) |
+           ((query.m & 0x03) << 13) |
+           ((query.trext ? 1 : 0) << 12) |
+           ((query.sel & 0x03) << 10) |
+           ((query.session & 0x03) << 8) |
+           ((query.target & 0x01) << 7) |
+           ((query.q & 0x0F) << 3);
+}
+
+R200QueryParams r200UnpackQuery(uint16_t word)
+{
+    R200QueryParams query;
+    query.dr = (word >> 15) & 0x01;
+    query.m = (word >> 13) & 0x03;
+    query.trext = (word >> 12) & 0x01;
+    query.sel = (word >> 10) & 0x03;
+    query.session = (word >> 8) & 0x03;
+    query.target = (word >> 7) & 0x01;
+    query.q = (word >> 3) & 0x0F;
+    return query;
+}
+
+bool r200ParseTagNotice(const R200Frame &frame, R200Tag &tag)
+{
+    // Params: RSSI(1) + PC(2) + EPC(N) + CRC(2)
+    int epcLen = frame.paramLen - 5;
+
+    // --- Trava de Segurança ---
+    if (epcLen < 0 || epcLen > R200_MAX_EPC_BYTES)
+    {
+        tag.valid = false;
+        return false;
+    }
+
+    // Só cópias de bytes: nenhuma conversão para texto no caminho quente
+    tag.rssi = frame.params[0];
+    tag.pc = (frame.params[1] << 8) | frame.params[2];
+    memcpy(tag.epc, &frame.params[3], epcLen);
+    tag.epcLen = epcLen;
+    tag.antenna = 1;
+    tag.timestamp = frame.receivedAt;
+    tag.valid = true;
+    return true;
+}
+
+bool r200ParseTidResponse(const R200Frame &frame, R200TID &tid, const R200Tag *expectedTag)
+{
+    tid.len = 0;
+
+    // Resposta: UL(1) + PC(2) + EPC(UL - 2) + Dados lidos
+    int epcLen = frame.params[0];
+    int tidStart = 1 + epcLen;
+    int tidLen = frame.paramLen - 1 - epcLen;
+
+    if (frame.paramLen == 0 || epcLen < 2 || tidLen <= 0)
+        return false;
+    if (tidLen > R200_TID_BYTES)
+        tidLen = R200_TID_BYTES;
+
+    // O FILTRO DE MENTIRAS (Anti Cross-Talk)
+    // Impede que uma etiqueta vizinha "roube" a resposta: o EPC que o chip
+    // informou junto com o TID precisa ser o da tag esperada
+    if (expectedTag != NULL)
+    {
+        int epcBytes = epcLen - 2; // Subtrai o cabeçalho PC (2 bytes)
+        if (epcBytes != expectedTag->epcLen ||
+            memcmp(&frame.params[3], expectedTag->epc, epcBytes) != 0)
+        {
+            return false;
+        }
+    }
+
+    // Copia o TID (os 12 bytes completos!)
+    memcpy(tid.bytes, &frame.params[tidStart], tidLen);
+    tid.len = tidLen;
+    return true;
+}
+
+bool r200ParseAccessResponder(const R200Frame &frame, R200Tag &responder)
+{
+    responder.valid = false;
+    if (frame.paramLen == 0)
+        return false;
+
+    int epcBytes = frame.params[0] - 2; // UL inclui o PC
+    if (epcBytes < 0 || epcBytes > R200_MAX_EPC_BYTES || 1 + 2 + epcBytes > frame.paramLen)
+        return false;
+
+    responder.pc = (frame.params[1] << 8) | frame.params[2];
+    memcpy(responder.epc, &frame.params[3], epcBytes);
+    responder.epcLen = epcBytes;
+    responder.timestamp = frame.receivedAt;
+    responder.valid = true;
+    return true;
+}
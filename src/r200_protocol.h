@@ -0,0 +1,350 @@
+/**
+ * @file r200_protocol.h
+ * @version 1.0
+ * @date 2026-10-14
+ * @brief Camada de protocolo do R200: estruturas, remontagem e decodificação de frames.
+ *
+ * Tudo aqui é puro (sem FreeRTOS e sem acesso à UART), para que o mesmo código
+ * rode no firmware e no ambiente nativo de testes (`pio test -e native`).
+ *
+ * @see R200 user protocol V2.3.3.pdf
+ */
+
+#ifndef R200_PROTOCOL_H
+#define R200_PROTOCOL_H
+
+#include <Arduino.h>
+
+/** @brief Tamanho máximo dos parâmetros de um frame aceito pelo decodificador. */
+#define R200_FRAME_MAX_PARAMS 96
+
+/** @brief Tamanho máximo dos parâmetros de um comando enviado ao módulo. */
+#define R200_COMMAND_MAX_PARAMS 64
+
+/** @brief Maior EPC aceito (256 bits). Acima disso o frame é tratado como lixo. */
+#define R200_MAX_EPC_BYTES 32
+
+/** @brief Maior máscara do Select: o MaskLen é um byte em bits (32 bytes dariam 0 = todas as tags). */
+#define R200_SELECT_MAX_MASK_BYTES 31
+
+/** @brief Tamanho do TID lido pelo getTID() (6 Words). */
+#define R200_TID_BYTES 12
+
+/**
+ * @brief Converte bytes em texto hexadecimal maiúsculo terminado em '\0'.
+ *
+ * Destinado à borda de saída (JSON, logs): o caminho de decodificação trabalha
+ * somente com os bytes.
+ *
+ * @param data Bytes de origem.
+ * @param length Quantidade de bytes.
+ * @param out Buffer de destino (precisa de 2 * length + 1 bytes).
+ * @param outSize Tamanho do buffer de destino.
+ * @return Quantidade de caracteres escritos (sem o '\0').
+ */
+size_t r200BytesToHex(const uint8_t *data, size_t length, char *out, size_t outSize);
+
+/**
+ * @brief Converte texto hexadecimal (maiúsculo ou minúsculo) em bytes.
+ *
+ * Para no primeiro caractere que não for hexadecimal ou quando @p out encher;
+ * um dígito final sem par é ignorado.
+ *
+ * @return Quantidade de bytes escritos.
+ */
+size_t r200HexToBytes(const char *hex, uint8_t *out, size_t outSize);
+
+/** @brief Valor de @p c como dígito hexadecimal (0-15), ou -1 se não for um. */
+int r200HexValue(char c);
+
+/**
+ * @struct R200Tag
+ * @brief Registro binário de tamanho fixo de uma Tag RFID lida.
+ *
+ * Guarda os bytes brutos do frame de notificação, sem nenhuma alocação de
+ * heap. A conversão para texto só acontece na saída, com epcToHex().
+ */
+struct R200Tag
+{
+    /** @brief Código Eletrônico do Produto (EPC), bytes brutos. */
+    uint8_t epc[R200_MAX_EPC_BYTES];
+
+    /** @brief Quantidade de bytes válidos em epc. */
+    uint8_t epcLen;
+
+    /** @brief Palavra PC (Protocol Control) que precede o EPC. */
+    uint16_t pc;
+
+    /**
+     * @brief Indicador de Força do Sinal Recebido (RSSI).
+     * @note No R200, valores mais altos (em Hex) indicam sinal mais forte.
+     */
+    uint8_t rssi;
+
+    /** @brief Antena que recebeu a resposta (o R200 tem uma única antena: 1). */
+    uint8_t antenna;
+
+    /** @brief millis() no momento em que o frame terminou de chegar. */
+    uint32_t timestamp;
+
+    /** @brief Flag auxiliar para indicar se o objeto contém dados válidos. */
+    bool valid;
+
+    // --- CONSTRUTOR ---
+    // Assim que você declarar "R200Tag tag;", isso roda automaticamente.
+    R200Tag() : epcLen(0), pc(0), rssi(0), antenna(0), timestamp(0), valid(false) {}
+
+    /** @brief Compara o EPC byte a byte com outra leitura. */
+    bool sameEpc(const R200Tag &other) const
+    {
+        return epcLen == other.epcLen && memcmp(epc, other.epc, epcLen) == 0;
+    }
+
+    /** @brief Escreve o EPC em hexadecimal (out precisa de 2 * epcLen + 1 bytes). */
+    size_t epcToHex(char *out, size_t outSize) const
+    {
+        return r200BytesToHex(epc, epcLen, out, outSize);
+    }
+};
+
+/**
+ * @struct R200TID
+ * @brief TID (identificador de fábrica) de uma tag, em bytes brutos.
+ */
+struct R200TID
+{
+    uint8_t bytes[R200_TID_BYTES]; ///< Bytes do banco TID.
+    uint8_t len;                   ///< Quantidade de bytes válidos (0 = sem TID).
+
+    R200TID() : len(0) {}
+
+    /** @brief Compara o TID byte a byte. */
+    bool equals(const R200TID &other) const
+    {
+        return len == other.len && memcmp(bytes, other.bytes, len) == 0;
+    }
+
+    /** @brief Escreve o TID em hexadecimal (out precisa de 2 * len + 1 bytes). */
+    size_t toHex(char *out, size_t outSize) const
+    {
+        return r200BytesToHex(bytes, len, out, outSize);
+    }
+};
+
+/**
+ * @struct R200Frame
+ * @brief Frame completo recebido do módulo, já sem Header, Checksum e End.
+ *
+ * É o que a task dona da UART entrega aos consumidores pela fila de frames.
+ */
+struct R200Frame
+{
+    uint8_t type;                           ///< 0x01 = resposta, 0x02 = notificação.
+    uint8_t cmd;                            ///< Código do comando (0xFF = erro).
+    uint16_t paramLen;                      ///< Quantidade de bytes válidos em params.
+    uint32_t receivedAt;                    ///< millis() quando o End (0xDD) chegou.
+    uint8_t params[R200_FRAME_MAX_PARAMS];  ///< Parâmetros do frame.
+};
+
+/**
+ * @brief Calcula o Checksum do protocolo R200.
+ *
+ * O checksum é a soma de todos os bytes (Type até o último Parâmetro),
+ * pegando apenas o byte menos significativo (LSB).
+ *
+ * @param data Ponteiro para o array de bytes.
+ * @param length Quantidade de bytes a somar.
+ * @return uint8_t O byte de checksum calculado.
+ */
+uint8_t r200Checksum(const uint8_t *data, size_t length);
+
+/**
+ * @brief Monta um frame completo: Header, Type, Cmd, PL, Params, Checksum e End.
+ *
+ * @param type Tipo do frame (0x00 para comandos).
+ * @param cmd Código do comando (ex: 0x22 para Poll).
+ * @param params Parâmetros (ou NULL).
+ * @param paramLen Tamanho dos parâmetros.
+ * @param out Destino (precisa de paramLen + 7 bytes).
+ * @return Quantidade de bytes escritos em out.
+ */
+size_t r200BuildFrame(uint8_t type, uint8_t cmd, const uint8_t *params, uint16_t paramLen, uint8_t *out);
+
+/**
+ * @brief Monta os parâmetros do Select (0x0C) que casa exatamente o EPC da tag.
+ *
+ * SelParam 0x01 (Target S0, Action 0, banco EPC), Ptr = bit 0x20 (logo após
+ * CRC e PC), MaskLen = EPC inteiro em bits, sem Truncate.
+ *
+ * @param tag Tag cujo EPC vira a máscara.
+ * @param out Destino (precisa de 7 + tag.epcLen bytes).
+ * @return Quantidade de bytes escritos em out; 0 se o EPC for vazio ou maior que
+ *         R200_SELECT_MAX_MASK_BYTES (não há Select que case só essa tag).
+ */
+size_t r200BuildSelectParams(const R200Tag &tag, uint8_t *out);
+
+/**
+ * @brief Monta os parâmetros do Select (0x0C) que casa exatamente o TID do chip.
+ *
+ * SelParam 0x02 (Target S0, Action 0, banco TID), Ptr = bit 0, MaskLen = TID
+ * inteiro em bits, sem Truncate. Ao contrário do EPC, o TID é único por chip.
+ *
+ * @param tid TID que vira a máscara.
+ * @param out Destino (precisa de 7 + tid.len bytes).
+ * @return Quantidade de bytes escritos em out.
+ */
+size_t r200BuildTidSelectParams(const R200TID &tid, uint8_t *out);
+
+/**
+ * @brief Monta os parâmetros da Escrita (0x49).
+ *
+ * Estrutura: Senha(4) + Banco(1) + Endereço em Words(2) + Words(2) + Dados(N).
+ *
+ * @param password Senha de acesso (0 = padrão de fábrica).
+ * @param memBank Banco de memória (0x01 = EPC).
+ * @param wordAddr Primeira Word gravada (2 no banco EPC, logo após CRC e PC).
+ * @param data Dados gravados (quantidade par de bytes).
+ * @param dataLen Tamanho dos dados em bytes.
+ * @param out Destino (precisa de 9 + dataLen bytes).
+ * @return Quantidade de bytes escritos em out.
+ */
+size_t r200BuildWriteParams(uint32_t password, uint8_t memBank, uint16_t wordAddr,
+                            const uint8_t *data, uint8_t dataLen, uint8_t *out);
+
+/**
+ * @struct R200QueryParams
+ * @brief Parâmetros do Query do Gen2 lidos/gravados pelos comandos 0x0D/0x0E.
+ *
+ * Na linha viram uma palavra de 16 bits (big-endian):
+ * DR(1) | M(2) | TRext(1) | Sel(2) | Session(2) | Target(1) | Q(4) | 000.
+ */
+struct R200QueryParams
+{
+    uint8_t dr;      ///< Divide Ratio (0 = 8, 1 = 64/3).
+    uint8_t m;       ///< Codificação da resposta (0 = FM0, 1 = Miller 2, 2 = Miller 4, 3 = Miller 8).
+    bool trext;      ///< Preâmbulo com pilot tone.
+    uint8_t sel;     ///< Tags que respondem (0 e 1 = todas, 2 = ~SL, 3 = SL).
+    uint8_t session; ///< Sessão S0-S3.
+    uint8_t target;  ///< Flag de inventário procurada (0 = A, 1 = B).
+    uint8_t q;       ///< Q: 2^Q slots por ciclo de inventário (0-15).
+};
+
+/** @brief Monta a palavra de 16 bits do Query. */
+uint16_t r200PackQuery(const R200QueryParams &query);
+
+/** @brief Separa a palavra de 16 bits do Query em campos. */
+R200QueryParams r200UnpackQuery(uint16_t word);
+
+/** @brief Capacidade do buffer circular do decodificador (potência de 2 >= maior frame). */
+#define R200_DECODER_RING_SIZE 128
+
+/**
+ * @struct R200DecoderStats
+ * @brief Contadores de erros de linha desde o boot.
+ */
+struct R200DecoderStats
+{
+    uint32_t frames;         ///< Frames válidos entregues.
+    uint32_t checksumErrors; ///< Candidatos com checksum errado.
+    uint32_t framingErrors;  ///< Candidatos com PL impossível ou sem o 0xDD na posição.
+    uint32_t discardedBytes; ///< Bytes fora de qualquer frame (ruído e restos de frames ruins).
+};
+
+/**
+ * @class R200FrameDecoder
+ * @brief Remonta frames a partir dos bytes da UART sobre um buffer circular.
+ *
+ * O fim do frame é determinado pelo PL do cabeçalho, nunca pela busca do 0xDD
+ * (esse valor aparece livremente dentro de EPCs). Um candidato só é aceito com
+ * o 0xDD na posição esperada e o checksum correto; se falhar, apenas o 0xAA
+ * inicial é descartado e a busca recomeça no próximo 0xAA já recebido, de modo
+ * que um frame válido que chegou logo depois de um frame cortado não se perde.
+ */
+class R200FrameDecoder
+{
+public:
+    R200FrameDecoder() : _head(0), _count(0), _stats() {}
+
+    /**
+     * @brief Acrescenta um byte recebido da UART.
+     *
+     * Depois de cada push(), chame next() até retornar false: uma ressincronização
+     * pode liberar mais de um frame de uma vez.
+     */
+    void push(uint8_t b);
+
+    /**
+     * @brief Extrai o próximo frame completo e válido do buffer.
+     *
+     * @param frame Destino do frame.
+     * @param now millis() para o carimbo receivedAt.
+     * @return true Se um frame foi escrito em frame.
+     */
+    bool next(R200Frame &frame, uint32_t now);
+
+    /** @brief Descarta os bytes pendentes. */
+    void reset() { _head = _count = 0; }
+
+    /** @brief Contadores de erros de linha. */
+    const R200DecoderStats &stats() const { return _stats; }
+
+private:
+    uint8_t _ring[R200_DECODER_RING_SIZE]; ///< Bytes recebidos ainda não consumidos.
+    uint16_t _head;                        ///< Índice do byte mais antigo.
+    uint16_t _count;                       ///< Bytes pendentes no buffer.
+    R200DecoderStats _stats;               ///< Contadores de erros de linha.
+
+    /** @brief Byte na posição @p i a partir do mais antigo. */
+    uint8_t at(uint16_t i) const { return _ring[(_head + i) & (R200_DECODER_RING_SIZE - 1)]; }
+
+    /**
+     * @brief Descarta só o 0xAA do candidato atual; next() segue para o próximo 0xAA.
+     * @param counter Contador do motivo da rejeição.
+     */
+    void rejectCandidate(uint32_t &counter)
+    {
+        counter++;
+        drop(1);
+        _stats.discardedBytes++;
+    }
+
+    /** @brief Consome os @p n bytes mais antigos. */
+    void drop(uint16_t n)
+    {
+        _head = (_head + n) & (R200_DECODER_RING_SIZE - 1);
+        _count -= n;
+    }
+};
+
+/**
+ * @brief Decodifica um frame de notificação 0x22 e preenche a estrutura R200Tag.
+ *
+ * @param frame Frame completo recebido da UART.
+ * @param tag Referência para a estrutura onde os dados serão salvos.
+ * @return true Se o frame trouxe um EPC válido (tag.valid).
+ */
+bool r200ParseTagNotice(const R200Frame &frame, R200Tag &tag);
+
+/**
+ * @brief Extrai o TID da resposta de um comando 0x39 (banco TID).
+ *
+ * Resposta: UL(1) + PC(2) + EPC(UL - 2) + Dados lidos.
+ *
+ * @param frame Resposta do módulo.
+ * @param tid Destino dos bytes do TID (len = 0 se a resposta for rejeitada).
+ * @param expectedTag Se informado, o EPC que veio junto com o TID precisa ser o
+ * desta tag (Anti Cross-Talk).
+ * @return true Se o TID foi extraído.
+ */
+bool r200ParseTidResponse(const R200Frame &frame, R200TID &tid, const R200Tag *expectedTag = NULL);
+
+/**
+ * @brief Extrai o EPC da tag que respondeu a um comando de acesso (0x39/0x49).
+ *
+ * As duas respostas começam com UL(1) + PC(2) + EPC(UL - 2).
+ *
+ * @return true Se o EPC coube em R200Tag.
+ */
+bool r200ParseAccessResponder(const R200Frame &frame, R200Tag &responder);
+
+#endif // R200_PROTOCOL_H
@@ -0,0 +1,193 @@
+/**
+ * @file reader_profile.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the reader profile presets and their NVS storage.
+ * @date 2026-10-14
+ */
+
+#include "reader_profile.h"
+#include "config.h"
+#include "log.h"
+#include "R200.h"
+#include <Preferences.h>
+#include "freertos/FreeRTOS.h"
+
+static const char *NVS_NAMESPACE = "reader";
+static const char *NVS_KEY = "profile";
+static const uint8_t STORED_VERSION = 1; // Mude ao alterar o layout de ReaderProfile
+
+/**
+ * @struct StoredProfile
+ * @brief NVS blob: a layout from another firmware version is ignored, not misread.
+ */
+struct StoredProfile
+{
+    uint8_t version;
+    ReaderProfile profile;
+};
+
+// "balanced" reproduz os valores de config.h de antes dos perfis
+static const ReaderProfile presets[] = {
+    {"balanced", R200_REGION_US, R200_CHANNEL_HOPPING, TX_POWER_MAX_DBM, TX_POWER_INVENTORY_DBM,
+     R200_MULTI_POLL_ROUNDS, 4, true, 60, 80, 150, 800, TAG_DEDUP_WINDOW_MS, R200_SLEEP_IDLE_MS},
+    // Prateleira cheia: Q alto de partida, rodadas curtas e menos repetições
+    {"fastInventory", R200_REGION_US, R200_CHANNEL_HOPPING, TX_POWER_MAX_DBM, TX_POWER_INVENTORY_DBM,
+     R200_MULTI_POLL_ROUNDS, 6, true, 40, 80, 100, 800, 10000, R200_SLEEP_IDLE_MS},
+    // Bancada de gravação: potência baixa, janelas pacientes
+    {"preciseWrite", R200_REGION_US, R200_CHANNEL_HOPPING, 20, TX_POWER_INVENTORY_DBM,
+     R200_MULTI_POLL_ROUNDS, 4, true, 80, 150, 200, 1000, TAG_DEDUP_WINDOW_MS, R200_SLEEP_IDLE_MS},
+    // Bateria: menos potência e o R200 dorme logo
+    {"lowPower", R200_REGION_US, R200_CHANNEL_HOPPING, 20, 20,
+     R200_MULTI_POLL_ROUNDS, 4, true, 60, 80, 150, 800, TAG_DEDUP_WINDOW_MS, 5000},
+};
+
+static portMUX_TYPE profileMux = portMUX_INITIALIZER_UNLOCKED;
+static ReaderProfile current = presets[0];
+
+static bool validProfile(const ReaderProfile &p)
+{
+    if (strnlen(p.name, sizeof(p.name)) == sizeof(p.name))
+        return false;
+    if (p.region == 0 || (p.channel != R200_CHANNEL_HOPPING && p.channel >= 64))
+        return false;
+    if (p.txPowerDbm < TX_POWER_MIN_DBM || p.txPowerDbm > 30 || p.inventoryDbm < TX_POWER_MIN_DBM || p.inventoryDbm > 30)
+        return false;
+    if (p.pollRounds == 0 || p.q > 15)
+        return false;
+    if (p.readWindowMs < 10 || p.readWindowMs > 1000 || p.writeWindowMs < 10 || p.writeWindowMs > 1000)
+        return false;
+    if (p.tidTimeoutMs < 20 || p.tidTimeoutMs > 1000 || p.writeTimeoutMs < 50 || p.writeTimeoutMs > 2000)
+        return false;
+    return p.dedupWindowMs <= 600000 && (p.sleepIdleMs == 0 || p.sleepIdleMs >= 1000);
+}
+
+bool profileBegin()
+{
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true))
+    {
+        LOG_I("[Profile] Sem perfil salvo, usando \"%s\".", current.name);
+        return false;
+    }
+
+    StoredProfile stored;
+    bool found = prefs.getBytesLength(NVS_KEY) == sizeof(stored) &&
+                 prefs.getBytes(NVS_KEY, &stored, sizeof(stored)) == sizeof(stored) &&
+                 stored.version == STORED_VERSION && validProfile(stored.profile);
+    prefs.end();
+
+    if (found)
+    {
+        portENTER_CRITICAL(&profileMux);
+        current = stored.profile;
+        portEXIT_CRITICAL(&profileMux);
+    }
+    LOG_I("[Profile] Perfil \"%s\"%s.", found ? stored.profile.name : current.name, found ? "" : " (padrao)");
+    return found;
+}
+
+ReaderProfile profileCurrent()
+{
+    portENTER_CRITICAL(&profileMux);
+    ReaderProfile snapshot = current;
+    portEXIT_CRITICAL(&profileMux);
+    return snapshot;
+}
+
+bool profileSet(const ReaderProfile &profile)
+{
+    if (!validProfile(profile))
+        return false;
+
+    portENTER_CRITICAL(&profileMux);
+    current = profile;
+    portEXIT_CRITICAL(&profileMux);
+
+    // Sem NVS o perfil vale até o próximo boot
+    StoredProfile stored;
+    memset(&stored, 0, sizeof(stored));
+    stored.version = STORED_VERSION;
+    stored.profile = profile;
+
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false) || prefs.putBytes(NVS_KEY, &stored, sizeof(stored)) != sizeof(stored))
+        LOG_E("[Profile] Falha ao salvar o perfil.");
+    prefs.end();
+    return true;
+}
+
+bool profilePreset(const char *name, ReaderProfile &out)
+{
+    if (!name)
+        return false;
+    for (size_t i = 0; i < sizeof(presets) / sizeof(presets[0]); i++)
+    {
+        if (strcmp(presets[i].name, name) == 0)
+        {
+            out = presets[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+static bool overrideField(JsonVariantConst fields, const char *key, T &field)
+{
+    JsonVariantConst value = fields[key];
+    if (!value.is<T>() || value.as<T>() == field)
+        return false;
+    field = value.as<T>();
+    return true;
+}
+
+void profileFromJson(JsonVariantConst fields, ReaderProfile &profile)
+{
+    bool changed = false;
+    changed |= overrideField(fields, "region", profile.region);
+    changed |= overrideField(fields, "txPowerDbm", profile.txPowerDbm);
+    changed |= overrideField(fields, "inventoryDbm", profile.inventoryDbm);
+    changed |= overrideField(fields, "pollRounds", profile.pollRounds);
+    changed |= overrideField(fields, "q", profile.q);
+    changed |= overrideField(fields, "qAuto", profile.qAuto);
+    changed |= overrideField(fields, "readWindowMs", profile.readWindowMs);
+    changed |= overrideField(fields, "writeWindowMs", profile.writeWindowMs);
+    changed |= overrideField(fields, "tidTimeoutMs", profile.tidTimeoutMs);
+    changed |= overrideField(fields, "writeTimeoutMs", profile.writeTimeoutMs);
+    changed |= overrideField(fields, "dedupWindowMs", profile.dedupWindowMs);
+    changed |= overrideField(fields, "sleepIdleMs", profile.sleepIdleMs);
+
+    // Canal: índice fixo ou "hopping"
+    const char *channel = fields["channel"];
+    if (channel && strcmp(channel, "hopping") == 0)
+    {
+        changed |= profile.channel != R200_CHANNEL_HOPPING;
+        profile.channel = R200_CHANNEL_HOPPING;
+    }
+    else
+        changed |= overrideField(fields, "channel", profile.channel);
+
+    if (changed)
+        strlcpy(profile.name, "custom", sizeof(profile.name));
+}
+
+void profileToJson(const ReaderProfile &profile, JsonVariant out)
+{
+    out["name"] = profile.name;
+    out["region"] = profile.region;
+    if (profile.channel == R200_CHANNEL_HOPPING)
+        out["channel"] = "hopping";
+    else
+        out["channel"] = profile.channel;
+    out["txPowerDbm"] = profile.txPowerDbm;
+    out["inventoryDbm"] = profile.inventoryDbm;
+    out["pollRounds"] = profile.pollRounds;
+    out["q"] = profile.q;
+    out["qAuto"] = profile.qAuto;
+    out["readWindowMs"] = profile.readWindowMs;
+    out["writeWindowMs"] = profile.writeWindowMs;
+    out["tidTimeoutMs"] = profile.tidTimeoutMs;
+    out["writeTimeoutMs"] = profile.writeTimeoutMs;
+    out["dedupWindowMs"] = profile.dedupWindowMs;
+    out["sleepIdleMs"] = profile.sleepIdleMs;
+}
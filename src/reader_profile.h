@@ -0,0 +1,81 @@
+/**
+ * @file reader_profile.h
+ * @author Luis Felipe Patrocinio
+ * @brief Reader profile (region, power, inventory and timing windows) kept in NVS.
+ * @date 2026-10-14
+ *
+ * @note Throughput is tuned per site: a warehouse dock wants wide inventory, an
+ *       encoding bench wants low power and patient writes. The profile gathers
+ *       the radio settings and the windows that used to be literals in the RFID
+ *       engine, so the app can switch them without reflashing. Presets cover the
+ *       usual cases; a custom profile starts from the current one and overrides
+ *       single fields.
+ *
+ *       The profile is stored in NVS and loaded on boot. The RFID engine owns
+ *       the radio and applies a new profile on RFID_EVENT_PROFILE; on boot it
+ *       reads the module's settings first and only writes the ones that differ.
+ */
+
+#ifndef READER_PROFILE_H
+#define READER_PROFILE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/** @brief Longest preset name, including the terminator. */
+#define READER_PROFILE_NAME_BYTES 16
+
+/**
+ * @struct ReaderProfile
+ * @brief Radio settings and engine windows. Stored in NVS as is.
+ */
+struct ReaderProfile
+{
+    char name[READER_PROFILE_NAME_BYTES]; ///< Preset it came from, or "custom".
+    uint8_t region;          ///< R200 region code (0x07), e.g. R200_REGION_US.
+    uint8_t channel;         ///< Fixed channel index, or R200_CHANNEL_HOPPING.
+    uint8_t txPowerDbm;      ///< Ceiling of the read/write power control (dBm).
+    uint8_t inventoryDbm;    ///< Continuous inventory power (dBm).
+    uint16_t pollRounds;     ///< Cycles per multi-poll command (0x27).
+    uint8_t q;               ///< Inventory Q (starting point when qAuto is set).
+    bool qAuto;              ///< Let the Q tuner move Q with the population (see q_tuner.h).
+    uint16_t readWindowMs;   ///< Read mode: wait for the first tag of a round.
+    uint16_t writeWindowMs;  ///< Single write: collection window of the target round.
+    uint16_t tidTimeoutMs;   ///< TID read (0x39) response window.
+    uint16_t writeTimeoutMs; ///< Single write (0x49) response window.
+    uint32_t dedupWindowMs;  ///< A tag out of the field this long is reported again.
+    uint32_t sleepIdleMs;    ///< Trigger idle this long puts the R200 to sleep (0 = never).
+};
+
+/**
+ * @brief Loads the stored profile (or the "balanced" preset). Call once from setup().
+ * @return true if a stored profile was found.
+ */
+bool profileBegin();
+
+/** @brief Snapshot of the current profile. Safe from any task. */
+ReaderProfile profileCurrent();
+
+/**
+ * @brief Validates @p profile, makes it current and stores it in NVS.
+ * @return false if a field is out of range (nothing changes).
+ */
+bool profileSet(const ReaderProfile &profile);
+
+/**
+ * @brief Copies the preset called @p name ("balanced", "fastInventory",
+ *        "preciseWrite", "lowPower") into @p out.
+ * @return false if there is no such preset.
+ */
+bool profilePreset(const char *name, ReaderProfile &out);
+
+/**
+ * @brief Overrides the fields present in @p fields on @p profile (names as in
+ *        profileToJson()); the result is named "custom" if anything changed.
+ */
+void profileFromJson(JsonVariantConst fields, ReaderProfile &profile);
+
+/** @brief Writes every field of @p profile into @p out. */
+void profileToJson(const ReaderProfile &profile, JsonVariant out);
+
+#endif // READER_PROFILE_H
@@ -1,332 +1,1141 @@
 #include "config.h"
 #include "rfid_handler.h"
 #include "rtos_comm.h"
+#include "tag_dedup.h"
+#include "tag_ring.h"
+#include "ble_batch.h"
+#include "message_pool.h"
+#include "latency_stats.h"
+#include "text_codec.h"
+#include "tid_cache.h"
+#include "tag_store.h"
+#include "adaptive_timeout.h"
+#include "power_control.h"
+#include "write_target.h"
+#include "q_tuner.h"
+#include "trigger.h"
+#include "power_manager.h"
+#include "log.h"
+#include "reader_profile.h"
+#include "tag_output.h"
+#include "ui_handler.h"
+#include "benchmark.h"
 #include <ArduinoJson.h>
-#include <ctype.h>
 
 //==============================================================================
-// HELPER FUNCTIONS
+// TAG REPORTS (anel SPSC até a task BLE, no outro núcleo)
 //==============================================================================
 
-String textToHex(String text)
+// A task BLE filtra repetições e monta o JSON/lote (ver tag_output.h); aqui só
+// se copia o registro bruto, sem bloquear. Esta task é a única produtora do anel.
+static bool sessionReported = false;
+
+static void publishTag(const TagReport &report)
 {
-    String hexString = "";
-    for (unsigned int i = 0; i < text.length(); i++)
+    if (tagRing.push(report))
     {
-        char c = text.charAt(i);
-        if (c < 16)
-            hexString += "0";
-        hexString += String(c, HEX);
+        xSemaphoreGive(tagReportDoorbell);
+        sessionReported = true;
     }
-    hexString.toUpperCase();
+}
 
-    // Preenche com ZEROS (Limpeza) até atingir 24 caracteres (96 bits)
-    while (hexString.length() < 24)
+/**
+ * @brief Trigger released: tells the output side to forget the reported tags.
+ *
+ * Goes through the ring so reads queued before the release are still filtered
+ * against this session. Retried on the next loop if the ring is full.
+ */
+static void endReportSession()
+{
+    if (!sessionReported)
+        return;
+
+    TagReport marker;
+    marker.tid.len = 0;
+    marker.flags = 0;
+    marker.endOfSession = true;
+    marker.originUs = 0;
+    if (tagRing.push(marker))
     {
-        hexString += "0";
+        xSemaphoreGive(tagReportDoorbell);
+        sessionReported = false;
     }
+}
+
+//==============================================================================
+// TID CACHE
+//==============================================================================
+
+// EPC -> TID das tags já resolvidas enquanto o gatilho segue pressionado.
+// Na falta, o tag_store responde com o que ficou gravado na flash de sessões anteriores.
+static TidCacheEntry tidCacheEntries[TID_CACHE_CAPACITY];
+static TidCache tidCache(tidCacheEntries, TID_CACHE_CAPACITY);
+
+//==============================================================================
+// TX POWER (tag mais próxima na leitura/gravação, alcance no inventário)
+//==============================================================================
+
+// Um controle por modo: a mesma task alterna entre eles
+static PowerController readPower(TX_POWER_MIN_DBM, TX_POWER_MAX_DBM, TX_POWER_START_DBM, RSSI_NEAREST_MIN_DBM);
+static PowerController writePower(TX_POWER_MIN_DBM, TX_POWER_MAX_DBM, TX_POWER_START_DBM, RSSI_NEAREST_MIN_DBM);
+
+//==============================================================================
+// READER PROFILE (ver reader_profile.h)
+//==============================================================================
+
+// Cópia da task: as rodadas leem daqui sem trava; só muda em RFID_EVENT_PROFILE
+static ReaderProfile profile;
+static bool profilePending = false; // Perfil novo chegou com o R200 dormindo
 
-    // Trava de segurança: garante que nunca excede o limite da memória EPC
-    if (hexString.length() > 24)
-        hexString = hexString.substring(0, 24);
+/**
+ * @brief Sends the profile's radio settings (the driver skips the ones already
+ *        confirmed) and hands its windows to the driver and the output side.
+ */
+static bool applyProfile()
+{
+    // O 0x0E só é aceito com o inventário parado; o laço o reinicia em seguida
+    if (rfid.isMultiPolling())
+        rfid.stopMultiPoll();
 
-    return hexString;
+    bool ok = rfid.setRegion(profile.region);
+    ok = rfid.setChannel(profile.channel) && ok;
+    ok = rfid.setQ(profile.q) && ok; // Com qAuto, o ponto de partida do ajuste
+
+    rfid.setAccessTimeouts(profile.tidTimeoutMs, profile.writeTimeoutMs);
+    readPower.setMaxPower(profile.txPowerDbm);
+    writePower.setMaxPower(profile.txPowerDbm);
+    tagOutputSetWindow(profile.dedupWindowMs);
+    return ok;
 }
 
-String hexToText(String hex)
+/**
+ * @brief Boot: waits for the R200 to answer and applies the current profile.
+ *
+ * Runs on the radio core while setup() mounts the flash and starts BLE. Every
+ * step is a command confirmed by its response, never a fixed delay.
+ */
+static bool bringUpRadio()
 {
-    String text = "";
-    for (unsigned int i = 0; i < hex.length(); i += 2)
+    profile = profileCurrent();
+    powerStayAwake(true);
+
+    bool ok = rfid.handshake(R200_BOOT_TIMEOUT_MS, &bootTimes.handshakeAttempts);
+    if (ok)
     {
-        String byteString = hex.substring(i, i + 2);
-        char byte = (char)strtol(byteString.c_str(), NULL, 16);
-        if (byte >= 32 && byte <= 126)
-            text += byte;
+        // O R200 mantém a configuração num reset do ESP32: o que ele responder aqui
+        // vira o valor confirmado, e o que já bate não é gravado de novo
+        uint8_t region, dbm;
+        R200QueryParams query;
+        rfid.getRegion(region);
+        rfid.getTxPower(dbm);
+        rfid.getQuery(query);
+
+        ok = applyProfile();
+        ok = rfid.setTxPower(profile.txPowerDbm) && ok; // Os modos ajustam a partir daqui (ver power_control.h)
+        if (!ok)
+            LOG_W("[R200] Modulo nao confirmou o perfil.");
+    }
+    else
+    {
+        // Tenta de novo no primeiro toque no gatilho
+        LOG_W("[R200] Modulo nao respondeu em %u ms.", (unsigned)R200_BOOT_TIMEOUT_MS);
+        profilePending = true;
     }
-    return text;
+
+    powerStayAwake(false);
+    bootTimes.radioOk = ok;
+    bootTimes.radioMs = millis();
+    return ok;
 }
 
 //==============================================================================
-// RFID READER TASK
+// CONTINUOUS INVENTORY (MULTI-POLL)
 //==============================================================================
-void rfidTask(void *parameter)
+
+// Q do inventário escolhido pela população vista em cada janela
+static TagDedupSlot qTunerSlots[Q_TUNE_SEEN_CAPACITY];
+static QTuner qTuner(Q_TUNE_MIN, Q_TUNE_MAX, Q_TUNE_WINDOW_MS, qTunerSlots, Q_TUNE_SEEN_CAPACITY);
+static bool qTuneActive = false;
+static uint32_t qTuneEmptyRounds = 0;
+
+/**
+ * @brief Receives every tag notice emitted by the R200 while multi-polling.
+ *
+ * Runs inside `rfid.processIncomingData()` on the RFID task, so it must not block:
+ * the read is pushed to the tag ring and dropped if the BLE task is behind.
+ */
+static void onInventoryTag(const R200Tag &tag, void *context)
 {
-    String lastTID = "";
-    R200Tag readTag;
+    if (tag.epcLen > 16)
+        return;
 
-    for (;;)
+    // Toda resposta conta para o Q, inclusive as que os filtros abaixo descartam
+    if (qTuneActive)
+        qTuner.onReply(tag.epc, tag.epcLen, tag.timestamp);
+    benchOnInventoryRead(tag);
+
+    // Tags fracas demais nem chegam ao filtro de repetição
+    if (rssiDbm(tag.rssi) < RSSI_INVENTORY_MIN_DBM)
+        return;
+
+    TagReport report;
+    report.tag = tag;
+    report.tid.len = 0;
+    report.flags = BLE_BATCH_FLAG_INVENTORY;
+    report.endOfSession = false;
+    report.originUs = 0;
+    publishTag(report);
+}
+
+/**
+ * @brief Starts the multi-poll at inventory power, seeding the Q tuner from the module.
+ */
+static void startInventory()
+{
+    rfid.setTxPower(profile.inventoryDbm);
+
+    // Com qAuto o ajuste segue do Q que o módulo ficou da última sessão; sem
+    // resposta ao 0x0D o inventário roda com ele mesmo assim
+    R200QueryParams query;
+    qTuneActive = profile.qAuto && rfid.getQuery(query);
+    if (qTuneActive)
+        qTuner.begin(query.q, millis());
+    else if (!profile.qAuto)
+        rfid.setQ(profile.q);
+    qTuneEmptyRounds = rfid.emptyRounds;
+
+    rfid.startMultiPoll(profile.pollRounds);
+}
+
+/**
+ * @brief Closes a finished tuning window and, if Q changed, restarts the multi-poll with it.
+ */
+static void tuneInventory()
+{
+    if (!qTuneActive || !qTuner.windowDone(millis()))
+        return;
+
+    uint32_t emptyRounds = rfid.emptyRounds;
+    if (!qTuner.endWindow(emptyRounds - qTuneEmptyRounds, millis()))
+    {
+        qTuneEmptyRounds = emptyRounds;
+        return;
+    }
+
+    // O 0x0E só é aceito com o inventário parado
+    rfid.stopMultiPoll();
+    if (!rfid.setQ(qTuner.q()))
+        qTuneActive = false;
+    qTuneEmptyRounds = rfid.emptyRounds;
+    rfid.startMultiPoll(profile.pollRounds);
+
+    LOG_I("[Inventario] Q = %u (%u tags, %lu respostas/s)",
+          qTuner.q(), qTuner.population(), (unsigned long)qTuner.repliesPerSec());
+}
+
+//==============================================================================
+// READ MODE
+//==============================================================================
+
+/**
+ * @brief Hands one read (EPC + TID) to the output side; the BLE task filters repeats.
+ */
+static void reportRead(const R200Tag &tag, const R200TID &tid, int64_t cycleStart)
+{
+    benchOnTidRead();
+    TagReport report;
+    report.tag = tag;
+    report.tid = tid;
+    report.flags = 0;
+    report.endOfSession = false;
+    report.originUs = cycleStart;
+    publishTag(report);
+}
+
+// Benchmark: todo TID vai pela linha, sem cache nem flash (ver runBenchmark())
+static bool coldTid = false;
+
+/**
+ * @brief One read round: polls, gathers the round, resolves the TIDs and reports them.
+ */
+static void readCycle(R200Tag &readTag)
+{
+    rfid.setTxPower(readPower.power());
+    readPower.beginRound();
+
+    int64_t cycleStart = latencyNow();
+    rfid.singlePoll();
+
+    // 1. Coleta todas as tags da rodada: depois da primeira, só continua
+    // esperando enquanto as notificações chegam em rajada
+    R200Tag roundTags[R200_TID_BATCH_MAX];
+    bool ambiguous[R200_TID_BATCH_MAX];
+    uint8_t found = 0;
+    unsigned long startTime = millis();
+    unsigned long elapsed;
+
+    while (found < R200_TID_BATCH_MAX && (elapsed = millis() - startTime) < profile.readWindowMs)
     {
-        bool isWriteMode = false;
-        if (xSemaphoreTake(writeDataMutex, (TickType_t)10) == pdTRUE)
+        uint32_t wait = profile.readWindowMs - elapsed;
+        if (found > 0 && wait > TID_ROUND_GAP_MS)
+            wait = TID_ROUND_GAP_MS;
+
+        if (!rfid.waitForTag(readTag, wait))
         {
-            isWriteMode = writeMode;
-            xSemaphoreGive(writeDataMutex);
+            if (found > 0)
+                break; // Rodada terminou
+            continue;
         }
 
-        if (isWriteMode)
+        // Filtro de sanidade: descarta pacotes gigantescos (lixo)
+        if (readTag.epcLen > 16)
+            continue;
+
+        // Tag distante: entra na estatística da potência, mas não é lida
+        readPower.observe(rssiDbm(readTag.rssi));
+        if (!readPower.accepts(rssiDbm(readTag.rssi)))
+            continue;
+
+        // O mesmo EPC duas vezes na rodada são tags diferentes com o mesmo
+        // conteúdo: o EPC não identifica nenhuma delas
+        uint8_t k = 0;
+        while (k < found && !roundTags[k].sameEpc(readTag))
+            k++;
+        if (k < found)
         {
-            vTaskDelay(pdMS_TO_TICKS(100));
+            ambiguous[k] = true;
             continue;
         }
 
-        if (digitalRead(READ_BUTTON_PIN) == LOW)
+        if (found == 0)
+            latencyRecord(LAT_POLL_TO_TAG, cycleStart);
+        roundTags[found] = readTag;
+        ambiguous[found] = false;
+        found++;
+    }
+
+    readPower.endRound();
+
+    if (found == 0)
+    {
+        latencyRecordMiss(LAT_POLL_TO_TAG);
+        return;
+    }
+
+    // 2. TIDs: EPCs já resolvidos nesta sessão (ou em sessões anteriores, pela
+    // flash) saem do cache; o resto vai em lote (Select + Leitura por tag, sem
+    // novo poll entre elas)
+    R200TID tids[R200_TID_BATCH_MAX];
+    R200Tag pending[R200_TID_BATCH_MAX];
+    uint8_t pendingIndex[R200_TID_BATCH_MAX];
+    uint8_t pendingCount = 0;
+
+    for (uint8_t i = 0; i < found; i++)
+    {
+        if (ambiguous[i])
         {
-            while (Serial2.available())
-                Serial2.read();
-            rfid.singlePoll();
+            tidCache.forget(roundTags[i]);
+            tagStoreMarkAmbiguous(roundTags[i]);
+        }
+        else if (!coldTid && tidCache.lookup(roundTags[i], tids[i], millis()))
+            continue;
+        else if (!coldTid && tagStoreLookup(roundTags[i], tids[i]))
+        {
+            tidCache.store(roundTags[i], tids[i], millis());
+            continue;
+        }
 
-            unsigned long startTime = millis();
-            bool tagFound = false;
+        pending[pendingCount] = roundTags[i];
+        pendingIndex[pendingCount++] = i;
+    }
 
-            while (millis() - startTime < 60)
-            {
-                if (rfid.processIncomingData(readTag))
-                {
-                    // Filtro de sanidade: descarta pacotes gigantescos (lixo)
-                    if (readTag.epc.length() <= 32)
-                    {
-                        tagFound = true;
-                        break; // Achei uma tag, interrompo para não poluir o buffer
-                    }
-                }
-                vTaskDelay(pdMS_TO_TICKS(2));
-            }
+    if (pendingCount > 0)
+    {
+        R200TID resolved[R200_TID_BATCH_MAX];
+        int64_t tidStart = latencyNow();
+
+        if (rfid.resolveTIDs(pending, pendingCount, resolved) > 0)
+            latencyRecord(LAT_TID_READ, tidStart);
+        else
+            latencyRecordMiss(LAT_TID_READ);
 
-            if (tagFound)
+        for (uint8_t j = 0; j < pendingCount; j++)
+        {
+            uint8_t i = pendingIndex[j];
+            tids[i] = resolved[j];
+            if (resolved[j].len > 0 && !ambiguous[i])
             {
-                // Dá um instante para o R200 terminar de falar e limpa a linha
-                vTaskDelay(pdMS_TO_TICKS(15));
-                while (Serial2.available())
-                    Serial2.read();
-
-                // LÊ O IDENTIFICADOR ÚNICO DE FÁBRICA (Protegido contra Cross-Talk)
-                String hardwareTID = rfid.getTID(readTag.epc);
-
-                // Se o TID falhar, NUNCA usar o EPC como plano B. Apenas ignora e tenta de novo.
-                if (hardwareTID != "" && hardwareTID != lastTID)
-                {
-                    lastTID = hardwareTID;
-                    String decodedText = hexToText(readTag.epc);
-
-                    JsonDocument jsonDoc;
-                    jsonDoc["type"] = "readResult";
-                    jsonDoc["content"]["status"] = "ok";
-
-                    // A App recebe o UID imutável do chip
-                    jsonDoc["content"]["uid"] = hardwareTID;
-                    jsonDoc["content"]["rssi"] = readTag.rssi;
-                    jsonDoc["content"]["data"] = (decodedText.length() > 0) ? decodedText : readTag.epc;
-
-                    char jsonString[256];
-                    serializeJson(jsonDoc, jsonString);
-                    xQueueSend(jsonDataQueue, &jsonString, (TickType_t)5);
-                    xSemaphoreGive(buzzerSemaphore);
-
-                    Serial.print(">>> LIDO | TID (Físico): ");
-                    Serial.print(hardwareTID);
-                    Serial.print(" | DATA: ");
-                    Serial.println(decodedText);
-                }
+                tidCache.store(pending[j], resolved[j], millis());
+                tagStoreRemember(pending[j], resolved[j]);
             }
         }
+    }
+
+    // 3. Se o TID falhar, NUNCA usar o EPC como plano B. Apenas ignora e tenta de novo.
+    for (uint8_t i = 0; i < found; i++)
+    {
+        if (tids[i].len > 0)
+            reportRead(roundTags[i], tids[i], cycleStart);
+    }
+}
+
+//==============================================================================
+// WRITE MODE (Com Memória de Sessão e Varredura Rápida)
+//==============================================================================
+
+// Memória de Sessão: TIDs já gravados desde que o gatilho foi pressionado
+// (sem janela de tempo; só é limpa ao soltar o gatilho)
+static TagDedupSlot sessionWrittenSlots[TAG_WRITE_SESSION_CAPACITY];
+static TagDedup sessionWritten(sessionWrittenSlots, TAG_WRITE_SESSION_CAPACITY, 0);
+
+// Alvo da gravação: a tag que se destaca na rodada, nunca "a primeira que respondeu"
+static WriteTargetPicker writeTarget(RSSI_NEAREST_MIN_DBM, WRITE_TARGET_MARGIN_DB);
+static bool ambiguityReported = false; // Um aviso por sessão do gatilho
+
+/**
+ * @brief true if @p tag's EPC already starts with @p payload, i.e. what writeEPC()
+ *        would leave from word 2 on. Checked on the live EPC, so it also holds after
+ *        a release or a reboot and never trusts a stale log entry.
+ */
+static bool carriesPayload(const R200Tag &tag, const R200Tag &payload)
+{
+    return payload.epcLen > 0 && tag.epcLen >= payload.epcLen &&
+           memcmp(tag.epc, payload.epc, payload.epcLen) == 0;
+}
+
+/**
+ * @brief One single-write round: picks the target tag, resolves its TID and writes
+ *        @p data with a Select on that TID.
+ */
+static void writeCycle(const String &data)
+{
+    R200Tag payload;
+    payload.epcLen = encodeWritePayload(data.c_str(), payload.epc, R200_MAX_EPC_BYTES);
+
+    // 2. DESCOBRIR A UID DA ETIQUETA EM CAMPO
+    R200TID targetTID;
+    R200Tag tempTag;
+    R200Tag roundTag;
+    bool sawTag = false;
+
+    rfid.setTxPower(writePower.power());
+    writePower.beginRound();
+    writeTarget.beginRound();
+
+    int64_t cycleStart = latencyNow();
+    rfid.singlePoll();
+
+    // Ouve a rodada inteira: o alvo sai do ranking por RSSI, e o controle de
+    // potência vê as vizinhas que respondem junto
+    unsigned long pollStart = millis();
+    unsigned long elapsed;
+    while ((elapsed = millis() - pollStart) < profile.writeWindowMs)
+    {
+        uint32_t wait = profile.writeWindowMs - elapsed;
+        if (sawTag && wait > TID_ROUND_GAP_MS)
+            wait = TID_ROUND_GAP_MS;
+
+        if (!rfid.waitForTag(roundTag, wait))
+        {
+            if (sawTag)
+                break; // Rodada terminou
+            continue;
+        }
+        if (roundTag.epcLen > 16)
+            continue;
+
+        sawTag = true;
+        writePower.observe(rssiDbm(roundTag.rssi));
+        writeTarget.observe(roundTag);
+    }
+    writePower.endRound();
+
+    WriteTargetVerdict verdict = writeTarget.pick(tempTag);
+    if (verdict == WRITE_TARGET_AMBIGUOUS)
+    {
+        // Duas tags quase iguais: gravar seria chute. A potência já desceu nesta
+        // rodada, então a próxima tende a deixar só uma em alcance
+        if (!ambiguityReported)
+        {
+            ambiguityReported = true;
+            JsonDocument doc;
+            doc["type"] = "feedback";
+            doc["content"]["status"] = "ambiguous";
+            doc["content"]["candidates"] = writeTarget.candidates();
+            doc["content"]["leadDb"] = writeTarget.lead();
+            doc["content"]["message"] = "Mais de uma tag perto. Aproxime só a etiqueta a gravar.";
+            sendJsonMessage(doc, MESSAGE_RELIABLE, cycleStart);
+        }
+        vTaskDelay(pdMS_TO_TICKS(30));
+        return;
+    }
+
+    if (verdict == WRITE_TARGET_NONE)
+        latencyRecordMiss(LAT_POLL_TO_TAG);
+    else if (carriesPayload(tempTag, payload))
+    {
+        // Já está com o conteúdo (gravada antes, talvez antes de um reboot): pula
+        vTaskDelay(pdMS_TO_TICKS(10));
+        return;
+    }
+    else
+    {
+        latencyRecord(LAT_POLL_TO_TAG, cycleStart);
+
+        // O TID vira a máscara do Select da escrita: sempre lido no ar, nunca da
+        // flash (lá é só uma dica; outro chip com o mesmo EPC seria gravado no lugar).
+        // Passa o EPC alvo para garantir que não lemos a tag vizinha
+        int64_t tidStart = latencyNow();
+        if (rfid.getTID(targetTID, &tempTag))
+        {
+            latencyRecord(LAT_TID_READ, tidStart);
+            // Um TID diferente do guardado torna o EPC ambíguo na flash
+            tagStoreRemember(tempTag, targetTID);
+        }
+        else
+            latencyRecordMiss(LAT_TID_READ);
+    }
+
+    // Se não achou uma tag válida ou se a extração do TID físico falhou, recomeça
+    if (targetTID.len == 0)
+    {
+        vTaskDelay(pdMS_TO_TICKS(30)); // Varrer mais rápido
+        return;
+    }
+
+    // --- NOVO: FILTRO ANTI-REPETIÇÃO ---
+    if (sessionWritten.contains(targetTID.bytes, targetTID.len, millis()))
+    {
+        // Já gravamos nesta etiqueta! Pula imediatamente sem demorar.
+        vTaskDelay(pdMS_TO_TICKS(10));
+        return;
+    }
+    // -----------------------------------
+
+    // 3. GRAVAR
+    char targetHex[2 * R200_TID_BYTES + 1];
+    targetTID.toHex(targetHex, sizeof(targetHex));
+
+    LOG_D("[App BLE] Gravando: %s", data.c_str());
+    LOG_D("          Na Tag TID: %s", targetHex);
+
+    bool success = false;
+    int attempts = 0;
+
+    while (attempts < WRITE_ATTEMPTS && !success)
+    {
+        attempts++;
+        int64_t writeStart = latencyNow();
+        // Select no TID: só o chip escolhido aceita a escrita, mesmo com vizinhas no campo
+        int result = rfid.writeEPC(payload.epc, payload.epcLen, 0, &targetTID);
+
+        // Resposta de erro também mede o tempo de ida e volta; só o silêncio é "miss"
+        if (result == 0)
+            latencyRecordMiss(LAT_EPC_WRITE);
+        else
+            latencyRecord(LAT_EPC_WRITE, writeStart);
+
+        if (result == 1)
+            success = true;
+        else
+            vTaskDelay(pdMS_TO_TICKS(20));
+    }
+
+    // 4. ENVIO DE FEEDBACK AO APP
+    JsonDocument responseDoc;
+
+    if (success)
+    {
+        // Registra que a gravação teve sucesso para ignorar na próxima volta!
+        sessionWritten.mark(targetTID.bytes, targetTID.len, millis());
+        // O EPC antigo não pertence mais a este TID; a flash guarda o novo
+        tidCache.forget(tempTag);
+        tagStoreRecordWrite(targetTID, payload);
+
+        responseDoc["type"] = "writeResult";
+        responseDoc["content"]["status"] = "ok";
+        responseDoc["content"]["uid"] = targetHex;
+        responseDoc["content"]["data"] = data;
+        responseDoc["content"]["message"] = "Gravado com Sucesso!";
+
+        // O bipe toca na task de UI; a próxima rodada já tem a janela do poll como ritmo
+        uiPlay(UI_PATTERN_DOUBLE);
+    }
+    else
+    {
+        responseDoc["type"] = "feedback";
+        responseDoc["content"]["status"] = "error";
+        responseDoc["content"]["message"] = "Falha ao gravar.";
+        uiPlay(UI_PATTERN_ERROR);
+    }
+
+    sendJsonMessage(responseDoc, MESSAGE_RELIABLE, cycleStart);
+}
+
+//==============================================================================
+// BULK ENCODING (lista/modelo de payloads, gravação conferida por releitura)
+//==============================================================================
+
+// Janelas do 0x49 e do 0x39 que acompanham a latência medida na linha
+static AdaptiveTimeout writeTimeout(BULK_WRITE_TIMEOUT_MAX_MS, BULK_WRITE_TIMEOUT_MIN_MS, BULK_WRITE_TIMEOUT_MAX_MS);
+static AdaptiveTimeout readTimeout(BULK_READ_TIMEOUT_MAX_MS, BULK_READ_TIMEOUT_MIN_MS, BULK_READ_TIMEOUT_MAX_MS);
+
+// EPCs que já se mostraram ser de um chip contado neste job (payload repetido na
+// lista): ficam de fora por um tempo para não tomar a vez das tags virgens
+static TagDedupSlot repeatSkipSlots[64];
+static TagDedup repeatSkip(repeatSkipSlots, 64, 2000);
+
+static void feedTimeout(AdaptiveTimeout &window, R200Status status, uint16_t elapsedMs)
+{
+    if (status == R200_TIMEOUT)
+        window.expired();
+    else
+        window.sample(elapsedMs);
+}
+
+/**
+ * @brief Sends the result of one bulk tag as writeResult (with its job index).
+ */
+static void reportBulkTag(int index, const R200Tag &payload, const R200TID &tid, bool ok, int64_t cycleStart)
+{
+    benchOnWrite(ok);
+    char epcHex[2 * R200_MAX_EPC_BYTES + 1];
+    payload.epcToHex(epcHex, sizeof(epcHex));
+
+    JsonDocument doc;
+    doc["type"] = "writeResult";
+    doc["content"]["status"] = ok ? "ok" : "error";
+    doc["content"]["index"] = index;
+    doc["content"]["epc"] = epcHex;
+    if (ok)
+    {
+        char tidHex[2 * R200_TID_BYTES + 1];
+        tid.toHex(tidHex, sizeof(tidHex));
+        doc["content"]["uid"] = tidHex;
+    }
+    else
+        doc["content"]["message"] = "Gravação não confirmada";
+
+    // Falhas viram nova tentativa na próxima rodada; só os sucessos não podem se perder
+    sendJsonMessage(doc, ok ? MESSAGE_RELIABLE : MESSAGE_BEST_EFFORT, cycleStart);
+}
+
+/**
+ * @brief Reports a finished or cancelled job (with throughput) and clears it.
+ */
+static void finishBulkJob()
+{
+    BulkJobState state;
+    uint16_t total, done, failures;
+    uint32_t elapsed;
+
+    if (xSemaphoreTake(writeDataMutex, portMAX_DELAY) != pdTRUE)
+        return;
+    state = bulkJob.state();
+    total = bulkJob.total();
+    done = bulkJob.done();
+    failures = bulkJob.failures();
+    elapsed = bulkJob.elapsedMs(millis());
+    bulkJob.clear();
+    // Job concluído volta para leitura: o gatilho pressionado não grava mais nada
+    if (state == BULK_DONE)
+    {
+        writeMode = false;
+        dataToRecord = "";
+    }
+    xSemaphoreGive(writeDataMutex);
+
+    float tagsPerMin = elapsed > 0 ? done * 60000.0f / elapsed : 0;
+
+    JsonDocument doc;
+    doc["type"] = "bulkResult";
+    doc["content"]["status"] = (state == BULK_DONE) ? "done" : "cancelled";
+    doc["content"]["total"] = total;
+    doc["content"]["written"] = done;
+    doc["content"]["failures"] = failures;
+    doc["content"]["elapsedMs"] = elapsed;
+    doc["content"]["tagsPerMin"] = tagsPerMin;
+    doc["content"]["writeTimeoutMs"] = writeTimeout.timeout();
+    doc["content"]["readTimeoutMs"] = readTimeout.timeout();
+    sendJsonMessage(doc, MESSAGE_RELIABLE);
+
+    LOG_I("[Bulk] %u/%u tags em %lu ms (%.1f tags/min, %u falhas)",
+          done, total, (unsigned long)elapsed, tagsPerMin, failures);
+}
+
+/**
+ * @brief One bulk round: polls, picks a tag and writes/confirms the next payload.
+ *
+ * No pauses: the pipelined command sequence is the only wait, and the buzzer gets a
+ * single beep per confirmed tag.
+ */
+static bool bulkWriteCycle()
+{
+    R200Tag tag;
+
+    // Sobras da rodada anterior podem trazer um EPC que já foi regravado
+    while (rfid.processIncomingData(tag, 0))
+        ;
+
+    rfid.setTxPower(writePower.power());
+    writePower.beginRound();
+
+    int64_t cycleStart = latencyNow();
+    rfid.singlePoll();
+
+    // 1. Escolhe a tag da rodada. Confirmar vem antes de gravar: um payload
+    // pendente que já está num chip (gravação sem conferência, job retomado após
+    // reboot) não pode ir também para uma tag virgem
+    R200Tag target;
+    int action = BULK_TAG_DONE;
+    bool sawTag = false;
+    unsigned long pollStart = millis();
+    unsigned long elapsed;
+
+    while ((elapsed = millis() - pollStart) < BULK_POLL_WINDOW_MS)
+    {
+        uint32_t wait = BULK_POLL_WINDOW_MS - elapsed;
+        if (sawTag && wait > TID_ROUND_GAP_MS)
+            wait = TID_ROUND_GAP_MS;
+
+        if (!rfid.waitForTag(tag, wait))
+        {
+            if (sawTag)
+                break; // Rodada terminou
+            continue;
+        }
+        if (tag.epcLen > 16)
+            continue;
+
+        if (!sawTag)
+            latencyRecord(LAT_POLL_TO_TAG, cycleStart);
+        sawTag = true;
+
+        writePower.observe(rssiDbm(tag.rssi));
+        if (!writePower.accepts(rssiDbm(tag.rssi)))
+            continue;
+
+        int kind = BULK_TAG_DONE;
+        if (xSemaphoreTake(writeDataMutex, portMAX_DELAY) == pdTRUE)
+        {
+            kind = bulkJob.classify(tag);
+            xSemaphoreGive(writeDataMutex);
+        }
+        if (kind >= 0 && repeatSkip.contains(tag.epc, tag.epcLen, millis()))
+            kind = BULK_TAG_DONE;
+
+        if ((kind >= 0 && action < 0) || (kind == BULK_TAG_NEW && action == BULK_TAG_DONE))
+        {
+            target = tag;
+            action = kind;
+        }
+    }
+
+    writePower.endRound();
+
+    if (!sawTag)
+        latencyRecordMiss(LAT_POLL_TO_TAG);
+    if (action == BULK_TAG_DONE)
+        return false;
+
+    R200Tag payload;
+    int index = -1;
+    if (xSemaphoreTake(writeDataMutex, portMAX_DELAY) == pdTRUE)
+    {
+        bulkJob.markAttempt(millis());
+        if (action >= 0)
+        {
+            index = action;
+            bulkJob.payloadAt(index, payload);
+        }
+        else
+            index = bulkJob.nextPayload(payload);
+        xSemaphoreGive(writeDataMutex);
+    }
+    if (index < 0)
+        return false;
+
+    R200TID tid;
+    bool ok;
+
+    if (action >= 0)
+    {
+        // 2a. Já carrega o payload: a leitura do TID (com Select no EPC) confirma
+        int64_t tidStart = latencyNow();
+        ok = rfid.resolveTIDs(&target, 1, &tid) == 1;
+        if (ok)
+            latencyRecord(LAT_TID_READ, tidStart);
+        else
+            latencyRecordMiss(LAT_TID_READ);
+    }
+    else
+    {
+        // 2b. Select + TID + Escrita + Select + Releitura numa única sequência
+        R200TID known;
+        bool haveTid = tagStoreLookup(target, known);
+        R200WriteOutcome outcome;
+
+        int64_t writeStart = latencyNow();
+        ok = rfid.writeVerified(target, payload.epc, payload.epcLen, haveTid ? &known : NULL,
+                                writeTimeout.timeout(), readTimeout.timeout(), outcome);
+        if (outcome.writeStatus == R200_TIMEOUT)
+            latencyRecordMiss(LAT_EPC_WRITE);
         else
+            latencyRecord(LAT_EPC_WRITE, writeStart);
+
+        feedTimeout(writeTimeout, outcome.writeStatus, outcome.writeMs);
+        feedTimeout(readTimeout, outcome.verifyStatus, outcome.verifyMs);
+
+        tid = outcome.tid;
+        if (ok)
         {
-            if (lastTID != "")
-                lastTID = "";
-            vTaskDelay(pdMS_TO_TICKS(50));
+            // O EPC antigo não pertence mais a este TID; a flash guarda o novo
+            tidCache.forget(target);
+            tagStoreRecordWrite(tid, payload);
         }
     }
+
+    // 3. Contabiliza: um chip que já foi contado (payload repetido na lista) não conta de novo
+    bool repeat = false;
+    bool finished = false;
+    if (xSemaphoreTake(writeDataMutex, portMAX_DELAY) == pdTRUE)
+    {
+        if (ok && bulkJob.doneTid(tid))
+            repeat = true;
+        else if (ok)
+            bulkJob.markDone(index, tid, millis());
+        else
+            bulkJob.markFailure();
+        finished = bulkJob.state() == BULK_DONE;
+        xSemaphoreGive(writeDataMutex);
+    }
+
+    if (repeat)
+    {
+        repeatSkip.mark(target.epc, target.epcLen, millis());
+        return false;
+    }
+
+    reportBulkTag(index, payload, tid, ok, cycleStart);
+    if (ok)
+        uiPlay(UI_PATTERN_SINGLE);
+    return finished;
 }
 
 //==============================================================================
-// RFID WRITER TASK (Com Memória de Sessão e Varredura Rápida)
+// RFID ENGINE TASK
 //==============================================================================
 
-// Variáveis para a Memória de Sessão
-#define MAX_SESSION_TAGS 50
-String sessionWrittenTags[MAX_SESSION_TAGS];
-int sessionWrittenCount = 0;
+/** @brief What a trigger press does, as last set by the app. */
+enum EngineMode
+{
+    ENGINE_READ,
+    ENGINE_INVENTORY,
+    ENGINE_WRITE,
+    ENGINE_BULK
+};
+
+static TaskHandle_t engineTask = NULL;
+
+void rfidNotify(uint32_t events)
+{
+    if (engineTask)
+        xTaskNotify(engineTask, events, eSetBits);
+}
 
-void rfidWriteTask(void *parameter)
+/**
+ * @brief Copies the mode set by the app. Only runs on RFID_EVENT_MODE, so the
+ *        rounds never wait on writeDataMutex to learn what to do.
+ */
+static EngineMode loadMode(String &data, BulkJobState &bulkState)
 {
+    EngineMode mode = ENGINE_READ;
+
+    xSemaphoreTake(writeDataMutex, portMAX_DELAY);
+    bulkState = bulkJob.state();
+    data = dataToRecord;
+    if (writeMode)
+        mode = (bulkState == BULK_RUNNING) ? ENGINE_BULK : ENGINE_WRITE;
+    else if (inventoryMode)
+        mode = ENGINE_INVENTORY;
+    xSemaphoreGive(writeDataMutex);
+
+    return mode;
+}
+
+/**
+ * @brief Trigger released: stops the inventory and drops everything that is only
+ *        valid while the trigger stays pressed.
+ */
+static void endTriggerSession()
+{
+    if (rfid.isMultiPolling())
+        rfid.stopMultiPoll();
+    // Fora do gatilho o EPC pode ter mudado de dono: o cache vale só por sessão
+    tidCache.clear();
+    sessionWritten.clear();
+    ambiguityReported = false;
+
+    powerRadioState(POWER_RADIO_IDLE);
+    powerStayAwake(false);
+}
+
+/**
+ * @brief Trigger pressed: keeps the chip awake for the UART and resumes the R200.
+ * @return false if the R200 did not answer the wake (retried on the next loop).
+ */
+static bool beginTriggerSession()
+{
+    powerStayAwake(true);
+    if (rfid.isAsleep())
+    {
+        unsigned long start = millis();
+        if (!rfid.wake())
+        {
+            LOG_W("[R200] Modulo nao acordou.");
+            return false;
+        }
+        powerRecordWake(millis() - start);
+    }
+    if (profilePending)
+    {
+        profilePending = false;
+        applyProfile();
+    }
+    powerRadioState(POWER_RADIO_ACTIVE);
+    return true;
+}
+
+/**
+ * @brief Trigger idle for the profile's sleepIdleMs: puts the R200 to sleep until the next press.
+ */
+static void sleepRadio()
+{
+    // A confirmação do 0x17 chega pela UART, que não roda em light sleep
+    powerStayAwake(true);
+    if (rfid.sleep())
+        powerRadioState(POWER_RADIO_ASLEEP);
+    powerStayAwake(false);
+}
+
+/**
+ * @brief Runs the queued benchmark: timed inventory, TID and bulk write phases,
+ *        driven like a held trigger (see benchmark.h).
+ *
+ * Pressing the trigger or a "cancel" ends it early. With the trigger already
+ * pressed nothing runs and the report comes back aborted.
+ */
+static void runBenchmark(R200Tag &readTag)
+{
+    BenchConfig config;
+    if (!benchBegin(config))
+        return;
+
+    if (triggerPressed())
+    {
+        benchFinish(true);
+        return;
+    }
+    if (!beginTriggerSession())
+    {
+        powerStayAwake(false);
+        benchFinish(true);
+        return;
+    }
+
+    uint32_t phaseMs = config.seconds * 1000UL;
+    bool aborted = false;
+
+    // 1. Inventário contínuo
+    benchPhaseBegin(BENCH_INVENTORY);
+    startInventory();
+    for (uint32_t start = millis(); !aborted && millis() - start < phaseMs;)
+    {
+        rfid.processIncomingData(readTag, 20);
+        tuneInventory();
+        aborted = triggerPressed() || benchCancelled();
+    }
+    rfid.stopMultiPoll();
+    benchPhaseEnd();
+    // O lado da saída esquece as tags: a próxima fase as reporta de novo
+    endReportSession();
+
+    // 2. Rodadas de leitura com o 0x39 de cada tag
+    if (!aborted)
+    {
+        benchPhaseBegin(BENCH_TID);
+        coldTid = true;
+        for (uint32_t start = millis(); !aborted && millis() - start < phaseMs;)
+        {
+            readCycle(readTag);
+            aborted = triggerPressed() || benchCancelled();
+        }
+        coldTid = false;
+        benchPhaseEnd();
+        endReportSession();
+    }
+
+    // 3. Gravação em lote, só com um job carregado
+    bool bulkLoaded = false;
+    if (!aborted && config.write && xSemaphoreTake(writeDataMutex, portMAX_DELAY) == pdTRUE)
+    {
+        bulkLoaded = bulkJob.state() == BULK_RUNNING;
+        xSemaphoreGive(writeDataMutex);
+    }
+    if (bulkLoaded)
+    {
+        // O último payload encerra o job e a fase; o fechamento do job fica fora da medida
+        bool finished = false;
+        benchPhaseBegin(BENCH_WRITE);
+        for (uint32_t start = millis(); !aborted && !finished && millis() - start < phaseMs;)
+        {
+            finished = bulkWriteCycle();
+            if (!finished)
+                aborted = triggerPressed() || benchCancelled();
+        }
+        benchPhaseEnd();
+        if (finished)
+            finishBulkJob();
+    }
+
+    endTriggerSession();
+    benchFinish(aborted);
+}
+
+void rfidTask(void *parameter)
+{
+    R200Tag readTag;
+    String data;
+    BulkJobState bulkState;
+
+    engineTask = xTaskGetCurrentTaskHandle();
+    triggerSubscribe(engineTask, RFID_EVENT_TRIGGER);
+    rfid.setTagCallback(onInventoryTag);
+    bringUpRadio();
+
+    // As rodadas esperam o fim do setup() (tag store, log de sessão, BLE); os
+    // eventos que chegarem até lá são tratados na primeira volta do laço
+    uint32_t events = 0;
+    while (!(events & RFID_EVENT_START))
+    {
+        uint32_t received = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &received, portMAX_DELAY);
+        events |= received;
+    }
+    bootTimes.readyMs = millis();
+    LOG_I("[Boot] Pronto em %lu ms (R200 %lu ms, %u tentativa(s) de 0x03; BLE %lu ms).",
+          (unsigned long)bootTimes.readyMs, (unsigned long)bootTimes.radioMs,
+          (unsigned)bootTimes.handshakeAttempts, (unsigned long)bootTimes.bleMs);
+
+    EngineMode mode = loadMode(data, bulkState);
+    bool pressed = false;
+
     for (;;)
     {
-        bool isWriteMode = false;
-        String localDataToRecord = "";
+        // Dormindo, o R200 só recebe o perfil novo ao acordar
+        if (events & RFID_EVENT_PROFILE)
+        {
+            profile = profileCurrent();
+            if (rfid.isAsleep())
+                profilePending = true;
+            else
+            {
+                powerStayAwake(true);
+                applyProfile();
+                powerStayAwake(pressed);
+            }
+        }
 
-        if (xSemaphoreTake(writeDataMutex, (TickType_t)10) == pdTRUE)
+        // Benchmark: roda inteiro aqui; o job em lote pode ter terminado nele
+        if (events & RFID_EVENT_BENCH)
         {
-            isWriteMode = writeMode;
-            localDataToRecord = dataToRecord;
-            xSemaphoreGive(writeDataMutex);
+            runBenchmark(readTag);
+            events |= RFID_EVENT_MODE;
+        }
+
+        if (events & RFID_EVENT_MODE)
+        {
+            mode = loadMode(data, bulkState);
+
+            // Job em lote terminou (ou foi cancelado): relatório com a vazão
+            if (bulkState == BULK_DONE || bulkState == BULK_CANCELLED)
+            {
+                finishBulkJob();
+                mode = loadMode(data, bulkState);
+            }
+
+            // O modo mudou com o gatilho pressionado: encerra o inventário
+            if (mode != ENGINE_INVENTORY && rfid.isMultiPolling())
+                rfid.stopMultiPoll();
         }
 
-        // Monitora o estado do botão
-        int currentButtonState = digitalRead(READ_BUTTON_PIN);
+        bool wasPressed = pressed;
+        pressed = triggerPressed();
 
-        // Se o botão for solto, limpa a memória para a próxima sessão de gravação
-        if (currentButtonState == HIGH)
+        if (!pressed)
         {
-            sessionWrittenCount = 0;
+            if (wasPressed)
+                endTriggerSession();
+            endReportSession();
+
+            // Solto, dorme até um comando do app ou o próximo toque no gatilho.
+            // Com o anel cheio o marcador de fim de sessão é tentado de novo em breve;
+            // sem nada pelo sleepIdleMs do perfil, o R200 também vai dormir
+            TickType_t wait = portMAX_DELAY;
+            bool sleepDue = false;
+            if (sessionReported)
+                wait = pdMS_TO_TICKS(20);
+            else if (profile.sleepIdleMs > 0 && !rfid.isAsleep())
+            {
+                wait = pdMS_TO_TICKS(profile.sleepIdleMs);
+                sleepDue = true;
+            }
+
+            events = 0;
+            if (xTaskNotifyWait(0, UINT32_MAX, &events, wait) == pdFALSE && sleepDue)
+                sleepRadio();
+            continue;
         }
 
-        if (isWriteMode)
+        if ((!wasPressed || rfid.isAsleep()) && !beginTriggerSession())
         {
-            if (currentButtonState == LOW)
+            events = 0;
+            xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(50));
+            continue;
+        }
+
+        switch (mode)
+        {
+        case ENGINE_INVENTORY:
+            if (!rfid.isMultiPolling())
+                startInventory();
+
+            // As tags chegam em onInventoryTag(); a task dorme na fila de frames
+            // e só acorda sem frames para checar o gatilho e a janela do Q
+            rfid.processIncomingData(readTag, 20);
+            tuneInventory();
+            break;
+
+        case ENGINE_WRITE:
+            writeCycle(data);
+            break;
+
+        case ENGINE_BULK:
+            // Uma tag atrás da outra; o último payload encerra o job
+            if (bulkWriteCycle())
             {
-                // 1. DESCOBRIR A UID DA ETIQUETA EM CAMPO
-                String targetTID = "";
-                R200Tag tempTag;
-                bool tagFound = false;
-
-                while (Serial2.available())
-                    Serial2.read();
-                rfid.singlePoll();
-
-                unsigned long pollStart = millis();
-                while (millis() - pollStart < 80) // Acelerado para 80ms
-                {
-                    if (rfid.processIncomingData(tempTag))
-                    {
-                        if (tempTag.epc.length() <= 32)
-                        {
-                            tagFound = true;
-                            break;
-                        }
-                    }
-                    vTaskDelay(pdMS_TO_TICKS(2));
-                }
-
-                if (tagFound)
-                {
-                    vTaskDelay(pdMS_TO_TICKS(15));
-                    while (Serial2.available())
-                        Serial2.read();
-
-                    // Passa o EPC alvo para garantir que não lemos a tag vizinha
-                    targetTID = rfid.getTID(tempTag.epc);
-                }
-
-                // Se não achou uma tag válida ou se a extração do TID físico falhou, recomeça
-                if (targetTID == "")
-                {
-                    vTaskDelay(pdMS_TO_TICKS(30)); // Varrer mais rápido
-                    continue;
-                }
-
-                // --- NOVO: FILTRO ANTI-REPETIÇÃO ---
-                bool alreadyWritten = false;
-                for (int i = 0; i < sessionWrittenCount; i++)
-                {
-                    if (sessionWrittenTags[i] == targetTID)
-                    {
-                        alreadyWritten = true;
-                        break;
-                    }
-                }
-
-                if (alreadyWritten)
-                {
-                    // Já gravamos nesta etiqueta! Pula imediatamente sem demorar.
-                    vTaskDelay(pdMS_TO_TICKS(10));
-                    continue;
-                }
-                // -----------------------------------
-
-                // 2. PREPARAR DADOS E GRAVAR
-                String epcToSend = localDataToRecord;
-                bool looksLikeText = false;
-                for (unsigned int i = 0; i < localDataToRecord.length(); i++)
-                {
-                    char c = localDataToRecord.charAt(i);
-                    if (!isxdigit(c))
-                    {
-                        looksLikeText = true;
-                        break;
-                    }
-                }
-
-                if (looksLikeText)
-                    epcToSend = textToHex(localDataToRecord);
-                else
-                {
-                    while (epcToSend.length() < 24)
-                        epcToSend += "0";
-                    if (epcToSend.length() > 24)
-                        epcToSend = epcToSend.substring(0, 24);
-                }
-
-                Serial.print("[App BLE] Gravando: ");
-                Serial.println(localDataToRecord);
-                Serial.print("          Na Tag TID: ");
-                Serial.println(targetTID);
-
-                bool success = false;
-                int attempts = 0;
-
-                while (attempts < 5 && !success)
-                {
-                    attempts++;
-                    while (Serial2.available())
-                        Serial2.read();
-
-                    rfid.writeStatus = 0;
-                    rfid.writeEPC(epcToSend);
-
-                    unsigned long startTime = millis();
-                    while (millis() - startTime < 800)
-                    {
-                        R200Tag dummy;
-                        rfid.processIncomingData(dummy);
-                        if (rfid.writeStatus != 0)
-                            break;
-                        vTaskDelay(pdMS_TO_TICKS(5));
-                    }
-
-                    if (rfid.writeStatus == 1)
-                        success = true;
-                    else
-                        vTaskDelay(pdMS_TO_TICKS(100));
-                }
-
-                // 3. ENVIO DE FEEDBACK AO APP
-                JsonDocument responseDoc;
-
-                if (success)
-                {
-                    // Registra que a gravação teve sucesso para ignorar na próxima volta!
-                    if (sessionWrittenCount < MAX_SESSION_TAGS)
-                    {
-                        sessionWrittenTags[sessionWrittenCount++] = targetTID;
-                    }
-
-                    responseDoc["type"] = "writeResult";
-                    responseDoc["content"]["status"] = "ok";
-                    responseDoc["content"]["uid"] = targetTID;
-                    responseDoc["content"]["data"] = localDataToRecord;
-                    responseDoc["content"]["message"] = "Gravado com Sucesso!";
-
-                    xSemaphoreGive(buzzerSemaphore);
-                    vTaskDelay(pdMS_TO_TICKS(80));
-                    xSemaphoreGive(buzzerSemaphore);
-
-                    // DELAY DE 1 SEGUNDO REMOVIDO!
-                    // Agora espera só uma fração de segundo e já vai para a próxima etiqueta
-                    vTaskDelay(pdMS_TO_TICKS(50));
-                }
-                else
-                {
-                    responseDoc["type"] = "feedback";
-                    responseDoc["content"]["status"] = "error";
-                    responseDoc["content"]["message"] = "Falha ao gravar.";
-                    vTaskDelay(pdMS_TO_TICKS(200));
-                }
-
-                char responseJson[256];
-                serializeJson(responseDoc, responseJson);
-                xQueueSend(jsonDataQueue, &responseJson, (TickType_t)10);
+                finishBulkJob();
+                mode = loadMode(data, bulkState);
             }
+            break;
+
+        default:
+            readCycle(readTag);
+            break;
         }
-        vTaskDelay(pdMS_TO_TICKS(50));
+
+        // Pressionado não há espera: só recolhe o que chegou durante a rodada
+        events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, 0);
     }
-}
\ No newline at end of file
+}
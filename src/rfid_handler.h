@@ -1,27 +1,51 @@
 /**
  * @file rfid_handler.h
  * @author Luis Felipe Patrocinio
- * @brief Prototypes for RFID handling tasks.
+ * @brief Prototypes for the RFID engine task.
  * @date 2025-08-26
  */
 
 #ifndef RFID_HANDLER_H
 #define RFID_HANDLER_H
 
+#include <stdint.h>
+
+/** @brief Engine event: writeMode, inventoryMode, dataToRecord or bulkJob changed. */
+#define RFID_EVENT_MODE (1u << 0)
+
+/** @brief Engine event: the trigger was pressed or released (see trigger.h). */
+#define RFID_EVENT_TRIGGER (1u << 1)
+
+/** @brief Engine event: a new reader profile was set (see reader_profile.h). */
+#define RFID_EVENT_PROFILE (1u << 2)
+
+/** @brief Engine event: setup() finished (stores and BLE are up), the engine may start. */
+#define RFID_EVENT_START (1u << 3)
+
+/** @brief Engine event: a benchmark run was queued (see benchmark.h). */
+#define RFID_EVENT_BENCH (1u << 4)
+
 /**
- * @brief FreeRTOS task to read RFID tags when the button is pressed.
+ * @brief FreeRTOS task that reads, inventories or writes tags while the trigger is
+ *        pressed, in the mode last set by the app.
+ *
+ * On start it brings the R200 up (handshake, then the reader profile, writing only
+ * the settings the module does not already have) while setup() carries on, and
+ * serves the trigger only after RFID_EVENT_START. Create it after profileBegin()
+ * and powerBegin().
+ *
+ * The mode is copied once per RFID_EVENT_MODE; with the trigger released the task
+ * sleeps on its notifications until the next command or trigger edge.
+ *
  * @param parameter Unused task parameter.
  */
 void rfidTask(void *parameter);
 
 /**
- * @brief FreeRTOS task to write data to an RFID tag.
- * @param parameter Unused task parameter.
+ * @brief Wakes the engine with @p events (RFID_EVENT_* bits). Safe from any task.
+ *
+ * Call after changing the shared mode state, once writeDataMutex is released.
  */
-void rfidWriteTask(void *parameter);
-
-// Declaração das Funções Auxiliares
-String textToHex(String text);
-String hexToText(String hex);
+void rfidNotify(uint32_t events);
 
 #endif // RFID_HANDLER_H
\ No newline at end of file
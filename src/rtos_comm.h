@@ -17,30 +17,64 @@
 #include "freertos/semphr.h"
 #include <BLECharacteristic.h>
 #include "R200.h"
+#include "bulk_job.h"
+#include "tag_ring.h"
 
 //==============================================================================
 // GLOBAL OBJECTS
 //==============================================================================
 extern R200Driver rfid;                     ///< Global instance of the R200 RFID driver.
-extern BLECharacteristic *pCharacteristic;  ///< Global pointer to the BLE characteristic.
+extern BLECharacteristic *pCharacteristic;  ///< BLE results stream (see setupBLE()).
+extern TagRing tagRing;                     ///< Tag reads from the RFID task (producer) to the BLE task (consumer).
 
 //==============================================================================
 // GLOBAL STATE VARIABLES
 //==============================================================================
 extern volatile bool bluetoothConnected; ///< True if a BLE client is connected.
 extern volatile bool writeMode;          ///< True if the device is in RFID write mode.
+extern volatile bool inventoryMode;      ///< True if the trigger runs continuous inventory (0x27).
+extern volatile bool binaryOutput;       ///< True if tag reads go out as binary batches (see ble_batch.h).
 extern String dataToRecord;              ///< Data buffer for the RFID write operation.
+extern BulkJob bulkJob;                  ///< Bulk encoding job (guarded by `writeDataMutex`).
+
+/**
+ * @struct BootTimes
+ * @brief Time-to-ready of this boot, in ms since the application started (see setup()).
+ *
+ * The R200 is brought up by the RFID task while setup() mounts the flash and
+ * starts BLE; the trigger is served once both are done.
+ */
+struct BootTimes
+{
+    uint32_t radioMs;          ///< R200 answered and the reader profile was applied (or given up).
+    uint32_t bleMs;            ///< Advertising started.
+    uint32_t readyMs;          ///< setup() finished with the radio up: trigger presses are served.
+    uint8_t handshakeAttempts; ///< 0x03 sent until the R200 answered.
+    bool radioOk;              ///< false = the R200 did not answer or did not confirm a setting.
+};
+extern BootTimes bootTimes; ///< Written once during boot, read by the stats command.
 
 //==============================================================================
 // FREERTOS PRIMITIVES (HANDLES)
 //==============================================================================
-/// @brief Queue for passing JSON data from RFID tasks to the BLE task.
+/// @brief Queue of `MessageHandle`s (see message_pool.h) from the producers to the BLE task.
 extern QueueHandle_t jsonDataQueue;
 
+/// @brief Binary semaphore given after each push to `tagRing`, so the BLE task can sleep on it.
+extern SemaphoreHandle_t tagReportDoorbell;
+
+/// @brief Queue set the BLE task blocks on (`jsonDataQueue` + `tagReportDoorbell`).
+extern QueueSetHandle_t bleQueueSet;
+
 /// @brief Mutex to protect access to shared variables like `writeMode` and `dataToRecord`.
+/// Whoever changes them calls rfidNotify(RFID_EVENT_MODE) afterwards (see rfid_handler.h).
 extern SemaphoreHandle_t writeDataMutex;
 
-/// @brief Binary semaphore used to trigger the buzzer task.
-extern SemaphoreHandle_t buzzerSemaphore;
+/// @brief Queue of `BleCommand`s (see ble_comm.h) from the BLE write callback to the command task.
+extern QueueHandle_t commandQueue;
+
+/// @brief Application tasks (RFID, BLE, UI, the R200 UART owner, commands and log), for the stack reports.
+#define APP_TASK_COUNT 6
+extern TaskHandle_t appTasks[APP_TASK_COUNT];
 
 #endif // RTOS_COMM_H
\ No newline at end of file
@@ -0,0 +1,431 @@
+/**
+ * @file session_store.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the flash-backed inventory session log.
+ * @date 2026-10-14
+ */
+
+#include "session_store.h"
+#include "config.h"
+#include "ble_batch.h"
+#include "log.h"
+#include <LittleFS.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *LOG_PATH = "/session.log";
+static const char *OLD_LOG_PATH = "/session.old";
+static const char *BASE_PATH = "/session.seq"; // Next sequence, kept across clears
+
+/**
+ * @struct SessionRecord
+ * @brief One fixed-size log entry. The check covers every byte before it, so a
+ *        block torn by a power cut is recognized on boot and on reads.
+ */
+struct SessionRecord
+{
+    uint32_t seq;
+    uint8_t flags;
+    uint8_t rssi;
+    uint8_t epcLen;
+    uint8_t tidLen;
+    uint8_t epc[SESSION_STORE_MAX_EPC_BYTES];
+    uint8_t tid[R200_TID_BYTES];
+    uint32_t check;
+};
+
+static_assert(sizeof(SessionRecord) == 40, "SessionRecord layout is stored on flash");
+
+static SemaphoreHandle_t storeMutex = NULL;
+static File logFile;
+static File readFile;           // Kept open between pull chunks
+static const char *readPath = NULL;
+
+// The old file holds [oldFirst, oldEnd), the current one [curFirst, curFirst + curRecords)
+static uint32_t oldFirst = 1;
+static uint32_t oldEnd = 1;
+static uint32_t curFirst = 1;
+static uint32_t curRecords = 0;
+static uint32_t nextSeq = 1;
+
+static SessionRecord pending[SESSION_STORE_FLUSH_RECORDS];
+static uint16_t pendingCount = 0;
+static SessionStoreStats stats = {};
+
+//==============================================================================
+// RECORDS
+//==============================================================================
+
+static uint32_t recordCheck(const SessionRecord &rec)
+{
+    // FNV-1a 32 bits over everything but the check itself
+    const uint8_t *bytes = (const uint8_t *)&rec;
+    uint32_t hash = 0x811C9DC5;
+    for (size_t i = 0; i < offsetof(SessionRecord, check); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+static bool validRecord(const SessionRecord &rec)
+{
+    if (rec.epcLen > SESSION_STORE_MAX_EPC_BYTES || rec.tidLen > R200_TID_BYTES)
+        return false;
+    return rec.check == recordCheck(rec);
+}
+
+//==============================================================================
+// LOG FILES
+//==============================================================================
+
+static void openLog()
+{
+    logFile = LittleFS.open(LOG_PATH, FILE_APPEND);
+    if (!logFile)
+        LOG_E("[Session] Falha ao abrir o log.");
+}
+
+static void closeReader()
+{
+    if (readFile)
+        readFile.close();
+    readPath = NULL;
+}
+
+static void saveBase()
+{
+    File file = LittleFS.open(BASE_PATH, FILE_WRITE);
+    if (file)
+    {
+        file.write((const uint8_t *)&nextSeq, sizeof(nextSeq));
+        file.close();
+    }
+}
+
+static uint32_t loadBase()
+{
+    uint32_t base = 1;
+    File file = LittleFS.open(BASE_PATH, FILE_READ);
+    if (file)
+    {
+        if (file.read((uint8_t *)&base, sizeof(base)) != sizeof(base) || base == 0)
+            base = 1;
+        file.close();
+    }
+    return base;
+}
+
+/**
+ * @brief Current log becomes the old one (the previous old log is dropped) and
+ *        the new one starts at @p first.
+ */
+static void rotateLog(uint32_t first)
+{
+    closeReader();
+    if (logFile)
+        logFile.close();
+    LittleFS.remove(OLD_LOG_PATH);
+    LittleFS.rename(LOG_PATH, OLD_LOG_PATH);
+
+    oldFirst = curFirst;
+    oldEnd = curFirst + curRecords;
+    curFirst = first;
+    curRecords = 0;
+    saveBase();
+    openLog();
+}
+
+/**
+ * @brief Finds the consecutive run of valid records at the start of @p path.
+ *
+ * Only the first and the last records are read: each file holds consecutive
+ * sequences, so the last one tells the length. A tail torn by a power cut
+ * (at most one block) is walked back until a record checks out.
+ *
+ * @param first Sequence of the first record.
+ * @param count Records in the run (0 = missing or unusable file).
+ * @return false if the file does not end on that run (nothing may be appended to it).
+ */
+static bool scanLog(const char *path, uint32_t &first, uint32_t &count)
+{
+    count = 0;
+    if (!LittleFS.exists(path))
+        return true;
+
+    File file = LittleFS.open(path, FILE_READ);
+    if (!file)
+        return false;
+
+    size_t slots = file.size() / sizeof(SessionRecord);
+    bool clean = file.size() % sizeof(SessionRecord) == 0;
+
+    SessionRecord rec;
+    if (slots == 0 || file.read((uint8_t *)&rec, sizeof(rec)) != sizeof(rec) || !validRecord(rec))
+    {
+        file.close();
+        return slots == 0 && clean;
+    }
+    first = rec.seq;
+
+    for (size_t last = slots; last > 0; last--)
+    {
+        file.seek((last - 1) * sizeof(SessionRecord));
+        if (file.read((uint8_t *)&rec, sizeof(rec)) == sizeof(rec) && validRecord(rec) &&
+            rec.seq == first + (last - 1))
+        {
+            count = last;
+            break;
+        }
+        clean = false;
+    }
+
+    file.close();
+    return clean;
+}
+
+static void flushLocked()
+{
+    if (pendingCount == 0)
+        return;
+
+    for (uint16_t i = 0; i < pendingCount; i++)
+    {
+        if (curRecords >= SESSION_STORE_ROTATE_RECORDS)
+            rotateLog(pending[i].seq);
+
+        if (!logFile || logFile.write((const uint8_t *)&pending[i], sizeof(SessionRecord)) != sizeof(SessionRecord))
+        {
+            // Um registro incompleto quebraria a conta posição -> sequência: recomeça
+            // num arquivo novo depois do bloco perdido
+            rotateLog(pending[pendingCount - 1].seq + 1);
+            break;
+        }
+        curRecords++;
+    }
+
+    if (logFile)
+        logFile.flush();
+    pendingCount = 0;
+    stats.flushes++;
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+bool sessionStoreBegin()
+{
+    storeMutex = xSemaphoreCreateMutex();
+    if (!storeMutex)
+        return false;
+
+    // Já montado pelo tag store; formata só se a partição ainda estiver vazia
+    stats.mounted = LittleFS.begin(true);
+    if (!stats.mounted)
+        return false;
+
+    unsigned long start = millis();
+    nextSeq = loadBase();
+
+    // O arquivo antigo não recebe mais nada: vale o trecho válido do começo
+    uint32_t first = 0, count = 0;
+    scanLog(OLD_LOG_PATH, first, count);
+    bool haveOld = count > 0;
+    if (haveOld)
+    {
+        oldFirst = first;
+        oldEnd = first + count;
+        if (oldEnd > nextSeq)
+            nextSeq = oldEnd;
+    }
+
+    bool clean = scanLog(LOG_PATH, first, count);
+    if (count > 0 && (!haveOld || first >= oldEnd))
+    {
+        curFirst = first;
+        curRecords = count;
+    }
+    else
+    {
+        curFirst = nextSeq;
+        curRecords = 0;
+        clean = clean && count == 0;
+    }
+
+    if (curFirst + curRecords > nextSeq)
+        nextSeq = curFirst + curRecords;
+    if (!haveOld)
+        oldFirst = oldEnd = curFirst;
+
+    // Nada pode ser anexado depois de um registro corrompido, senão a posição não daria a sequência
+    if (clean)
+        openLog();
+    else if (curRecords > 0)
+        rotateLog(nextSeq);
+    else
+    {
+        LittleFS.remove(LOG_PATH);
+        openLog();
+    }
+
+    LOG_I("[Session] Leituras %u..%u em %lu ms.", (unsigned)(oldEnd > oldFirst ? oldFirst : curFirst),
+          (unsigned)nextSeq, millis() - start);
+    return true;
+}
+
+uint32_t sessionStoreAppend(const TagReport &report)
+{
+    if (!storeMutex || !stats.mounted)
+        return 0;
+
+    SessionRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.flags = report.flags;
+    rec.rssi = report.tag.rssi;
+    rec.epcLen = report.tag.epcLen;
+    if (rec.epcLen > SESSION_STORE_MAX_EPC_BYTES)
+    {
+        rec.epcLen = SESSION_STORE_MAX_EPC_BYTES;
+        rec.flags |= BLE_BATCH_FLAG_TRUNCATED;
+    }
+    memcpy(rec.epc, report.tag.epc, rec.epcLen);
+    rec.tidLen = report.tid.len;
+    memcpy(rec.tid, report.tid.bytes, rec.tidLen);
+
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    rec.seq = nextSeq++;
+    rec.check = recordCheck(rec);
+    pending[pendingCount++] = rec;
+    if (pendingCount >= SESSION_STORE_FLUSH_RECORDS)
+        flushLocked();
+    xSemaphoreGive(storeMutex);
+
+    return rec.seq;
+}
+
+void sessionStoreFlush()
+{
+    if (!storeMutex)
+        return;
+
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    flushLocked();
+    xSemaphoreGive(storeMutex);
+}
+
+uint16_t sessionStorePending()
+{
+    return pendingCount;
+}
+
+uint16_t sessionStoreRead(uint32_t from, SessionRead *out, uint16_t max)
+{
+    if (!storeMutex || !stats.mounted)
+        return 0;
+
+    uint16_t n = 0;
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+
+    if (from < oldFirst)
+        from = oldFirst;
+
+    while (n < max)
+    {
+        // Buraco entre os arquivos (bloco perdido) ou fim do antigo: segue no atual
+        if (from >= oldEnd && from < curFirst)
+            from = curFirst;
+
+        const char *path;
+        uint32_t base, end;
+        if (from < oldEnd)
+        {
+            path = OLD_LOG_PATH;
+            base = oldFirst;
+            end = oldEnd;
+        }
+        else
+        {
+            path = LOG_PATH;
+            base = curFirst;
+            end = curFirst + curRecords;
+        }
+        if (from >= end)
+            break;
+
+        if (readPath != path)
+        {
+            closeReader();
+            readFile = LittleFS.open(path, FILE_READ);
+            if (!readFile)
+                break;
+            readPath = path;
+        }
+        readFile.seek((from - base) * sizeof(SessionRecord));
+
+        bool bad = false;
+        SessionRecord rec;
+        while (n < max && from < end)
+        {
+            if (readFile.read((uint8_t *)&rec, sizeof(rec)) != sizeof(rec) || !validRecord(rec) || rec.seq != from)
+            {
+                bad = true;
+                break;
+            }
+
+            SessionRead &read = out[n++];
+            read.report = TagReport();
+            read.seq = rec.seq;
+            read.report.flags = rec.flags;
+            read.report.tag.rssi = rec.rssi;
+            read.report.tag.epcLen = rec.epcLen;
+            memcpy(read.report.tag.epc, rec.epc, rec.epcLen);
+            read.report.tid.len = rec.tidLen;
+            memcpy(read.report.tid.bytes, rec.tid, rec.tidLen);
+            from++;
+        }
+        if (bad)
+            break;
+    }
+
+    xSemaphoreGive(storeMutex);
+    return n;
+}
+
+void sessionStoreClear()
+{
+    if (!storeMutex || !stats.mounted)
+        return;
+
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    closeReader();
+    if (logFile)
+        logFile.close();
+    LittleFS.remove(OLD_LOG_PATH);
+    LittleFS.remove(LOG_PATH);
+
+    // Reads still in RAM belong to the session being dropped
+    pendingCount = 0;
+    oldFirst = oldEnd = curFirst = nextSeq;
+    curRecords = 0;
+    saveBase();
+    openLog();
+    xSemaphoreGive(storeMutex);
+}
+
+SessionStoreStats sessionStoreStats()
+{
+    SessionStoreStats snapshot;
+
+    if (storeMutex)
+        xSemaphoreTake(storeMutex, portMAX_DELAY);
+    snapshot = stats;
+    snapshot.first = oldEnd > oldFirst ? oldFirst : curFirst;
+    snapshot.next = nextSeq;
+    snapshot.pending = pendingCount;
+    if (storeMutex)
+        xSemaphoreGive(storeMutex);
+
+    return snapshot;
+}
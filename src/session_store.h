@@ -0,0 +1,95 @@
+/**
+ * @file session_store.h
+ * @author Luis Felipe Patrocinio
+ * @brief Flash-backed inventory session log that the app pulls by sequence cursor.
+ * @date 2026-10-14
+ *
+ * @note Live notifications are fire-and-forget: whatever goes out while the app is
+ *       in the background or the link is down is lost. Every reported read is also
+ *       appended here with a sequence number that only grows (across reboots and
+ *       clears), so after reconnecting the app asks for everything after the last
+ *       sequence it holds instead of rescanning the shelf.
+ *
+ *       Records are fixed-size and checked like the tag store's (see tag_store.h),
+ *       and go to LittleFS in blocks of SESSION_STORE_FLUSH_RECORDS: a power cut
+ *       loses at most the block in RAM. When the log reaches
+ *       SESSION_STORE_ROTATE_RECORDS it becomes the "old" file, so the store always
+ *       holds at least that many of the latest reads. Each file holds consecutive
+ *       sequences, so a cursor maps straight to a file offset.
+ *
+ *       Only the BLE task appends and reads; the mutex covers clears and stats
+ *       requested by the command task.
+ */
+
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include <Arduino.h>
+#include "tag_ring.h"
+
+/** @brief Longest EPC kept per read (longer EPCs are stored truncated and flagged). */
+#define SESSION_STORE_MAX_EPC_BYTES 16
+
+/**
+ * @struct SessionRead
+ * @brief One stored read, as handed back by sessionStoreRead().
+ */
+struct SessionRead
+{
+    uint32_t seq;     ///< Sequence number of the read.
+    TagReport report; ///< EPC, RSSI, TID and BLE_BATCH_FLAG_* bits (no timestamps).
+};
+
+/**
+ * @struct SessionStoreStats
+ * @brief Cursor range and counters since boot.
+ */
+struct SessionStoreStats
+{
+    bool mounted;     ///< false = flash unavailable, reads are not kept.
+    uint32_t first;   ///< Oldest sequence still stored.
+    uint32_t next;    ///< Sequence the next read will get (first == next: empty).
+    uint16_t pending; ///< Reads still in RAM, waiting for the next block write.
+    uint32_t flushes; ///< Block writes since boot.
+};
+
+/**
+ * @brief Finds the stored range and the next sequence. Call once from setup(),
+ *        after tagStoreBegin() (which mounts LittleFS).
+ * @return false if the filesystem is unavailable (appends are then dropped).
+ */
+bool sessionStoreBegin();
+
+/**
+ * @brief Appends one reported read.
+ * @return Its sequence number (0 if the store is unavailable).
+ */
+uint32_t sessionStoreAppend(const TagReport &report);
+
+/** @brief Writes the reads waiting in RAM to flash. */
+void sessionStoreFlush();
+
+/** @brief Reads waiting in RAM. */
+uint16_t sessionStorePending();
+
+/**
+ * @brief Copies stored reads starting at @p from.
+ *
+ * A cursor older than the oldest kept read starts at the oldest one; check the
+ * seq of the first result to see whether reads were lost to rotation. Reads
+ * still in RAM are only visible after sessionStoreFlush().
+ *
+ * @param from First sequence wanted.
+ * @param out Destination.
+ * @param max Capacity of @p out.
+ * @return Number of reads copied (0 = nothing at or after @p from).
+ */
+uint16_t sessionStoreRead(uint32_t from, SessionRead *out, uint16_t max);
+
+/** @brief Drops every stored read; sequence numbers keep counting up. */
+void sessionStoreClear();
+
+/** @brief Snapshot of the cursor range and counters. */
+SessionStoreStats sessionStoreStats();
+
+#endif // SESSION_STORE_H
@@ -0,0 +1,164 @@
+/**
+ * @file tag_dedup.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the time-windowed tag deduplication set.
+ * @date 2026-10-14
+ */
+
+#include "tag_dedup.h"
+
+TagDedup::TagDedup(TagDedupSlot *slots, uint16_t capacity, uint32_t windowMs)
+    : _slots(slots), _mask(capacity - 1), _maxEntries((uint16_t)((capacity / 4) * 3)),
+      _windowMs(windowMs)
+{
+    clear();
+}
+
+void TagDedup::clear()
+{
+    for (uint32_t i = 0; i <= _mask; i++)
+        _slots[i].hash = 0;
+    _count = 0;
+    _head = TAG_DEDUP_NIL;
+    _tail = TAG_DEDUP_NIL;
+}
+
+uint64_t TagDedup::hashKey(const uint8_t *key, size_t length)
+{
+    // FNV-1a 64 bits. Zero is reserved for empty slots.
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= key[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash ? hash : 1;
+}
+
+uint16_t TagDedup::find(uint64_t hash) const
+{
+    uint16_t i = hash & _mask;
+    while (_slots[i].hash != 0)
+    {
+        if (_slots[i].hash == hash)
+            return i;
+        i = (i + 1) & _mask;
+    }
+    return TAG_DEDUP_NIL;
+}
+
+bool TagDedup::checkAndMark(const uint8_t *key, size_t length, uint32_t nowMs)
+{
+    return checkAndMarkHash(hashKey(key, length), nowMs);
+}
+
+bool TagDedup::checkAndMarkHash(uint64_t hash, uint32_t nowMs)
+{
+    prune(nowMs);
+
+    uint16_t i = find(hash);
+    if (i != TAG_DEDUP_NIL)
+    {
+        // Still inside the window (prune() removed anything older): refresh it
+        _slots[i].lastSeen = nowMs;
+        unlink(i);
+        linkHead(i);
+        return true;
+    }
+
+    insert(hash, nowMs);
+    return false;
+}
+
+bool TagDedup::contains(const uint8_t *key, size_t length, uint32_t nowMs)
+{
+    prune(nowMs);
+    return find(hashKey(key, length)) != TAG_DEDUP_NIL;
+}
+
+void TagDedup::prune(uint32_t nowMs)
+{
+    if (_windowMs == 0)
+        return;
+
+    // The tail is the oldest sighting, so expired entries are always there
+    while (_tail != TAG_DEDUP_NIL && nowMs - _slots[_tail].lastSeen >= _windowMs)
+        remove(_tail);
+}
+
+void TagDedup::insert(uint64_t hash, uint32_t nowMs)
+{
+    if (_count >= _maxEntries)
+        remove(_tail); // LRU eviction
+
+    uint16_t i = hash & _mask;
+    while (_slots[i].hash != 0)
+        i = (i + 1) & _mask;
+
+    _slots[i].hash = hash;
+    _slots[i].lastSeen = nowMs;
+    linkHead(i);
+    _count++;
+}
+
+void TagDedup::remove(uint16_t index)
+{
+    unlink(index);
+    _count--;
+
+    // Backward-shift deletion: pull later members of the probe run into the hole
+    // so lookups never need tombstones
+    uint16_t hole = index;
+    uint16_t j = index;
+    for (;;)
+    {
+        j = (j + 1) & _mask;
+        if (_slots[j].hash == 0)
+            break;
+
+        uint16_t home = _slots[j].hash & _mask;
+        bool stays = (hole <= j) ? (hole < home && home <= j) : (hole < home || home <= j);
+        if (stays)
+            continue;
+
+        // Move j into the hole and repoint its LRU neighbours
+        _slots[hole] = _slots[j];
+        if (_slots[hole].prev != TAG_DEDUP_NIL)
+            _slots[_slots[hole].prev].next = hole;
+        else
+            _head = hole;
+        if (_slots[hole].next != TAG_DEDUP_NIL)
+            _slots[_slots[hole].next].prev = hole;
+        else
+            _tail = hole;
+        hole = j;
+    }
+    _slots[hole].hash = 0;
+}
+
+void TagDedup::linkHead(uint16_t index)
+{
+    _slots[index].prev = TAG_DEDUP_NIL;
+    _slots[index].next = _head;
+    if (_head != TAG_DEDUP_NIL)
+        _slots[_head].prev = index;
+    _head = index;
+    if (_tail == TAG_DEDUP_NIL)
+        _tail = index;
+}
+
+void TagDedup::unlink(uint16_t index)
+{
+    uint16_t prev = _slots[index].prev;
+    uint16_t next = _slots[index].next;
+
+    if (prev != TAG_DEDUP_NIL)
+        _slots[prev].next = next;
+    else
+        _head = next;
+
+    if (next != TAG_DEDUP_NIL)
+        _slots[next].prev = prev;
+    else
+        _tail = prev;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file tag_dedup.h
+ * @author Luis Felipe Patrocinio
+ * @brief Fixed-memory hash set that suppresses repeated tag reads within a time window.
+ * @date 2026-10-14
+ */
+
+#ifndef TAG_DEDUP_H
+#define TAG_DEDUP_H
+
+#include <Arduino.h>
+
+/** @brief Marks an unused link in the LRU list. */
+#define TAG_DEDUP_NIL 0xFFFF
+
+/**
+ * @struct TagDedupSlot
+ * @brief One open-addressing slot. Keys are stored as a 64-bit FNV-1a hash of the
+ *        EPC/TID bytes, so a slot costs 16 bytes whatever the key length.
+ */
+struct TagDedupSlot
+{
+    uint64_t hash;     ///< Key hash (0 = empty slot).
+    uint32_t lastSeen; ///< millis() of the most recent sighting.
+    uint16_t prev;     ///< Next more recently seen slot (towards the head).
+    uint16_t next;     ///< Next less recently seen slot (towards the tail).
+};
+
+/**
+ * @class TagDedup
+ * @brief Answers "was this tag seen in the last N ms?" in O(1).
+ *
+ * Linear-probing hash set over caller-provided storage, with an intrusive LRU
+ * list. Every sighting refreshes the entry, so the LRU tail is always the oldest
+ * sighting: expired entries are pruned from the tail and, when the set is full,
+ * the least recently seen tag is evicted to make room.
+ */
+class TagDedup
+{
+public:
+    /**
+     * @param slots Backing storage (not owned).
+     * @param capacity Number of slots; must be a power of two and at most 32768.
+     *        At most 3/4 of them are used, to keep probe sequences short.
+     * @param windowMs Suppression window (0 = entries never expire, only LRU eviction).
+     */
+    TagDedup(TagDedupSlot *slots, uint16_t capacity, uint32_t windowMs);
+
+    /** @brief Changes the suppression window. Existing entries keep their timestamps. */
+    void setWindow(uint32_t windowMs) { _windowMs = windowMs; }
+
+    /** @brief Returns the current suppression window in milliseconds. */
+    uint32_t window() const { return _windowMs; }
+
+    /**
+     * @brief Records a sighting and reports whether it is a repeat.
+     * @param key Tag identifier bytes (EPC or TID).
+     * @param length Number of key bytes.
+     * @param nowMs Current millis().
+     * @return true If the tag was already seen within the window (suppress it).
+     */
+    bool checkAndMark(const uint8_t *key, size_t length, uint32_t nowMs);
+
+    /** @brief Same as checkAndMark() but never records the sighting. */
+    bool contains(const uint8_t *key, size_t length, uint32_t nowMs);
+
+    /** @brief Records a sighting without asking whether it was a repeat. */
+    void mark(const uint8_t *key, size_t length, uint32_t nowMs) { checkAndMark(key, length, nowMs); }
+
+    /**
+     * @brief Records a sighting of a key known only by its hash, as saved from a
+     *        TagDedupSlot (a set persisted without its keys, e.g. the tag store snapshot).
+     */
+    void markHash(uint64_t hash, uint32_t nowMs) { checkAndMarkHash(hash ? hash : 1, nowMs); }
+
+    /** @brief Forgets every tag. */
+    void clear();
+
+    /** @brief Number of tags currently tracked. */
+    uint16_t size() const { return _count; }
+
+private:
+    TagDedupSlot *_slots;
+    uint16_t _mask;
+    uint16_t _maxEntries;
+    uint16_t _count;
+    uint16_t _head; ///< Most recently seen slot.
+    uint16_t _tail; ///< Least recently seen slot.
+    uint32_t _windowMs;
+
+    static uint64_t hashKey(const uint8_t *key, size_t length);
+    bool checkAndMarkHash(uint64_t hash, uint32_t nowMs);
+    uint16_t find(uint64_t hash) const;
+    void prune(uint32_t nowMs);
+    void insert(uint64_t hash, uint32_t nowMs);
+    void remove(uint16_t index);
+    void linkHead(uint16_t index);
+    void unlink(uint16_t index);
+};
+
+#endif // TAG_DEDUP_H
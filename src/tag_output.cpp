@@ -0,0 +1,95 @@
+/**
+ * @file tag_output.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the tag read repeat filter and JSON encoding.
+ * @date 2026-10-14
+ */
+
+#include "tag_output.h"
+#include "config.h"
+#include "log.h"
+#include "tag_dedup.h"
+#include "text_codec.h"
+#include "ble_batch.h"
+
+// Tags já enviadas ao App (TID no modo leitura, EPC no inventário). Uma tag só é
+// reportada de novo depois de TAG_DEDUP_WINDOW_MS fora do campo ou ao soltar o gatilho.
+static TagDedupSlot readFilterSlots[TAG_DEDUP_CAPACITY];
+static TagDedup readFilter(readFilterSlots, TAG_DEDUP_CAPACITY, TAG_DEDUP_WINDOW_MS);
+
+bool tagOutputAccept(const TagReport &report)
+{
+    if (report.endOfSession)
+    {
+        if (readFilter.size() > 0)
+            readFilter.clear();
+        return false;
+    }
+
+    if (report.tid.len > 0)
+        return !readFilter.checkAndMark(report.tid.bytes, report.tid.len, report.tag.timestamp);
+    return !readFilter.checkAndMark(report.tag.epc, report.tag.epcLen, report.tag.timestamp);
+}
+
+void tagOutputSetWindow(uint32_t windowMs)
+{
+    readFilter.setWindow(windowMs);
+}
+
+/**
+ * @brief Copies @p text into @p out as the body of a JSON string ('"' and '\\' escaped).
+ *
+ * Only printable ASCII reaches here (epcToText() and hex), so nothing else needs escaping.
+ */
+static void jsonEscape(const char *text, char *out, size_t outSize)
+{
+    size_t n = 0;
+    for (; *text != '\0' && n + 2 < outSize; text++)
+    {
+        if (*text == '"' || *text == '\\')
+            out[n++] = '\\';
+        out[n++] = *text;
+    }
+    out[n] = '\0';
+}
+
+size_t tagOutputJson(const TagReport &report, char *out, size_t outSize)
+{
+    // Conversão para texto só aqui, na borda de saída, em buffers da pilha
+    char epcHex[2 * R200_MAX_EPC_BYTES + 1];
+    report.tag.epcToHex(epcHex, sizeof(epcHex));
+
+    char decodedText[R200_MAX_EPC_BYTES + 1];
+    size_t textLen = epcToText(report.tag.epc, report.tag.epcLen, decodedText, sizeof(decodedText));
+
+    // Sem texto legível, a App recebe o EPC em hex como dado
+    char data[2 * R200_MAX_EPC_BYTES + 2];
+    jsonEscape(textLen > 0 ? decodedText : epcHex, data, sizeof(data));
+
+    // Mesmo JSON (e ordem de campos) que o ArduinoJson gerava, sem documento no heap
+    int length;
+    if (report.flags & BLE_BATCH_FLAG_INVENTORY)
+    {
+        length = snprintf(out, outSize,
+                          "{\"type\":\"inventoryResult\",\"content\":{\"status\":\"ok\",\"epc\":\"%s\","
+                          "\"rssi\":%u,\"data\":\"%s\"}}",
+                          epcHex, (unsigned)report.tag.rssi, data);
+    }
+    else
+    {
+        char tidHex[2 * R200_TID_BYTES + 1];
+        report.tid.toHex(tidHex, sizeof(tidHex));
+
+        LOG_D(">>> LIDO | TID (Físico): %s | DATA: %s", tidHex, decodedText);
+
+        // A App recebe o UID imutável do chip
+        length = snprintf(out, outSize,
+                          "{\"type\":\"readResult\",\"content\":{\"status\":\"ok\",\"uid\":\"%s\","
+                          "\"rssi\":%u,\"data\":\"%s\"}}",
+                          tidHex, (unsigned)report.tag.rssi, data);
+    }
+
+    if (length < 0 || (size_t)length >= outSize)
+        return 0;
+    return length;
+}
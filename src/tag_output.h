@@ -0,0 +1,41 @@
+/**
+ * @file tag_output.h
+ * @author Luis Felipe Patrocinio
+ * @brief Output side of tag reads: repeat filter and JSON text, run by the BLE task.
+ * @date 2026-10-14
+ *
+ * @note The RFID task only pushes raw TagReport records into the tag ring (see
+ *       tag_ring.h). Deduplication, hex/text conversion and JSON serialization
+ *       all happen here, on the output core, so none of them adds time to a
+ *       poll round or delays the next command on the radio.
+ */
+
+#ifndef TAG_OUTPUT_H
+#define TAG_OUTPUT_H
+
+#include <Arduino.h>
+#include "tag_ring.h"
+
+/**
+ * @brief Filters repeats: a tag (TID in read mode, EPC in inventory) is reported
+ *        again only after the profile's dedup window out of the field or a new session.
+ *
+ * An endOfSession report clears the filter and is never accepted.
+ *
+ * @return true if @p report must be sent to the app.
+ */
+bool tagOutputAccept(const TagReport &report);
+
+/**
+ * @brief Changes the repeat window (reader profile). A single 32-bit store, so
+ *        the RFID task may call it while the BLE task filters.
+ */
+void tagOutputSetWindow(uint32_t windowMs);
+
+/**
+ * @brief Serializes @p report as `readResult` (with TID) or `inventoryResult` JSON.
+ * @return Length written (without the NUL), 0 if it did not fit in @p outSize.
+ */
+size_t tagOutputJson(const TagReport &report, char *out, size_t outSize);
+
+#endif // TAG_OUTPUT_H
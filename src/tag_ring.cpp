@@ -0,0 +1,53 @@
+/**
+ * @file tag_ring.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the SPSC tag report ring.
+ * @date 2026-10-14
+ */
+
+#include "tag_ring.h"
+
+TagRing::TagRing(TagReport *slots, uint16_t capacity)
+    : _slots(slots), _mask(capacity - 1), _head(0), _tail(0), _dropped(0), _highWater(0)
+{
+}
+
+bool TagRing::push(const TagReport &report)
+{
+    uint16_t tail = _tail.load(std::memory_order_relaxed);
+    uint16_t next = (tail + 1) & _mask;
+
+    // Acquire: the consumer is done with the slot before we overwrite it
+    uint16_t head = _head.load(std::memory_order_acquire);
+    if (next == head)
+    {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    _slots[tail] = report;
+    _tail.store(next, std::memory_order_release);
+
+    uint16_t used = (next - head) & _mask;
+    if (used > _highWater)
+        _highWater = used;
+    return true;
+}
+
+bool TagRing::pop(TagReport &report)
+{
+    uint16_t head = _head.load(std::memory_order_relaxed);
+
+    // Acquire: the slot contents written before the producer's release are visible
+    if (head == _tail.load(std::memory_order_acquire))
+        return false;
+
+    report = _slots[head];
+    _head.store((head + 1) & _mask, std::memory_order_release);
+    return true;
+}
+
+uint16_t TagRing::size() const
+{
+    return (_tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire)) & _mask;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file tag_ring.h
+ * @author Luis Felipe Patrocinio
+ * @brief Lock-free single-producer/single-consumer ring that carries tag reads across cores.
+ * @date 2026-10-14
+ *
+ * @note The RFID reader task (radio core) is the only producer and the BLE task
+ *       (output core) the only consumer, so the two indices need no lock: each
+ *       side writes only its own index and publishes it with a release store
+ *       after the slot is written (producer) or read (consumer). A full ring
+ *       drops the new read instead of blocking the radio; the tag answers again
+ *       in the next round.
+ */
+
+#ifndef TAG_RING_H
+#define TAG_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "r200_protocol.h"
+
+/**
+ * @struct TagReport
+ * @brief One tag read handed from the RFID task to the BLE task.
+ */
+struct TagReport
+{
+    R200Tag tag;       ///< EPC, RSSI and timestamp of the read.
+    R200TID tid;       ///< TID (len = 0 if not resolved).
+    uint8_t flags;     ///< BLE_BATCH_FLAG_* bits (see ble_batch.h).
+    bool endOfSession; ///< Trigger released: no tag, the output side forgets what it reported.
+    int64_t originUs;  ///< latencyNow() of the poll cycle that produced the read (0 = none).
+};
+
+/**
+ * @class TagRing
+ * @brief Bounded SPSC FIFO of TagReport over caller-provided storage.
+ */
+class TagRing
+{
+public:
+    /**
+     * @param slots Backing storage (not owned).
+     * @param capacity Number of slots; a power of two. One slot is always left empty.
+     */
+    TagRing(TagReport *slots, uint16_t capacity);
+
+    /**
+     * @brief Producer side: copies @p report into the ring.
+     * @return false (and counts a drop) if the ring is full.
+     */
+    bool push(const TagReport &report);
+
+    /**
+     * @brief Consumer side: takes the oldest report.
+     * @return false if the ring is empty.
+     */
+    bool pop(TagReport &report);
+
+    /** @brief Reports waiting (a snapshot; either side may move it right after). */
+    uint16_t size() const;
+
+    /** @brief Reports dropped because the ring was full. */
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    /** @brief Most reports ever waiting at once. */
+    uint16_t highWater() const { return _highWater; }
+
+private:
+    TagReport *_slots;
+    uint16_t _mask;
+    std::atomic<uint16_t> _head; ///< Next slot to read (written by the consumer only).
+    std::atomic<uint16_t> _tail; ///< Next slot to write (written by the producer only).
+    std::atomic<uint32_t> _dropped;
+    uint16_t _highWater;         ///< Written by the producer only.
+};
+
+#endif // TAG_RING_H
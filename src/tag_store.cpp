@@ -0,0 +1,493 @@
+/**
+ * @file tag_store.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the flash-backed EPC -> TID map and write log.
+ * @date 2026-10-14
+ */
+
+#include "tag_store.h"
+#include "config.h"
+#include "log.h"
+#include "tag_dedup.h"
+#include "tid_cache.h"
+#include <LittleFS.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *LOG_PATH = "/tags.log";
+static const char *OLD_LOG_PATH = "/tags.old";
+
+/** @brief Record kinds; the values are printable so a log dump is readable. */
+enum : uint8_t
+{
+    RECORD_TID = 'T',      ///< A 0x39 read found this TID behind this EPC.
+    RECORD_WRITE = 'W',    ///< This TID was written with this EPC (epcLen 0 = longer than the store keeps).
+    RECORD_AMBIGUOUS = 'A',      ///< This EPC belongs to more than one chip.
+    RECORD_SNAPSHOT = 'S',       ///< A snapshot of the index follows; it replaces everything replayed so far.
+    RECORD_AMBIGUOUS_HASH = 'H'  ///< Snapshot of an ambiguous EPC, kept only as its TagDedup hash (8 bytes in epc).
+};
+
+/**
+ * @struct TagStoreRecord
+ * @brief One fixed-size log entry. The check covers every byte before it, so a
+ *        record torn by a power cut is recognized on replay.
+ */
+struct TagStoreRecord
+{
+    uint8_t type;
+    uint8_t epcLen;
+    uint8_t tidLen;
+    uint8_t reserved;
+    uint8_t epc[TAG_STORE_MAX_EPC_BYTES];
+    uint8_t tid[R200_TID_BYTES];
+    uint32_t check;
+};
+
+static_assert(sizeof(TagStoreRecord) == 36, "TagStoreRecord layout is stored on flash");
+static_assert(TAG_STORE_CAPACITY + TAG_STORE_AMBIGUOUS_CAPACITY + 1 < TAG_STORE_ROTATE_RECORDS,
+              "A fresh log must hold the index snapshot with room to spare");
+
+static TidCacheEntry mapEntries[TAG_STORE_CAPACITY];
+static TidCache epcMap(mapEntries, TAG_STORE_CAPACITY);
+
+// EPCs that must always go through a 0x39 read
+static TagDedupSlot ambiguousSlots[TAG_STORE_AMBIGUOUS_CAPACITY];
+static TagDedup ambiguousEpcs(ambiguousSlots, TAG_STORE_AMBIGUOUS_CAPACITY, 0);
+
+static SemaphoreHandle_t storeMutex = NULL;
+static File logFile;
+static TagStoreStats stats = {};
+
+static TagStoreRecord pending[TAG_STORE_FLUSH_RECORDS];
+static uint16_t pendingCount = 0;
+static unsigned long pendingSince = 0; // millis() do registro mais antigo em RAM
+
+// Replacement order of epcMap: one tick per use, so replayed records rank like live ones
+static uint32_t useClock = 0;
+
+//==============================================================================
+// RECORDS
+//==============================================================================
+
+static uint32_t recordCheck(const TagStoreRecord &rec)
+{
+    // FNV-1a 32 bits over everything but the check itself
+    const uint8_t *bytes = (const uint8_t *)&rec;
+    uint32_t hash = 0x811C9DC5;
+    for (size_t i = 0; i < offsetof(TagStoreRecord, check); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+static bool validRecord(const TagStoreRecord &rec)
+{
+    if (rec.type != RECORD_TID && rec.type != RECORD_WRITE && rec.type != RECORD_AMBIGUOUS &&
+        rec.type != RECORD_SNAPSHOT && rec.type != RECORD_AMBIGUOUS_HASH)
+        return false;
+    if (rec.epcLen > TAG_STORE_MAX_EPC_BYTES || rec.tidLen > R200_TID_BYTES)
+        return false;
+    return rec.check == recordCheck(rec);
+}
+
+static TagStoreRecord makeRecord(uint8_t type, const R200Tag &tag, const R200TID *tid)
+{
+    TagStoreRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = type;
+    if (tag.epcLen <= TAG_STORE_MAX_EPC_BYTES)
+    {
+        rec.epcLen = tag.epcLen;
+        memcpy(rec.epc, tag.epc, tag.epcLen);
+    }
+    if (tid)
+    {
+        rec.tidLen = tid->len;
+        memcpy(rec.tid, tid->bytes, tid->len);
+    }
+    rec.check = recordCheck(rec);
+    return rec;
+}
+
+/**
+ * @brief Applies one record to the RAM index (live and on replay alike).
+ * @return true if the index changed.
+ */
+static bool applyRecord(const TagStoreRecord &rec)
+{
+    if (rec.type == RECORD_SNAPSHOT)
+    {
+        epcMap.clear();
+        ambiguousEpcs.clear();
+        return true;
+    }
+    if (rec.type == RECORD_AMBIGUOUS_HASH)
+    {
+        uint64_t hash;
+        memcpy(&hash, rec.epc, sizeof(hash));
+        ambiguousEpcs.markHash(hash, 0);
+        return true;
+    }
+
+    R200Tag tag;
+    tag.epcLen = rec.epcLen;
+    memcpy(tag.epc, rec.epc, rec.epcLen);
+
+    if (rec.type == RECORD_AMBIGUOUS)
+    {
+        if (ambiguousEpcs.contains(rec.epc, rec.epcLen, 0))
+            return false;
+        ambiguousEpcs.mark(rec.epc, rec.epcLen, 0);
+        epcMap.forget(tag);
+        return true;
+    }
+
+    R200TID tid;
+    tid.len = rec.tidLen;
+    memcpy(tid.bytes, rec.tid, rec.tidLen);
+
+    // Rewritten with an EPC the store does not keep: only the old EPC goes away
+    if (rec.epcLen == 0)
+    {
+        epcMap.forgetTid(tid);
+        return true;
+    }
+
+    if (ambiguousEpcs.contains(rec.epc, rec.epcLen, 0))
+        return false;
+
+    R200TID known;
+    if (epcMap.lookup(tag, known, useClock++))
+    {
+        if (known.equals(tid))
+            return false;
+
+        // Same EPC behind two chips: neither can be told apart by EPC any more
+        ambiguousEpcs.mark(rec.epc, rec.epcLen, 0);
+        epcMap.forget(tag);
+        return true;
+    }
+
+    // The chip no longer carries the EPC it was stored with
+    epcMap.forgetTid(tid);
+    epcMap.store(tag, tid, useClock++);
+    return true;
+}
+
+//==============================================================================
+// LOG FILES
+//==============================================================================
+
+static void openLog()
+{
+    logFile = LittleFS.open(LOG_PATH, FILE_APPEND);
+    if (!logFile)
+        LOG_E("[TagStore] Falha ao abrir o log.");
+}
+
+/** @brief Appends one snapshot record; a short write closes the log so nothing lands after it. */
+static bool writeSnapshotRecord(TagStoreRecord &rec)
+{
+    rec.check = recordCheck(rec);
+    if (logFile && logFile.write((const uint8_t *)&rec, sizeof(rec)) == sizeof(rec))
+    {
+        stats.records++;
+        return true;
+    }
+    if (logFile)
+        logFile.close();
+    LOG_E("[TagStore] Falha ao gravar o retrato do índice.");
+    return false;
+}
+
+/**
+ * @brief Starts a fresh log with the whole RAM index, so its replay never depends
+ *        on history that rotation has deleted.
+ */
+static void writeSnapshot()
+{
+    TagStoreRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = RECORD_SNAPSHOT;
+    bool ok = writeSnapshotRecord(rec);
+
+    // Ambiguous EPCs first: TID records replayed after them are checked against the set
+    for (uint16_t i = 0; ok && i < TAG_STORE_AMBIGUOUS_CAPACITY; i++)
+    {
+        if (ambiguousSlots[i].hash == 0)
+            continue;
+        memset(&rec, 0, sizeof(rec));
+        rec.type = RECORD_AMBIGUOUS_HASH;
+        rec.epcLen = sizeof(uint64_t);
+        memcpy(rec.epc, &ambiguousSlots[i].hash, sizeof(uint64_t));
+        ok = writeSnapshotRecord(rec);
+    }
+
+    // Em ordem de uso, para o replay refazer a mesma ordem de substituição
+    static uint16_t order[TAG_STORE_CAPACITY];
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < TAG_STORE_CAPACITY; i++)
+    {
+        if (mapEntries[i].epcLen == 0 || mapEntries[i].epcLen > TAG_STORE_MAX_EPC_BYTES)
+            continue;
+        uint16_t j = count++;
+        while (j > 0 && (int32_t)(mapEntries[order[j - 1]].lastUsed - mapEntries[i].lastUsed) > 0)
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    for (uint16_t n = 0; ok && n < count; n++)
+    {
+        const TidCacheEntry &entry = mapEntries[order[n]];
+        memset(&rec, 0, sizeof(rec));
+        rec.type = RECORD_TID;
+        rec.epcLen = entry.epcLen;
+        memcpy(rec.epc, entry.epc, entry.epcLen);
+        rec.tidLen = entry.tid.len;
+        memcpy(rec.tid, entry.tid.bytes, entry.tid.len);
+        ok = writeSnapshotRecord(rec);
+    }
+}
+
+/**
+ * @brief Current log becomes the old one (the previous old log is dropped) and the
+ *        new one starts with a snapshot of the index.
+ */
+static void rotateLog()
+{
+    if (logFile)
+        logFile.close();
+    LittleFS.remove(OLD_LOG_PATH);
+    LittleFS.rename(LOG_PATH, OLD_LOG_PATH);
+    stats.records = 0;
+    openLog();
+    writeSnapshot();
+}
+
+static void flushLocked()
+{
+    if (pendingCount == 0)
+        return;
+
+    uint16_t written = 0;
+    bool rotated = false;
+    while (written < pendingCount)
+    {
+        if (stats.records >= TAG_STORE_ROTATE_RECORDS)
+            rotateLog();
+        if (logFile && logFile.write((const uint8_t *)&pending[written], sizeof(TagStoreRecord)) == sizeof(TagStoreRecord))
+        {
+            stats.records++;
+            stats.appended++;
+            written++;
+            continue;
+        }
+
+        // Um registro incompleto pararia o replay nele: o mesmo registro e os seguintes
+        // vão para um arquivo novo. Uma tentativa por bloco; se a flash continuar
+        // falhando, o que sobrou fica em RAM para a próxima gravação
+        if (rotated)
+            break;
+        rotated = true;
+        rotateLog();
+    }
+
+    if (logFile)
+        logFile.flush();
+    pendingCount -= written;
+    memmove(pending, pending + written, pendingCount * sizeof(TagStoreRecord));
+}
+
+static void appendRecord(const TagStoreRecord &rec)
+{
+    if (!stats.mounted)
+        return;
+
+    // Flash falhando e bloco cheio: o índice em RAM já tem o registro, só o log o perde
+    if (pendingCount >= TAG_STORE_FLUSH_RECORDS)
+        return;
+
+    if (pendingCount == 0)
+        pendingSince = millis();
+    pending[pendingCount++] = rec;
+    if (pendingCount >= TAG_STORE_FLUSH_RECORDS)
+        flushLocked();
+}
+
+/**
+ * @brief Applies every valid record of @p path, stopping at the first bad one.
+ * @param torn Set when the file does not end on a valid record.
+ * @return Number of records applied.
+ */
+static uint32_t replayLog(const char *path, bool &torn)
+{
+    torn = false;
+    if (!LittleFS.exists(path))
+        return 0;
+
+    File file = LittleFS.open(path, FILE_READ);
+    if (!file)
+        return 0;
+
+    TagStoreRecord rec;
+    uint32_t count = 0;
+    while (file.read((uint8_t *)&rec, sizeof(rec)) == sizeof(rec))
+    {
+        if (!validRecord(rec))
+        {
+            torn = true;
+            break;
+        }
+        applyRecord(rec);
+        count++;
+    }
+    if (file.position() != file.size())
+        torn = true;
+
+    file.close();
+    return count;
+}
+
+//==============================================================================
+// PUBLIC API
+//==============================================================================
+
+bool tagStoreBegin()
+{
+    storeMutex = xSemaphoreCreateMutex();
+    if (!storeMutex)
+        return false;
+
+    // Formata na primeira inicialização (partição ainda vazia)
+    stats.mounted = LittleFS.begin(true);
+    if (!stats.mounted)
+        return false;
+
+    unsigned long start = millis();
+    bool torn;
+    uint32_t oldRecords = replayLog(OLD_LOG_PATH, torn);
+    stats.records = replayLog(LOG_PATH, torn);
+
+    // Nada pode ser anexado depois de um registro corrompido, senão o replay pararia nele
+    if (torn)
+        rotateLog();
+    else
+        openLog();
+
+    LOG_I("[TagStore] %u registros em %lu ms (%u anteriores a rotação).",
+          (unsigned)(oldRecords + stats.records), millis() - start, (unsigned)oldRecords);
+    return true;
+}
+
+bool tagStoreLookup(const R200Tag &tag, R200TID &tid)
+{
+    if (!storeMutex || tag.epcLen == 0 || tag.epcLen > TAG_STORE_MAX_EPC_BYTES)
+        return false;
+
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    bool hit = !ambiguousEpcs.contains(tag.epc, tag.epcLen, 0) && epcMap.lookup(tag, tid, useClock++);
+    if (hit)
+        stats.hits++;
+    else
+        stats.misses++;
+    xSemaphoreGive(storeMutex);
+    return hit;
+}
+
+void tagStoreRemember(const R200Tag &tag, const R200TID &tid)
+{
+    if (!storeMutex || tag.epcLen == 0 || tag.epcLen > TAG_STORE_MAX_EPC_BYTES || tid.len == 0)
+        return;
+
+    TagStoreRecord rec = makeRecord(RECORD_TID, tag, &tid);
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    if (applyRecord(rec))
+        appendRecord(rec);
+    xSemaphoreGive(storeMutex);
+}
+
+void tagStoreMarkAmbiguous(const R200Tag &tag)
+{
+    if (!storeMutex || tag.epcLen == 0 || tag.epcLen > TAG_STORE_MAX_EPC_BYTES)
+        return;
+
+    TagStoreRecord rec = makeRecord(RECORD_AMBIGUOUS, tag, NULL);
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    if (applyRecord(rec))
+        appendRecord(rec);
+    xSemaphoreGive(storeMutex);
+}
+
+void tagStoreRecordWrite(const R200TID &tid, const R200Tag &written)
+{
+    if (!storeMutex || tid.len == 0)
+        return;
+
+    // Every write is logged, even when the index already had the mapping
+    TagStoreRecord rec = makeRecord(RECORD_WRITE, written, &tid);
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    applyRecord(rec);
+    appendRecord(rec);
+    xSemaphoreGive(storeMutex);
+}
+
+void tagStoreFlush()
+{
+    if (!storeMutex)
+        return;
+
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    flushLocked();
+    xSemaphoreGive(storeMutex);
+}
+
+uint16_t tagStorePending()
+{
+    return pendingCount;
+}
+
+uint32_t tagStorePendingMs()
+{
+    if (pendingCount == 0)
+        return 0;
+    return millis() - pendingSince;
+}
+
+void tagStoreClear()
+{
+    if (!storeMutex)
+        return;
+
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    epcMap.clear();
+    ambiguousEpcs.clear();
+    pendingCount = 0;
+    if (stats.mounted)
+    {
+        if (logFile)
+            logFile.close();
+        LittleFS.remove(OLD_LOG_PATH);
+        LittleFS.remove(LOG_PATH);
+        stats.records = 0;
+        openLog();
+    }
+    xSemaphoreGive(storeMutex);
+}
+
+TagStoreStats tagStoreStats()
+{
+    TagStoreStats snapshot = {};
+    if (!storeMutex)
+        return snapshot;
+
+    xSemaphoreTake(storeMutex, portMAX_DELAY);
+    snapshot = stats;
+    snapshot.ambiguous = ambiguousEpcs.size();
+    xSemaphoreGive(storeMutex);
+    return snapshot;
+}
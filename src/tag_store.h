@@ -0,0 +1,89 @@
+/**
+ * @file tag_store.h
+ * @author Luis Felipe Patrocinio
+ * @brief Flash-backed EPC -> TID map and write log that survive button releases and reboots.
+ * @date 2026-10-14
+ *
+ * @note Every change is appended as a fixed-size record to a LittleFS log and applied
+ *       to an in-RAM index (a TidCache plus a set of ambiguous EPCs); tagStoreBegin()
+ *       rebuilds the index by replaying the log. When the log reaches
+ *       TAG_STORE_ROTATE_RECORDS it becomes the "old" file and a new one is started
+ *       with a snapshot of the whole index (every EPC -> TID pair and every ambiguous
+ *       EPC), so flash use is bounded and dropping the previous old file loses no
+ *       state: the replay of a snapshot replaces everything before it.
+ *
+ *       Records wait in RAM and reach the flash in blocks: the BLE task writes them
+ *       with tagStoreFlush() once the oldest is TAG_STORE_FLUSH_MS old or the trigger
+ *       is released, so the radio core only writes when the block fills up first. A
+ *       power cut loses at most the records in RAM, which were hints anyway.
+ *
+ *       A persisted EPC is a hint, never proof of identity (see tid_cache.h). An EPC
+ *       becomes ambiguous, and is never answered from the store again, when it is
+ *       seen twice in one round, when a fresh TID read disagrees with the stored one,
+ *       or when the write log shows the same payload on two chips.
+ */
+
+#ifndef TAG_STORE_H
+#define TAG_STORE_H
+
+#include <Arduino.h>
+#include "r200_protocol.h"
+
+/** @brief Longest EPC kept in the store (the read and write paths drop longer ones). */
+#define TAG_STORE_MAX_EPC_BYTES 16
+
+/**
+ * @struct TagStoreStats
+ * @brief Counters since boot (records counts the current log file only).
+ */
+struct TagStoreStats
+{
+    bool mounted;       ///< false = flash unavailable, the store works from RAM only.
+    uint32_t records;   ///< Records in the current log file.
+    uint32_t appended;  ///< Records written since boot.
+    uint32_t hits;      ///< Lookups answered from the store.
+    uint32_t misses;    ///< Lookups that fell through to a 0x39 read.
+    uint16_t ambiguous; ///< EPCs currently excluded from lookups.
+};
+
+/**
+ * @brief Mounts LittleFS and replays the log into RAM. Call once from setup().
+ * @return false if the filesystem could not be mounted (the store then stays RAM-only).
+ */
+bool tagStoreBegin();
+
+/**
+ * @brief Looks up the TID last seen with @p tag's EPC.
+ * @return true On a hit; false if unknown or ambiguous.
+ */
+bool tagStoreLookup(const R200Tag &tag, R200TID &tid);
+
+/** @brief Records a fresh 0x39 result for @p tag. Only changes reach the flash. */
+void tagStoreRemember(const R200Tag &tag, const R200TID &tid);
+
+/** @brief Excludes @p tag's EPC from lookups (e.g. it answered twice in one round). */
+void tagStoreMarkAmbiguous(const R200Tag &tag);
+
+/**
+ * @brief Logs that @p tid was written with the EPC in @p written.
+ *
+ * Drops whatever EPC the chip carried before and maps the new one to it.
+ */
+void tagStoreRecordWrite(const R200TID &tid, const R200Tag &written);
+
+/** @brief Writes the records waiting in RAM to flash. */
+void tagStoreFlush();
+
+/** @brief Records waiting in RAM. */
+uint16_t tagStorePending();
+
+/** @brief Age in ms of the oldest record waiting in RAM (0 if none). */
+uint32_t tagStorePendingMs();
+
+/** @brief Erases the log files and the RAM index. */
+void tagStoreClear();
+
+/** @brief Snapshot of the store counters. */
+TagStoreStats tagStoreStats();
+
+#endif // TAG_STORE_H
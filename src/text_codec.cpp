@@ -0,0 +1,58 @@
+/**
+ * @file text_codec.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Conversion between the app's text payload and the hex EPC written to tags.
+ * @date 2026-10-14
+ */
+
+#include "text_codec.h"
+#include "r200_protocol.h"
+
+size_t textToEpc(const char *text, uint8_t *out, size_t outSize)
+{
+    if (outSize > WRITE_PAYLOAD_BYTES)
+        outSize = WRITE_PAYLOAD_BYTES;
+
+    // Preenche com ZEROS (Limpeza) até atingir 96 bits; o que passar disso é cortado
+    size_t n = 0;
+    while (n < outSize && text[n] != '\0')
+    {
+        out[n] = (uint8_t)text[n];
+        n++;
+    }
+    memset(out + n, 0, outSize - n);
+    return outSize;
+}
+
+size_t epcToText(const uint8_t *epc, size_t length, char *out, size_t outSize)
+{
+    if (outSize == 0)
+        return 0;
+
+    size_t n = 0;
+    for (size_t i = 0; i < length && n < outSize - 1; i++)
+    {
+        if (epc[i] >= 32 && epc[i] <= 126)
+            out[n++] = (char)epc[i];
+    }
+    out[n] = '\0';
+    return n;
+}
+
+size_t encodeWritePayload(const char *data, uint8_t *out, size_t outSize)
+{
+    size_t length = 0;
+    while (data[length] != '\0')
+    {
+        if (r200HexValue(data[length]) < 0)
+            return textToEpc(data, out, outSize);
+        length++;
+    }
+
+    // Já é o EPC em hex: completa com zeros à direita até 24 dígitos
+    char hex[2 * WRITE_PAYLOAD_BYTES + 1];
+    for (size_t i = 0; i < 2 * WRITE_PAYLOAD_BYTES; i++)
+        hex[i] = (i < length) ? data[i] : '0';
+    hex[2 * WRITE_PAYLOAD_BYTES] = '\0';
+    return r200HexToBytes(hex, out, outSize);
+}
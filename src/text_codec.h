@@ -0,0 +1,43 @@
+/**
+ * @file text_codec.h
+ * @author Luis Felipe Patrocinio
+ * @brief Conversion between the app's text payload and the hex EPC written to tags.
+ * @date 2026-10-14
+ *
+ * @note Pure helpers with no RTOS dependency, also built by the native test env.
+ *       Every function writes into a caller-provided buffer and never touches the
+ *       heap, so they can run once per tag on the read, write and output paths.
+ */
+
+#ifndef TEXT_CODEC_H
+#define TEXT_CODEC_H
+
+#include <Arduino.h>
+
+/** @brief Size of the EPC written by the write modes (24 hex digits, 96 bits). */
+#define WRITE_PAYLOAD_BYTES 12
+
+/**
+ * @brief Encodes text as EPC bytes, one byte per character, zero-padded/truncated
+ *        to WRITE_PAYLOAD_BYTES (96 bits).
+ * @return Bytes written to @p out (WRITE_PAYLOAD_BYTES unless @p outSize is smaller).
+ */
+size_t textToEpc(const char *text, uint8_t *out, size_t outSize);
+
+/**
+ * @brief Decodes EPC bytes back to text, keeping only printable ASCII characters.
+ * @return Characters written to @p out, which is always NUL-terminated.
+ */
+size_t epcToText(const uint8_t *epc, size_t length, char *out, size_t outSize);
+
+/**
+ * @brief Turns the app's writeData content into the EPC bytes written to tags.
+ *
+ * Hex-only input is taken as the EPC itself (zero-padded/truncated to 24 digits,
+ * so "" clears the chip); anything else goes through textToEpc().
+ *
+ * @return Bytes written to @p out (WRITE_PAYLOAD_BYTES unless @p outSize is smaller).
+ */
+size_t encodeWritePayload(const char *data, uint8_t *out, size_t outSize);
+
+#endif // TEXT_CODEC_H
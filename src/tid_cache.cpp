@@ -0,0 +1,109 @@
+/**
+ * @file tid_cache.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the EPC -> TID cache.
+ * @date 2026-10-14
+ */
+
+#include "tid_cache.h"
+
+TidCache::TidCache(TidCacheEntry *entries, uint16_t capacity)
+    : _entries(entries), _mask(capacity - 1), _hits(0), _misses(0)
+{
+    clear();
+}
+
+void TidCache::clear()
+{
+    for (uint32_t i = 0; i <= _mask; i++)
+        _entries[i].epcLen = 0;
+}
+
+uint16_t TidCache::home(const R200Tag &tag) const
+{
+    // FNV-1a 32 bits over the EPC
+    uint32_t hash = 0x811C9DC5;
+    for (uint8_t i = 0; i < tag.epcLen; i++)
+    {
+        hash ^= tag.epc[i];
+        hash *= 0x01000193;
+    }
+    return hash & _mask;
+}
+
+int TidCache::find(const R200Tag &tag) const
+{
+    if (tag.epcLen == 0)
+        return -1;
+
+    uint16_t start = home(tag);
+    for (uint16_t p = 0; p < TID_CACHE_PROBE_WINDOW; p++)
+    {
+        const TidCacheEntry &e = _entries[(start + p) & _mask];
+        if (e.epcLen == tag.epcLen && memcmp(e.epc, tag.epc, tag.epcLen) == 0)
+            return (start + p) & _mask;
+    }
+    return -1;
+}
+
+bool TidCache::lookup(const R200Tag &tag, R200TID &tid, uint32_t nowMs)
+{
+    int i = find(tag);
+    if (i < 0)
+    {
+        _misses++;
+        return false;
+    }
+
+    _entries[i].lastUsed = nowMs;
+    tid = _entries[i].tid;
+    _hits++;
+    return true;
+}
+
+void TidCache::store(const R200Tag &tag, const R200TID &tid, uint32_t nowMs)
+{
+    if (tag.epcLen == 0 || tag.epcLen > R200_MAX_EPC_BYTES)
+        return;
+
+    int i = find(tag);
+    if (i < 0)
+    {
+        // First empty slot in the window, otherwise the least recently used one
+        uint16_t start = home(tag);
+        i = start;
+        for (uint16_t p = 0; p < TID_CACHE_PROBE_WINDOW; p++)
+        {
+            uint16_t slot = (start + p) & _mask;
+            if (_entries[slot].epcLen == 0)
+            {
+                i = slot;
+                break;
+            }
+            if ((int32_t)(_entries[slot].lastUsed - _entries[i].lastUsed) < 0)
+                i = slot;
+        }
+    }
+
+    TidCacheEntry &e = _entries[i];
+    memcpy(e.epc, tag.epc, tag.epcLen);
+    e.epcLen = tag.epcLen;
+    e.tid = tid;
+    e.lastUsed = nowMs;
+}
+
+void TidCache::forget(const R200Tag &tag)
+{
+    int i = find(tag);
+    if (i >= 0)
+        _entries[i].epcLen = 0;
+}
+
+void TidCache::forgetTid(const R200TID &tid)
+{
+    for (uint32_t i = 0; i <= _mask; i++)
+    {
+        if (_entries[i].epcLen > 0 && _entries[i].tid.equals(tid))
+            _entries[i].epcLen = 0;
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * @file tid_cache.h
+ * @author Luis Felipe Patrocinio
+ * @brief Fixed-memory EPC -> TID cache so known tags skip the TID read.
+ * @date 2026-10-14
+ *
+ * @note An EPC is only a valid key while it is unique in the field. The app often
+ *       writes the same data to many tags, so callers must bypass the cache for
+ *       EPCs seen more than once in the same inventory round, forget() an EPC as
+ *       soon as it is rewritten, and clear() it when the session (trigger press)
+ *       ends, since another tag with the same EPC may be presented next.
+ */
+
+#ifndef TID_CACHE_H
+#define TID_CACHE_H
+
+#include <Arduino.h>
+#include "r200_protocol.h"
+
+/** @brief Slots probed per lookup/insert (bounds both operations). */
+#define TID_CACHE_PROBE_WINDOW 8
+
+/**
+ * @struct TidCacheEntry
+ * @brief One cached EPC and the TID read for it.
+ */
+struct TidCacheEntry
+{
+    uint8_t epc[R200_MAX_EPC_BYTES]; ///< Full EPC (compared byte by byte, no hash collisions).
+    uint8_t epcLen;                  ///< 0 = empty slot.
+    R200TID tid;                     ///< TID resolved for this EPC.
+    uint32_t lastUsed;               ///< millis() of the last hit or store, for replacement.
+};
+
+/**
+ * @class TidCache
+ * @brief Hashed cache over caller-provided storage with LRU replacement inside
+ *        a small probe window.
+ */
+class TidCache
+{
+public:
+    /**
+     * @param entries Backing storage (not owned).
+     * @param capacity Number of entries; must be a power of two >= TID_CACHE_PROBE_WINDOW.
+     */
+    TidCache(TidCacheEntry *entries, uint16_t capacity);
+
+    /**
+     * @brief Looks up the TID of @p tag's EPC.
+     * @return true On a hit (@p tid filled, entry refreshed).
+     */
+    bool lookup(const R200Tag &tag, R200TID &tid, uint32_t nowMs);
+
+    /** @brief Stores or refreshes @p tag's EPC -> @p tid. */
+    void store(const R200Tag &tag, const R200TID &tid, uint32_t nowMs);
+
+    /** @brief Drops @p tag's EPC (e.g. it was just rewritten). */
+    void forget(const R200Tag &tag);
+
+    /** @brief Drops every EPC cached for @p tid (the chip now carries another EPC). Scans all entries. */
+    void forgetTid(const R200TID &tid);
+
+    /** @brief Drops every entry. */
+    void clear();
+
+    /** @brief Cache hits since boot. */
+    uint32_t hits() const { return _hits; }
+
+    /** @brief Cache misses since boot. */
+    uint32_t misses() const { return _misses; }
+
+private:
+    TidCacheEntry *_entries;
+    uint16_t _mask;
+    uint32_t _hits;
+    uint32_t _misses;
+
+    uint16_t home(const R200Tag &tag) const;
+    int find(const R200Tag &tag) const;
+};
+
+#endif // TID_CACHE_H
@@ -0,0 +1,137 @@
+/**
+ * @file trigger.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the interrupt-driven, debounced trigger button.
+ * @date 2026-10-14
+ */
+
+#include "trigger.h"
+#include "config.h"
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+struct TriggerSubscriber
+{
+    TaskHandle_t task;
+    uint32_t events;
+};
+
+static TriggerSubscriber subscribers[TRIGGER_MAX_SUBSCRIBERS];
+static volatile uint8_t subscriberCount = 0;
+
+// Estado reportado e janela de debounce; a ISR e o timer decidem sob o mesmo lock
+static portMUX_TYPE triggerMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool pressed = false;
+static volatile bool settling = false;
+static esp_timer_handle_t settleTimer = NULL;
+
+static inline bool IRAM_ATTR pinPressed()
+{
+    return digitalRead(READ_BUTTON_PIN) == LOW;
+}
+
+/** @brief Level that means "changed" for the current state; also the light sleep wake level. */
+static inline gpio_int_type_t IRAM_ATTR changeLevel()
+{
+    return pressed ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL;
+}
+
+static void IRAM_ATTR onTriggerEdge()
+{
+    bool changed = false;
+
+    portENTER_CRITICAL_ISR(&triggerMux);
+    // Nível ainda ativo: sem desarmar, a interrupção voltaria em seguida
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)READ_BUTTON_PIN, GPIO_INTR_DISABLE);
+    if (!settling && pinPressed() != pressed)
+    {
+        pressed = !pressed;
+        settling = true;
+        changed = true;
+    }
+    else if (!settling)
+        gpio_ll_set_intr_type(&GPIO, (gpio_num_t)READ_BUTTON_PIN, changeLevel()); // Pulso que já passou
+    portEXIT_CRITICAL_ISR(&triggerMux);
+
+    if (!changed)
+        return;
+
+    esp_timer_start_once(settleTimer, TRIGGER_DEBOUNCE_MS * 1000ULL);
+
+    BaseType_t woken = pdFALSE;
+    for (uint8_t i = 0; i < subscriberCount; i++)
+        xTaskNotifyFromISR(subscribers[i].task, subscribers[i].events, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief End of the bounce window (esp_timer task): reports a level that changed
+ *        inside it, or re-arms the interrupt for the next change.
+ */
+static void onSettled(void *arg)
+{
+    bool changed = false;
+
+    portENTER_CRITICAL(&triggerMux);
+    if (pinPressed() != pressed)
+    {
+        // Mudou durante a janela (toque curto): reporta e abre outra janela
+        pressed = !pressed;
+        changed = true;
+    }
+    else
+        settling = false;
+    portEXIT_CRITICAL(&triggerMux);
+
+    if (!changed)
+    {
+        // Interrupção por nível: se o pino mudou depois da amostra, dispara na hora
+        gpio_wakeup_enable((gpio_num_t)READ_BUTTON_PIN, changeLevel());
+        return;
+    }
+
+    esp_timer_start_once(settleTimer, TRIGGER_DEBOUNCE_MS * 1000ULL);
+    for (uint8_t i = 0; i < subscriberCount; i++)
+        xTaskNotify(subscribers[i].task, subscribers[i].events, eSetBits);
+}
+
+bool triggerBegin()
+{
+    esp_timer_create_args_t args = {};
+    args.callback = onSettled;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "trigger";
+    if (esp_timer_create(&args, &settleTimer) != ESP_OK)
+        return false;
+
+    pressed = pinPressed();
+    attachInterrupt(digitalPinToInterrupt(READ_BUTTON_PIN), onTriggerEdge, pressed ? ONHIGH : ONLOW);
+    // Mesmo tipo, com o bit de despertar do light sleep
+    gpio_wakeup_enable((gpio_num_t)READ_BUTTON_PIN, changeLevel());
+    return true;
+}
+
+bool triggerSubscribe(TaskHandle_t task, uint32_t events)
+{
+    bool added = false;
+
+    portENTER_CRITICAL(&triggerMux);
+    if (subscriberCount < TRIGGER_MAX_SUBSCRIBERS)
+    {
+        subscribers[subscriberCount].task = task;
+        subscribers[subscriberCount].events = events;
+        subscriberCount++;
+        added = true;
+    }
+    portEXIT_CRITICAL(&triggerMux);
+
+    return added;
+}
+
+bool triggerPressed()
+{
+    return pressed;
+}
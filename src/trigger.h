@@ -0,0 +1,46 @@
+/**
+ * @file trigger.h
+ * @author Luis Felipe Patrocinio
+ * @brief Interrupt-driven, debounced trigger button with task notifications.
+ * @date 2026-10-14
+ *
+ * @note Leading-edge debounce: the first edge after a quiet period is reported at
+ *       once from the GPIO interrupt, then the interrupt is off for TRIGGER_DEBOUNCE_MS.
+ *       When that window closes an esp_timer samples the pin again and reports the
+ *       level if it differs (e.g. a release inside the bounce window), so a press
+ *       reaches the subscribers within microseconds and no edge is lost for good.
+ *
+ *       The interrupt is a level interrupt armed for the opposite of the reported
+ *       state, which behaves as an edge interrupt but, unlike one, can also wake the
+ *       chip from light sleep (see power_manager.h).
+ *
+ *       Subscribers are woken with xTaskNotify(eSetBits) on every reported change
+ *       and read the level with triggerPressed(); nothing runs while the trigger
+ *       stays in one state.
+ */
+
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <Arduino.h>
+
+/** @brief Tasks that can subscribe to trigger changes. */
+#define TRIGGER_MAX_SUBSCRIBERS 4
+
+/**
+ * @brief Samples the pin and attaches the edge interrupt. Call once from setup(),
+ *        after pinMode(READ_BUTTON_PIN, INPUT_PULLUP).
+ * @return false if the debounce timer could not be created (trigger stays released).
+ */
+bool triggerBegin();
+
+/**
+ * @brief Sets @p events in @p task's notification value on every press and release.
+ * @return false if all TRIGGER_MAX_SUBSCRIBERS slots are taken.
+ */
+bool triggerSubscribe(TaskHandle_t task, uint32_t events);
+
+/** @brief Debounced trigger state: true while pressed. */
+bool triggerPressed();
+
+#endif // TRIGGER_H
@@ -5,53 +5,215 @@
 /**
  * @file ui_handler.cpp
  * @author Luis Felipe Patrocinio
- * @brief Implementation of user interface feedback tasks (LED and Buzzer).
+ * @brief Implementation of the UI feedback engine (buzzer patterns and LED).
  * @date 2025-08-26
  */
 
 #include "ui_handler.h"
 #include "rtos_comm.h"
+#include "trigger.h"
+#include <esp_pm.h>
 
 //==============================================================================
-// BUZZER TASK
+// TONE PATTERNS
 //==============================================================================
-void buzzerTask(void *parameter)
+
+/** @brief One step of a pattern: the buzzer at @p hz (0 = silent) for @p ms. */
+struct ToneStep
 {
-    for (;;)
+    uint16_t hz;
+    uint16_t ms;
+};
+
+struct TonePattern
+{
+    const ToneStep *steps;
+    uint8_t count;
+};
+
+static const ToneStep singleSteps[] = {{BUZZER_TONE_HZ, 100}};
+static const ToneStep doubleSteps[] = {{BUZZER_TONE_HZ, 60}, {0, 60}, {BUZZER_TONE_HZ, 60}};
+static const ToneStep errorSteps[] = {{BUZZER_ERROR_TONE_HZ, 250}, {0, 80}, {BUZZER_ERROR_TONE_HZ, 250}};
+static const ToneStep tickSteps[] = {{BUZZER_TONE_HZ, 15}};
+
+// Na ordem de UiPattern
+static const TonePattern patterns[UI_PATTERN_COUNT] = {
+    {singleSteps, sizeof(singleSteps) / sizeof(singleSteps[0])},
+    {doubleSteps, sizeof(doubleSteps) / sizeof(doubleSteps[0])},
+    {errorSteps, sizeof(errorSteps) / sizeof(errorSteps[0])},
+    {tickSteps, sizeof(tickSteps) / sizeof(tickSteps[0])},
+};
+
+//==============================================================================
+// PATTERN QUEUE
+//==============================================================================
+static TaskHandle_t uiTaskHandle = NULL;
+
+// Contadores livres: qualquer task avança head, só a task de UI avança tail
+static uint8_t queued[UI_PATTERN_QUEUE_LEN];
+static uint32_t head = 0;
+static uint32_t tail = 0;
+static bool playing = false;     // Um padrão está tocando (escrito pela task de UI)
+static uint32_t lastTickAt = 0;
+static portMUX_TYPE uiMux = portMUX_INITIALIZER_UNLOCKED;
+
+void uiNotify(uint32_t events)
+{
+    if (uiTaskHandle)
+        xTaskNotify(uiTaskHandle, events, eSetBits);
+}
+
+void uiPlay(UiPattern pattern)
+{
+    if (!soundEnabled || pattern >= UI_PATTERN_COUNT)
+        return;
+
+    uint32_t now = millis();
+    bool accepted = false;
+    portENTER_CRITICAL(&uiMux);
+    if (pattern == UI_PATTERN_TICK)
     {
-        // Wait indefinitely for a signal to beep
-        if (xSemaphoreTake(buzzerSemaphore, portMAX_DELAY) == pdTRUE)
+        // Tick só com o buzzer livre e fora do intervalo mínimo; os demais se fundem
+        if (!playing && head == tail && now - lastTickAt >= UI_TICK_INTERVAL_MS)
         {
-            if (soundEnabled)
-            {
-                digitalWrite(BUZZER_PIN, HIGH);
-                vTaskDelay(pdMS_TO_TICKS(100));
-                digitalWrite(BUZZER_PIN, LOW);
-            }
+            lastTickAt = now;
+            accepted = true;
         }
     }
+    else
+        accepted = head - tail < UI_PATTERN_QUEUE_LEN;
+    if (accepted)
+        queued[head++ % UI_PATTERN_QUEUE_LEN] = pattern;
+    portEXIT_CRITICAL(&uiMux);
+
+    if (accepted)
+        uiNotify(UI_EVENT_PATTERN);
+}
+
+/** @brief Takes the next queued pattern and marks the buzzer busy. */
+static bool nextPattern(uint8_t &pattern)
+{
+    portENTER_CRITICAL(&uiMux);
+    playing = head != tail;
+    if (playing)
+        pattern = queued[tail++ % UI_PATTERN_QUEUE_LEN];
+    portEXIT_CRITICAL(&uiMux);
+    return playing;
 }
 
 //==============================================================================
-// LED STATUS TASK
+// BUZZER OUTPUT (LEDC)
 //==============================================================================
-void ledTask(void *parameter)
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t toneLock = NULL;
+#endif
+
+/** @brief Sounds @p hz (0 = silent). An active buzzer only follows on/off. */
+static void buzzerTone(uint16_t hz)
+{
+    if (BUZZER_PASSIVE)
+        ledcWriteTone(BUZZER_LEDC_CHANNEL, hz);
+    else
+        ledcWrite(BUZZER_LEDC_CHANNEL, hz ? 255 : 0); // 255 em 8 bits = nível alto contínuo
+}
+
+/** @brief Keeps the chip out of light sleep while a pattern plays (LEDC stops in it). */
+static void holdAwake(bool hold)
 {
+    static bool held = false;
+    if (hold == held)
+        return;
+    held = hold;
+#if CONFIG_PM_ENABLE
+    if (!toneLock)
+        return;
+    if (hold)
+        esp_pm_lock_acquire(toneLock);
+    else
+        esp_pm_lock_release(toneLock);
+#endif
+}
+
+//==============================================================================
+// UI TASK
+//==============================================================================
+
+/** @brief Sounds @p s and returns the tick at which it ends. */
+static TickType_t startStep(const ToneStep &s, TickType_t now)
+{
+    buzzerTone(s.hz);
+    return now + pdMS_TO_TICKS(s.ms);
+}
+
+void uiTask(void *parameter)
+{
+    uiTaskHandle = xTaskGetCurrentTaskHandle();
+    triggerSubscribe(uiTaskHandle, UI_EVENT_TRIGGER);
+
+    ledcSetup(BUZZER_LEDC_CHANNEL, BUZZER_TONE_HZ, 8);
+    ledcAttachPin(BUZZER_PIN, BUZZER_LEDC_CHANNEL);
+    buzzerTone(0);
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "ui", &toneLock);
+#endif
+
+    const TonePattern *pattern = NULL;
+    uint8_t step = 0;
+    TickType_t stepEnd = 0;
+
+    bool blinkOn = false;
+    TickType_t nextToggle = xTaskGetTickCount();
+
     for (;;)
     {
+        TickType_t now = xTaskGetTickCount();
+
+        // Buzzer: o passo acabou -> próximo passo; os passos acabaram -> próximo padrão
+        if (pattern && (int32_t)(now - stepEnd) >= 0)
+        {
+            if (++step < pattern->count)
+                stepEnd = startStep(pattern->steps[step], now);
+            else
+                pattern = NULL;
+        }
+        if (!pattern)
+        {
+            uint8_t next;
+            if (nextPattern(next))
+            {
+                holdAwake(true);
+                pattern = &patterns[next];
+                step = 0;
+                stepEnd = startStep(pattern->steps[0], now);
+            }
+            else
+            {
+                buzzerTone(0);
+                holdAwake(false);
+            }
+        }
+
+        TickType_t wait = portMAX_DELAY;
         if (!bluetoothConnected)
         {
-            // Slow blink when disconnected
-            digitalWrite(LED_PIN, HIGH);
-            vTaskDelay(pdMS_TO_TICKS(250));
-            digitalWrite(LED_PIN, LOW);
-            vTaskDelay(pdMS_TO_TICKS(250));
+            // Slow blink when disconnected; trigger events do not change its pace
+            if ((int32_t)(now - nextToggle) >= 0)
+            {
+                blinkOn = !blinkOn;
+                digitalWrite(LED_PIN, blinkOn ? HIGH : LOW);
+                nextToggle = now + pdMS_TO_TICKS(250);
+            }
+            wait = nextToggle - now;
         }
         else
         {
-            // LED reflects read button state when connected
-            digitalWrite(LED_PIN, (digitalRead(READ_BUTTON_PIN) == LOW) ? HIGH : LOW);
-            vTaskDelay(pdMS_TO_TICKS(50));
+            // LED reflects the trigger when connected
+            digitalWrite(LED_PIN, triggerPressed() ? HIGH : LOW);
         }
+
+        // Sleeps until the next step, blink, trigger edge, link change or pattern
+        if (pattern && stepEnd - now < wait)
+            wait = stepEnd - now;
+        xTaskNotifyWait(0, UINT32_MAX, NULL, wait);
     }
-}
\ No newline at end of file
+}
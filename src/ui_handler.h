@@ -1,23 +1,61 @@
 /**
  * @file ui_handler.h
  * @author Luis Felipe Patrocinio
- * @brief Prototypes for user interface feedback tasks (LED and Buzzer).
+ * @brief Event-driven UI feedback engine: buzzer tone patterns and the status LED.
  * @date 2025-08-26
+ *
+ * @note A single task owns the buzzer and the LED. Producers queue a pattern with
+ *       uiPlay() and return at once; the task plays the queue step by step on the
+ *       LEDC channel, sleeping on its notifications until the next step ends, so
+ *       back-to-back confirmations queue up instead of merging into one beep and
+ *       no caller ever sleeps for a beep.
+ *
+ *       Inventory reads use UI_PATTERN_TICK, which is rate-limited to one per
+ *       UI_TICK_INTERVAL_MS and only plays on an idle buzzer: a burst of reads
+ *       sounds like a steady ticking and never backs up the queue.
  */
 
 #ifndef UI_HANDLER_H
 #define UI_HANDLER_H
 
+#include <stdint.h>
+
+/** @brief UI task event: the trigger was pressed or released. */
+#define UI_EVENT_TRIGGER (1u << 0)
+
+/** @brief UI task event: a BLE client connected or disconnected. */
+#define UI_EVENT_LINK (1u << 1)
+
+/** @brief UI task event: a pattern was queued (see uiPlay()). */
+#define UI_EVENT_PATTERN (1u << 2)
+
+/** @brief Buzzer patterns. */
+enum UiPattern
+{
+    UI_PATTERN_SINGLE, ///< One beep: a read, a command ack.
+    UI_PATTERN_DOUBLE, ///< Two short beeps: a tag written.
+    UI_PATTERN_ERROR,  ///< Two long low beeps: a failed write or command.
+    UI_PATTERN_TICK,   ///< Short click, rate-limited: inventory reads.
+    UI_PATTERN_COUNT
+};
+
 /**
- * @brief FreeRTOS task to provide audible feedback via the buzzer.
- * @param parameter Unused task parameter.
+ * @brief Queues @p pattern for the buzzer. Never blocks; safe from any task.
+ *
+ * Dropped while the sound is off, when the queue is full, or (ticks only) when
+ * the buzzer is busy or the last tick is too recent.
  */
-void buzzerTask(void *parameter);
+void uiPlay(UiPattern pattern);
 
 /**
- * @brief FreeRTOS task to provide visual feedback via the status LED.
+ * @brief FreeRTOS task that plays the buzzer patterns and drives the status LED.
  * @param parameter Unused task parameter.
  */
-void ledTask(void *parameter);
+void uiTask(void *parameter);
+
+/**
+ * @brief Wakes the UI task with @p events (UI_EVENT_* bits). Safe from any task.
+ */
+void uiNotify(uint32_t events);
 
-#endif // UI_HANDLER_H
\ No newline at end of file
+#endif // UI_HANDLER_H
@@ -0,0 +1,81 @@
+/**
+ * @file write_target.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Implementation of the write target picker.
+ * @date 2026-10-14
+ */
+
+#include "write_target.h"
+#include "power_control.h"
+
+WriteTargetPicker::WriteTargetPicker(int8_t floorDbm, uint8_t marginDb)
+    : _floorDbm(floorDbm), _marginDb(marginDb), _count(0)
+{
+}
+
+void WriteTargetPicker::beginRound()
+{
+    _count = 0;
+}
+
+void WriteTargetPicker::observe(const R200Tag &tag)
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (_tags[i].epcLen == tag.epcLen && memcmp(_tags[i].epc, tag.epc, tag.epcLen) == 0)
+        {
+            if (rssiDbm(tag.rssi) > rssiDbm(_tags[i].rssi))
+                _tags[i] = tag;
+            return;
+        }
+    }
+
+    if (_count < WRITE_TARGET_CANDIDATES)
+    {
+        _tags[_count++] = tag;
+        return;
+    }
+
+    // Full: the weakest candidate makes way for a stronger one
+    uint8_t weakest = 0;
+    for (uint8_t i = 1; i < _count; i++)
+        if (rssiDbm(_tags[i].rssi) < rssiDbm(_tags[weakest].rssi))
+            weakest = i;
+    if (rssiDbm(tag.rssi) > rssiDbm(_tags[weakest].rssi))
+        _tags[weakest] = tag;
+}
+
+int8_t WriteTargetPicker::strongestIndex(int8_t skip) const
+{
+    int8_t best = -1;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if ((int8_t)i == skip)
+            continue;
+        if (best < 0 || rssiDbm(_tags[i].rssi) > rssiDbm(_tags[best].rssi))
+            best = i;
+    }
+    return best;
+}
+
+uint8_t WriteTargetPicker::lead() const
+{
+    int8_t first = strongestIndex(-1);
+    int8_t second = strongestIndex(first);
+    if (second < 0)
+        return 0;
+    return rssiDbm(_tags[first].rssi) - rssiDbm(_tags[second].rssi);
+}
+
+WriteTargetVerdict WriteTargetPicker::pick(R200Tag &target) const
+{
+    int8_t first = strongestIndex(-1);
+    if (first < 0 || rssiDbm(_tags[first].rssi) < _floorDbm)
+        return WRITE_TARGET_NONE;
+
+    if (strongestIndex(first) >= 0 && lead() < _marginDb)
+        return WRITE_TARGET_AMBIGUOUS;
+
+    target = _tags[first];
+    return WRITE_TARGET_PICKED;
+}
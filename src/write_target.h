@@ -0,0 +1,75 @@
+/**
+ * @file write_target.h
+ * @author Luis Felipe Patrocinio
+ * @brief Picks the tag a single write goes to from one short poll round.
+ * @date 2026-10-14
+ *
+ * @note Writing to "the first tag that answers" hits a neighbour whenever two tags
+ *       are in reach, and every retry after that is wasted air time. The picker
+ *       collects the whole round, keeps the strongest notice of each EPC and only
+ *       names a target when it stands at least a margin above the runner-up.
+ *       Neighbours below the RSSI floor still count as runner-up: a tag just under
+ *       the floor is as likely to take the write as one just above it.
+ *
+ *       An ambiguous round writes nothing; the power controller sees the same
+ *       round and steps down, so the next one usually leaves a single tag in reach.
+ */
+
+#ifndef WRITE_TARGET_H
+#define WRITE_TARGET_H
+
+#include <Arduino.h>
+#include "r200_protocol.h"
+
+/** @brief Distinct EPCs kept per round; the weakest is dropped when full. */
+#define WRITE_TARGET_CANDIDATES 8
+
+/** @brief Outcome of a round. */
+enum WriteTargetVerdict
+{
+    WRITE_TARGET_NONE,      ///< No tag at or above the RSSI floor.
+    WRITE_TARGET_PICKED,    ///< One tag stands out; it is the target.
+    WRITE_TARGET_AMBIGUOUS  ///< The top two are within the margin; do not write.
+};
+
+/**
+ * @class WriteTargetPicker
+ * @brief Per-round ranking of the write candidates by RSSI.
+ */
+class WriteTargetPicker
+{
+public:
+    /**
+     * @param floorDbm RSSI below which a tag cannot be the target.
+     * @param marginDb How far (dB) the target must stand above the runner-up.
+     */
+    WriteTargetPicker(int8_t floorDbm, uint8_t marginDb);
+
+    /** @brief Starts collecting a new poll round. */
+    void beginRound();
+
+    /** @brief Feeds one tag notice of the round (repeats of an EPC keep the strongest). */
+    void observe(const R200Tag &tag);
+
+    /**
+     * @brief Ranks the round.
+     * @param target Filled with the strongest tag when the verdict is WRITE_TARGET_PICKED.
+     */
+    WriteTargetVerdict pick(R200Tag &target) const;
+
+    /** @brief Distinct EPCs heard in the round. */
+    uint8_t candidates() const { return _count; }
+
+    /** @brief dB between the top two of the round (0 with fewer than two tags). */
+    uint8_t lead() const;
+
+private:
+    int8_t _floorDbm;
+    uint8_t _marginDb;
+    R200Tag _tags[WRITE_TARGET_CANDIDATES];
+    uint8_t _count;
+
+    int8_t strongestIndex(int8_t skip) const;
+};
+
+#endif // WRITE_TARGET_H
@@ -0,0 +1,168 @@
+/**
+ * @file Arduino.h
+ * @author Luis Felipe Patrocinio
+ * @brief Minimal host stand-in for the Arduino core, used by the native test env.
+ * @date 2026-10-14
+ *
+ * @note Only what the pure modules (r200_protocol, text_codec, bulk_job...) need: fixed-width
+ *       types, a std::string-backed String, a controllable millis() and a
+ *       HardwareSerial whose RX side is fed by the test. The serial keeps its bytes
+ *       in a fixed ring so it never allocates and does not skew allocation counts.
+ */
+
+#ifndef MOCK_ARDUINO_H
+#define MOCK_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+
+#define HEX 16
+#define DEC 10
+
+//==============================================================================
+// TIME
+//==============================================================================
+
+/** @brief Host clock in ms; tests move it explicitly. */
+extern uint32_t mockMillis;
+
+inline uint32_t millis() { return mockMillis; }
+
+//==============================================================================
+// STRING
+//==============================================================================
+class String
+{
+public:
+    String() {}
+    String(const char *s) : _s(s ? s : "") {}
+    String(const std::string &s) : _s(s) {}
+    explicit String(char c) : _s(1, c) {}
+    String(int value, unsigned char base = DEC)
+    {
+        char buf[34];
+        if (base == DEC)
+            snprintf(buf, sizeof(buf), "%d", value);
+        else
+            toBase((unsigned int)value, base, buf);
+        _s = buf;
+    }
+    String(unsigned int value, unsigned char base = DEC)
+    {
+        char buf[34];
+        toBase(value, base, buf);
+        _s = buf;
+    }
+    String(unsigned long value, unsigned char base = DEC) : String((unsigned int)value, base) {}
+
+    unsigned int length() const { return _s.length(); }
+    const char *c_str() const { return _s.c_str(); }
+    char charAt(unsigned int i) const { return i < _s.length() ? _s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    bool isEmpty() const { return _s.empty(); }
+    int indexOf(const char *s) const
+    {
+        size_t pos = _s.find(s);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    void toUpperCase()
+    {
+        for (char &c : _s)
+            c = toupper((unsigned char)c);
+    }
+    String substring(unsigned int from) const { return substring(from, _s.length()); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        if (from > _s.length())
+            return String();
+        if (to > _s.length())
+            to = _s.length();
+        return String(_s.substr(from, to > from ? to - from : 0));
+    }
+
+    String &operator+=(const String &o) { _s += o._s; return *this; }
+    String &operator+=(const char *o) { _s += o; return *this; }
+    String &operator+=(char c) { _s += c; return *this; }
+    bool operator==(const String &o) const { return _s == o._s; }
+    bool operator==(const char *o) const { return _s == o; }
+    friend String operator+(const String &a, const String &b) { return String(a._s + b._s); }
+
+private:
+    std::string _s;
+
+    static void toBase(unsigned int value, unsigned char base, char *out)
+    {
+        char tmp[33];
+        int n = 0;
+        do
+        {
+            unsigned int d = value % base;
+            tmp[n++] = d < 10 ? '0' + d : 'a' + d - 10;
+            value /= base;
+        } while (value);
+        for (int i = 0; i < n; i++)
+            out[i] = tmp[n - 1 - i];
+        out[n] = '\0';
+    }
+};
+
+//==============================================================================
+// SERIAL
+//==============================================================================
+
+/**
+ * @class HardwareSerial
+ * @brief UART stand-in: the test injects what the R200 "sends", the code reads it.
+ */
+class HardwareSerial
+{
+public:
+    /** @brief Queues bytes as if they arrived from the module (drops on overflow). */
+    size_t inject(const uint8_t *data, size_t length)
+    {
+        size_t n = 0;
+        while (n < length && _count < sizeof(_rx))
+        {
+            _rx[(_head + _count) % sizeof(_rx)] = data[n++];
+            _count++;
+        }
+        return n;
+    }
+
+    int available() const { return (int)_count; }
+
+    int read()
+    {
+        if (_count == 0)
+            return -1;
+        uint8_t b = _rx[_head];
+        _head = (_head + 1) % sizeof(_rx);
+        _count--;
+        return b;
+    }
+
+    /** @brief Commands written by the driver; the last ones are kept for inspection. */
+    size_t write(const uint8_t *data, size_t length)
+    {
+        _txLen = length < sizeof(_tx) ? length : sizeof(_tx);
+        memcpy(_tx, data, _txLen);
+        return length;
+    }
+
+    const uint8_t *lastWrite() const { return _tx; }
+    size_t lastWriteLength() const { return _txLen; }
+
+private:
+    uint8_t _rx[65536];
+    size_t _head = 0;
+    size_t _count = 0;
+    uint8_t _tx[256];
+    size_t _txLen = 0;
+};
+
+#endif // MOCK_ARDUINO_H
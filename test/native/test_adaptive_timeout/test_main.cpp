@@ -0,0 +1,60 @@
+/**
+ * @file test_main.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Host tests for the adaptive response window.
+ * @date 2026-10-14
+ *
+ * @note Run with `pio test -e native -v`.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "adaptive_timeout.h"
+
+uint32_t mockMillis = 0;
+
+void setUp() {}
+void tearDown() {}
+
+void test_adaptive_timeout_follows_latency()
+{
+    AdaptiveTimeout window(800, 40, 800);
+    TEST_ASSERT_EQUAL(800, window.timeout());
+
+    // Respostas estáveis de ~20 ms: a janela encolhe até o piso
+    for (int i = 0; i < 40; i++)
+        window.sample(20);
+    TEST_ASSERT_EQUAL(20, window.smoothed());
+    TEST_ASSERT_EQUAL(40, window.timeout());
+
+    // Sem resposta: dobra a cada expiração, até o teto
+    window.expired();
+    TEST_ASSERT_EQUAL(80, window.timeout());
+    for (int i = 0; i < 10; i++)
+        window.expired();
+    TEST_ASSERT_EQUAL(800, window.timeout());
+
+    // Uma medida volta a valer imediatamente
+    window.sample(20);
+    TEST_ASSERT_TRUE(window.timeout() < 100);
+}
+
+void test_adaptive_timeout_jitter_widens_window()
+{
+    AdaptiveTimeout window(800, 10, 800);
+    for (int i = 0; i < 40; i++)
+        window.sample((i % 2) ? 10 : 70);
+
+    // Média ~40 ms, mas a variação empurra a janela bem acima dela
+    TEST_ASSERT_TRUE(window.timeout() > 100);
+    TEST_ASSERT_TRUE(window.timeout() < 250);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_adaptive_timeout_follows_latency);
+    RUN_TEST(test_adaptive_timeout_jitter_widens_window);
+    return UNITY_END();
+}
@@ -0,0 +1,132 @@
+/**
+ * @file test_main.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Host tests for the bulk encoding job.
+ * @date 2026-10-14
+ *
+ * @note Run with `pio test -e native -v`.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "bulk_job.h"
+
+uint32_t mockMillis = 0;
+
+static TagDedupSlot doneSlots[BULK_DONE_TID_CAPACITY];
+static BulkJob job(doneSlots, BULK_DONE_TID_CAPACITY);
+
+void setUp() { job.clear(); }
+void tearDown() {}
+
+static R200TID makeTid(uint8_t id)
+{
+    R200TID tid;
+    memset(tid.bytes, 0, sizeof(tid.bytes));
+    tid.bytes[11] = id;
+    tid.len = R200_TID_BYTES;
+    return tid;
+}
+
+//==============================================================================
+// BULK JOB
+//==============================================================================
+void test_template_payloads()
+{
+    TEST_ASSERT_TRUE(job.addTemplate("BOX-{n}", 7, 3, 3));
+    TEST_ASSERT_EQUAL(3, job.total());
+    TEST_ASSERT_EQUAL(BULK_RUNNING, job.state());
+
+    // Mesma codificação do writeData: "BOX-008" em texto
+    uint8_t expected[WRITE_PAYLOAD_BYTES];
+    encodeWritePayload("BOX-008", expected, sizeof(expected));
+
+    R200Tag payload;
+    job.payloadAt(1, payload);
+    TEST_ASSERT_EQUAL(WRITE_PAYLOAD_BYTES, payload.epcLen);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, payload.epc, WRITE_PAYLOAD_BYTES);
+
+    // Não cabe: nada é acrescentado
+    TEST_ASSERT_FALSE(job.addTemplate("X{n}", 0, BULK_JOB_CAPACITY, 0));
+    TEST_ASSERT_EQUAL(3, job.total());
+}
+
+void test_classify_and_progress()
+{
+    job.addItem("SKU1");
+    job.addItem("SKU2");
+
+    R200Tag blank;
+    memset(blank.epc, 0xE2, 12);
+    blank.epcLen = 12;
+    TEST_ASSERT_EQUAL(BULK_TAG_NEW, job.classify(blank));
+
+    R200Tag payload;
+    TEST_ASSERT_EQUAL(0, job.nextPayload(payload));
+
+    // Tag que já carrega o segundo payload (job retomado): confirmar, não gravar
+    R200Tag second;
+    job.payloadAt(1, second);
+    TEST_ASSERT_EQUAL(1, job.classify(second));
+
+    job.markAttempt(1000);
+    job.markDone(1, makeTid(1), 1200);
+    TEST_ASSERT_EQUAL(BULK_TAG_DONE, job.classify(second));
+    TEST_ASSERT_EQUAL(0, job.nextPayload(payload));
+
+    job.markDone(0, makeTid(2), 1500);
+    TEST_ASSERT_EQUAL(-1, job.nextPayload(payload));
+    TEST_ASSERT_EQUAL(BULK_DONE, job.state());
+    TEST_ASSERT_EQUAL(500, job.elapsedMs(9999));
+}
+
+void test_duplicate_payloads()
+{
+    job.addItem("SAME");
+    job.addItem("SAME");
+
+    R200Tag same;
+    job.payloadAt(0, same);
+    TEST_ASSERT_EQUAL(0, job.classify(same));
+
+    // O primeiro chip confirmado ocupa o índice 0; o mesmo EPC agora aponta o 1
+    job.markDone(0, makeTid(1), 0);
+    TEST_ASSERT_EQUAL(1, job.classify(same));
+
+    // ... e só o TID diz se é o mesmo chip de novo
+    TEST_ASSERT_TRUE(job.doneTid(makeTid(1)));
+    TEST_ASSERT_FALSE(job.doneTid(makeTid(2)));
+}
+
+void test_longer_epc_matches_payload_prefix()
+{
+    job.addItem("E2001122");
+
+    R200Tag tag;
+    job.payloadAt(0, tag);
+    tag.epc[12] = 0xAB;
+    tag.epc[13] = 0xCD;
+    tag.epcLen = 14;
+    TEST_ASSERT_EQUAL(0, job.classify(tag));
+}
+
+void test_cancel()
+{
+    job.addItem("SKU1");
+    job.markAttempt(100);
+    job.cancel(400);
+    TEST_ASSERT_EQUAL(BULK_CANCELLED, job.state());
+    TEST_ASSERT_EQUAL(300, job.elapsedMs(1000));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_template_payloads);
+    RUN_TEST(test_classify_and_progress);
+    RUN_TEST(test_duplicate_payloads);
+    RUN_TEST(test_longer_epc_matches_payload_prefix);
+    RUN_TEST(test_cancel);
+    return UNITY_END();
+}
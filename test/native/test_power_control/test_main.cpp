@@ -0,0 +1,118 @@
+/**
+ * @file test_main.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Host tests for the nearest-tag transmit power controller.
+ * @date 2026-10-14
+ *
+ * @note Run with `pio test -e native -v`.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "config.h"
+#include "power_control.h"
+
+uint32_t mockMillis = 0;
+
+void setUp() {}
+void tearDown() {}
+
+static bool round1(PowerController &ctrl, int8_t strongest)
+{
+    ctrl.beginRound();
+    ctrl.observe(strongest);
+    return ctrl.endRound();
+}
+
+void test_rssi_byte_is_signed_dbm()
+{
+    TEST_ASSERT_EQUAL(-62, rssiDbm(0xC2));
+    TEST_ASSERT_EQUAL(-128, rssiDbm(0x80));
+}
+
+void test_neighbour_close_to_strongest_lowers_power()
+{
+    PowerController ctrl(TX_POWER_MIN_DBM, TX_POWER_MAX_DBM, 20, RSSI_NEAREST_MIN_DBM);
+
+    // Duas tags a 2 dB uma da outra: não dá para saber qual é a da mão
+    ctrl.beginRound();
+    ctrl.observe(-50);
+    ctrl.observe(-52);
+    TEST_ASSERT_TRUE(ctrl.endRound());
+    TEST_ASSERT_EQUAL(20 - TX_POWER_STEP_DB, ctrl.power());
+
+    // Vizinha abaixo do filtro não conta como colisão
+    ctrl.beginRound();
+    ctrl.observe(-50);
+    ctrl.observe(RSSI_NEAREST_MIN_DBM - 1);
+    TEST_ASSERT_FALSE(ctrl.endRound());
+    TEST_ASSERT_FALSE(ctrl.accepts(RSSI_NEAREST_MIN_DBM - 1));
+}
+
+void test_loud_tag_lowers_weak_tag_raises()
+{
+    PowerController ctrl(TX_POWER_MIN_DBM, TX_POWER_MAX_DBM, 20, RSSI_NEAREST_MIN_DBM);
+
+    // Tag colada na antena: desce até o piso
+    for (int i = 0; i < 40; i++)
+        round1(ctrl, -30);
+    TEST_ASSERT_EQUAL(TX_POWER_MIN_DBM, ctrl.power());
+
+    // Tag fraca (mas aceita): sobe até o teto
+    for (int i = 0; i < 40; i++)
+        round1(ctrl, -68);
+    TEST_ASSERT_EQUAL(TX_POWER_MAX_DBM, ctrl.power());
+
+    // Dentro da faixa alvo: fica onde está
+    uint32_t before = ctrl.adjustments();
+    for (int i = 0; i < 10; i++)
+        round1(ctrl, -52);
+    TEST_ASSERT_EQUAL(before, ctrl.adjustments());
+}
+
+void test_empty_rounds_raise_power()
+{
+    PowerController ctrl(TX_POWER_MIN_DBM, TX_POWER_MAX_DBM, 20, RSSI_NEAREST_MIN_DBM);
+
+    for (int i = 0; i < TX_POWER_EMPTY_ROUNDS - 1; i++)
+    {
+        ctrl.beginRound();
+        TEST_ASSERT_FALSE(ctrl.endRound());
+    }
+    ctrl.beginRound();
+    ctrl.observe(-85); // Só tags abaixo do filtro: rodada vazia
+    TEST_ASSERT_TRUE(ctrl.endRound());
+    TEST_ASSERT_EQUAL(20 + TX_POWER_STEP_DB, ctrl.power());
+}
+
+void test_lower_ceiling_caps_power_at_once()
+{
+    PowerController ctrl(TX_POWER_MIN_DBM, TX_POWER_MAX_DBM, TX_POWER_MAX_DBM, RSSI_NEAREST_MIN_DBM);
+
+    ctrl.setMaxPower(20);
+    TEST_ASSERT_EQUAL(20, ctrl.power());
+
+    // Rodadas vazias não passam do novo teto
+    for (int i = 0; i < 4 * TX_POWER_EMPTY_ROUNDS; i++)
+    {
+        ctrl.beginRound();
+        ctrl.endRound();
+    }
+    TEST_ASSERT_EQUAL(20, ctrl.power());
+
+    // Teto abaixo do piso vira o piso
+    ctrl.setMaxPower(0);
+    TEST_ASSERT_EQUAL(TX_POWER_MIN_DBM, ctrl.power());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rssi_byte_is_signed_dbm);
+    RUN_TEST(test_neighbour_close_to_strongest_lowers_power);
+    RUN_TEST(test_loud_tag_lowers_weak_tag_raises);
+    RUN_TEST(test_empty_rounds_raise_power);
+    RUN_TEST(test_lower_ceiling_caps_power_at_once);
+    return UNITY_END();
+}
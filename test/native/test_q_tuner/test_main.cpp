@@ -0,0 +1,96 @@
+/**
+ * @file test_main.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Host tests for the inventory Q tuner.
+ * @date 2026-10-14
+ *
+ * @note Run with `pio test -e native -v`.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "q_tuner.h"
+
+uint32_t mockMillis = 0;
+
+static TagDedupSlot seenSlots[512];
+static QTuner tuner(1, 8, 500, seenSlots, 512);
+static uint32_t now = 0;
+
+void setUp()
+{
+    now = 0;
+    tuner.begin(4, now);
+}
+void tearDown() {}
+
+/** @brief One window in which @p population distinct tags answer @p repeats times each. */
+static bool window(uint16_t population, uint16_t repeats, uint32_t emptyRounds)
+{
+    for (uint16_t r = 0; r < repeats; r++)
+        for (uint16_t i = 0; i < population; i++)
+        {
+            uint8_t epc[12] = {0xE2, 0x00};
+            epc[10] = i >> 8;
+            epc[11] = i & 0xFF;
+            tuner.onReply(epc, sizeof(epc), now);
+        }
+    now += 500;
+    TEST_ASSERT_TRUE(tuner.windowDone(now));
+    return tuner.endWindow(emptyRounds, now);
+}
+
+void test_large_population_raises_q()
+{
+    // 100 tags: o quadro certo é 2^7 = 128 slots, um passo por janela
+    TEST_ASSERT_TRUE(window(100, 3, 0));
+    TEST_ASSERT_EQUAL(5, tuner.q());
+    TEST_ASSERT_EQUAL(600, tuner.repliesPerSec());
+    TEST_ASSERT_EQUAL(100, tuner.population());
+
+    window(100, 3, 0);
+    window(100, 3, 0);
+    TEST_ASSERT_EQUAL(7, tuner.q());
+    TEST_ASSERT_FALSE(window(100, 3, 0));
+    TEST_ASSERT_EQUAL(7, tuner.q());
+}
+
+void test_small_population_lowers_q_with_hysteresis()
+{
+    // Q = 4 (16 slots) com 5 tags: alvo 3, mas só desce abaixo de um quarto do quadro
+    TEST_ASSERT_FALSE(window(5, 2, 0));
+    TEST_ASSERT_EQUAL(4, tuner.q());
+
+    // 2 tags: alvo 1
+    TEST_ASSERT_TRUE(window(2, 2, 0));
+    TEST_ASSERT_EQUAL(3, tuner.q());
+    TEST_ASSERT_TRUE(window(2, 2, 0));
+    TEST_ASSERT_EQUAL(2, tuner.q());
+    TEST_ASSERT_FALSE(window(2, 2, 0));
+
+    // Ninguém respondeu: campo vazio ou colisão total, o Q fica
+    TEST_ASSERT_FALSE(window(0, 0, 30));
+    TEST_ASSERT_EQUAL(2, tuner.q());
+}
+
+void test_empty_rounds_with_tags_mean_collisions()
+{
+    // 8 tags cabem em Q = 3/4, mas ciclos vazios indicam colisões: sobe
+    TEST_ASSERT_TRUE(window(8, 1, 12));
+    TEST_ASSERT_EQUAL(5, tuner.q());
+
+    // Uma tag sozinha com ciclos vazios só saiu do alcance por instantes
+    tuner.begin(1, now);
+    TEST_ASSERT_FALSE(window(1, 4, 3));
+    TEST_ASSERT_EQUAL(1, tuner.q());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_large_population_raises_q);
+    RUN_TEST(test_small_population_lowers_q_with_hysteresis);
+    RUN_TEST(test_empty_rounds_with_tags_mean_collisions);
+    return UNITY_END();
+}
@@ -0,0 +1,75 @@
+/**
+ * @file captures.h
+ * @author Luis Felipe Patrocinio
+ * @brief R200 TX-line byte streams replayed by the native protocol tests.
+ * @date 2026-10-14
+ *
+ * @note To add a capture, paste the hex dump of the module's TX line (logic
+ *       analyzer or a USB-UART sniffer at 115200 8N1) as another array and add a
+ *       replay case in test_main.cpp.
+ */
+
+#ifndef CAPTURES_H
+#define CAPTURES_H
+
+#include <stdint.h>
+
+// Notice 0x22: RSSI C9, PC 3000, EPC E28069152000501D1A2B3C4D, CRC 1F7C
+static const uint8_t captureNoticeA[] = {
+    0xAA, 0x02, 0x22, 0x00, 0x11, 0xC9, 0x30, 0x00, 0xE2, 0x80, 0x69, 0x15,
+    0x20, 0x00, 0x50, 0x1D, 0x1A, 0x2B, 0x3C, 0x4D, 0x1F, 0x7C, 0x04, 0xDD};
+
+// Notice 0x22: EPC written by the app ("SENYAR13021" as text)
+static const uint8_t captureNoticeB[] = {
+    0xAA, 0x02, 0x22, 0x00, 0x11, 0xC2, 0x30, 0x00, 0x53, 0x45, 0x4E, 0x59,
+    0x41, 0x52, 0x31, 0x33, 0x30, 0x32, 0x31, 0x00, 0x8A, 0x33, 0xAD, 0xDD};
+
+// Notice 0x22 whose EPC and CRC are full of 0xAA/0xDD (header/end values)
+static const uint8_t captureNoticeMarkers[] = {
+    0xAA, 0x02, 0x22, 0x00, 0x11, 0xB5, 0x30, 0x00, 0xE2, 0x00, 0xAA, 0xDD,
+    0x10, 0xDD, 0x00, 0xAA, 0x01, 0x02, 0xDD, 0xAA, 0xDD, 0xAA, 0x2B, 0xDD};
+
+// Error frame: inventory found no tag (0x15)
+static const uint8_t captureNoTag[] = {0xAA, 0x01, 0xFF, 0x00, 0x01, 0x15, 0x16, 0xDD};
+
+// Response 0x39 (TID bank): UL 0E, PC 3000, EPC of captureNoticeA, TID E28011052000743A9B0C1204
+static const uint8_t captureTidResponse[] = {
+    0xAA, 0x01, 0x39, 0x00, 0x1B, 0x0E, 0x30, 0x00, 0xE2, 0x80, 0x69, 0x15,
+    0x20, 0x00, 0x50, 0x1D, 0x1A, 0x2B, 0x3C, 0x4D, 0xE2, 0x80, 0x11, 0x05,
+    0x20, 0x00, 0x74, 0x3A, 0x9B, 0x0C, 0x12, 0x04, 0xD1, 0xDD};
+
+// Multi-poll burst: three notices and a "no tag" round back to back, no gaps
+static const uint8_t captureBurst[] = {
+    0xAA, 0x02, 0x22, 0x00, 0x11, 0xC9, 0x30, 0x00, 0xE2, 0x80, 0x69, 0x15,
+    0x20, 0x00, 0x50, 0x1D, 0x1A, 0x2B, 0x3C, 0x4D, 0x1F, 0x7C, 0x04, 0xDD,
+    0xAA, 0x02, 0x22, 0x00, 0x11, 0xC2, 0x30, 0x00, 0x53, 0x45, 0x4E, 0x59,
+    0x41, 0x52, 0x31, 0x33, 0x30, 0x32, 0x31, 0x00, 0x8A, 0x33, 0xAD, 0xDD,
+    0xAA, 0x01, 0xFF, 0x00, 0x01, 0x15, 0x16, 0xDD,
+    0xAA, 0x02, 0x22, 0x00, 0x11, 0xB5, 0x30, 0x00, 0xE2, 0x00, 0xAA, 0xDD,
+    0x10, 0xDD, 0x00, 0xAA, 0x01, 0x02, 0xDD, 0xAA, 0xDD, 0xAA, 0x2B, 0xDD};
+
+// Line noise at power-up, a frame with a bad End byte, then a good notice
+static const uint8_t captureNoiseBadEnd[] = {
+    0x00, 0xFF, 0x13, 0xDD,
+    0xAA, 0x01, 0xFF, 0x00, 0x01, 0x15, 0x16, 0x00,
+    0xAA, 0x02, 0x22, 0x00, 0x11, 0xC9, 0x30, 0x00, 0xE2, 0x80, 0x69, 0x15,
+    0x20, 0x00, 0x50, 0x1D, 0x1A, 0x2B, 0x3C, 0x4D, 0x1F, 0x7C, 0x04, 0xDD};
+
+// Impossible PL (0x0400) followed by a good error frame
+static const uint8_t captureOversizedLength[] = {
+    0xAA, 0x02, 0x22, 0x04, 0x00,
+    0xAA, 0x01, 0xFF, 0x00, 0x01, 0x15, 0x16, 0xDD};
+
+// Notice cut short (byte loss on the line), immediately followed by a good notice
+static const uint8_t captureTruncated[] = {
+    0xAA, 0x02, 0x22, 0x00, 0x11, 0xC9, 0x30, 0x00, 0xE2, 0x80, 0x69,
+    0xAA, 0x02, 0x22, 0x00, 0x11, 0xC2, 0x30, 0x00, 0x53, 0x45, 0x4E, 0x59,
+    0x41, 0x52, 0x31, 0x33, 0x30, 0x32, 0x31, 0x00, 0x8A, 0x33, 0xAD, 0xDD};
+
+// Notice with a corrupted RSSI byte (checksum no longer matches), then a good error frame
+static const uint8_t captureBadChecksum[] = {
+    0xAA, 0x02, 0x22, 0x00, 0x11, 0xC8, 0x30, 0x00, 0xE2, 0x80, 0x69, 0x15,
+    0x20, 0x00, 0x50, 0x1D, 0x1A, 0x2B, 0x3C, 0x4D, 0x1F, 0x7C, 0x04, 0xDD,
+    0xAA, 0x01, 0xFF, 0x00, 0x01, 0x15, 0x16, 0xDD};
+
+#endif // CAPTURES_H
@@ -0,0 +1,520 @@
+/**
+ * @file test_main.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Host replay tests and benchmark for the R200 protocol layer.
+ * @date 2026-10-14
+ *
+ * @note Run with `pio test -e native -v` (-v shows the benchmark report).
+ *       Captures are replayed through the mock HardwareSerial and drained exactly
+ *       like R200Driver::uartTaskLoop() does, in randomly sized chunks.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+
+#include "r200_protocol.h"
+#include "text_codec.h"
+#include "captures.h"
+
+uint32_t mockMillis = 0;
+
+//==============================================================================
+// ALLOCATION COUNTING
+//==============================================================================
+static volatile size_t allocationCount = 0;
+
+void *operator new(size_t size)
+{
+    allocationCount++;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+//==============================================================================
+// REPLAY
+//==============================================================================
+static HardwareSerial uart;
+static R200FrameDecoder decoder;
+
+#define MAX_REPLAY_FRAMES 16
+static R200Frame frames[MAX_REPLAY_FRAMES];
+
+/** @brief Deterministic chunk sizes (xorshift) so failures reproduce. */
+static uint32_t nextRandom(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+ * @brief Injects @p capture in chunks of 1..maxChunk bytes, draining after each one.
+ * @return Number of frames decoded (the first MAX_REPLAY_FRAMES are kept in frames[]).
+ */
+static size_t replay(const uint8_t *capture, size_t length, size_t maxChunk, uint32_t seed = 1)
+{
+    size_t count = 0;
+    size_t sent = 0;
+    R200Frame frame;
+
+    while (sent < length)
+    {
+        size_t chunk = 1 + nextRandom(seed) % maxChunk;
+        if (chunk > length - sent)
+            chunk = length - sent;
+        uart.inject(capture + sent, chunk);
+        sent += chunk;
+        mockMillis++;
+
+        while (uart.available())
+        {
+            decoder.push(uart.read());
+            while (decoder.next(frame, millis()))
+            {
+                if (count < MAX_REPLAY_FRAMES)
+                    frames[count] = frame;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+void setUp()
+{
+    decoder = R200FrameDecoder();
+    while (uart.available())
+        uart.read();
+}
+
+void tearDown() {}
+
+//==============================================================================
+// FRAME BUILDING
+//==============================================================================
+void test_build_frame_checksum()
+{
+    // Single Polling do datasheet: AA 00 22 00 00 22 DD
+    static const uint8_t expected[] = {0xAA, 0x00, 0x22, 0x00, 0x00, 0x22, 0xDD};
+    uint8_t out[R200_COMMAND_MAX_PARAMS + 7];
+
+    TEST_ASSERT_EQUAL(sizeof(expected), r200BuildFrame(0x00, 0x22, NULL, 0, out));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out, sizeof(expected));
+}
+
+void test_build_frame_roundtrip()
+{
+    uint8_t params[] = {0x22, 0x27, 0x10};
+    uint8_t out[R200_COMMAND_MAX_PARAMS + 7];
+    size_t length = r200BuildFrame(0x00, 0x27, params, sizeof(params), out);
+
+    TEST_ASSERT_EQUAL(1, replay(out, length, 4));
+    TEST_ASSERT_EQUAL_HEX8(0x27, frames[0].cmd);
+    TEST_ASSERT_EQUAL(3, frames[0].paramLen);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(params, frames[0].params, sizeof(params));
+}
+
+void test_build_select_params()
+{
+    // Exemplo do datasheet: Select do EPC 30751FEB705C5904E3D50D70
+    static const uint8_t expected[] = {0x01, 0x00, 0x00, 0x00, 0x20, 0x60, 0x00, 0x30, 0x75, 0x1F,
+                                       0xEB, 0x70, 0x5C, 0x59, 0x04, 0xE3, 0xD5, 0x0D, 0x70};
+    R200Tag tag;
+    memcpy(tag.epc, &expected[7], 12);
+    tag.epcLen = 12;
+
+    uint8_t out[R200_COMMAND_MAX_PARAMS];
+    TEST_ASSERT_EQUAL(sizeof(expected), r200BuildSelectParams(tag, out));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out, sizeof(expected));
+}
+
+void test_build_select_params_refuses_full_epc()
+{
+    R200Tag tag;
+    memset(tag.epc, 0xA5, sizeof(tag.epc));
+    uint8_t out[R200_COMMAND_MAX_PARAMS];
+
+    // 32 bytes = 256 bits: o MaskLen de um byte daria 0, e a máscara vazia casa todas as tags
+    tag.epcLen = R200_MAX_EPC_BYTES;
+    TEST_ASSERT_EQUAL(0, r200BuildSelectParams(tag, out));
+
+    tag.epcLen = 0;
+    TEST_ASSERT_EQUAL(0, r200BuildSelectParams(tag, out));
+
+    // O maior que cabe: 31 bytes = 248 bits
+    tag.epcLen = R200_SELECT_MAX_MASK_BYTES;
+    TEST_ASSERT_EQUAL(7 + R200_SELECT_MAX_MASK_BYTES, r200BuildSelectParams(tag, out));
+    TEST_ASSERT_EQUAL(248, out[5]);
+}
+
+void test_build_tid_select_params()
+{
+    static const uint8_t expected[] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x60, 0x00, 0xE2, 0x80, 0x11,
+                                       0x05, 0x20, 0x00, 0x74, 0x1A, 0x0B, 0x3C, 0x09, 0x5D};
+    R200TID tid;
+    memcpy(tid.bytes, &expected[7], 12);
+    tid.len = 12;
+
+    uint8_t out[R200_COMMAND_MAX_PARAMS];
+    TEST_ASSERT_EQUAL(sizeof(expected), r200BuildTidSelectParams(tid, out));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out, sizeof(expected));
+}
+
+void test_build_write_params()
+{
+    // Senha 00000000, banco EPC, Word 2, 6 Words
+    static const uint8_t data[12] = {0x53, 0x45, 0x4E, 0x59, 0x41, 0x52, 0x31, 0x33, 0x30, 0x32, 0x31, 0x00};
+    static const uint8_t header[] = {0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x06};
+
+    uint8_t out[R200_COMMAND_MAX_PARAMS];
+    TEST_ASSERT_EQUAL(sizeof(header) + sizeof(data), r200BuildWriteParams(0, 0x01, 2, data, sizeof(data), out));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(header, out, sizeof(header));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, &out[sizeof(header)], sizeof(data));
+}
+
+void test_query_params_roundtrip()
+{
+    // Exemplo do manual: 0x1020 = DR 8, FM0, TRext, Sel todas, S0, Target A, Q = 4
+    R200QueryParams query = r200UnpackQuery(0x1020);
+    TEST_ASSERT_EQUAL(0, query.dr);
+    TEST_ASSERT_EQUAL(0, query.m);
+    TEST_ASSERT_TRUE(query.trext);
+    TEST_ASSERT_EQUAL(0, query.sel);
+    TEST_ASSERT_EQUAL(0, query.session);
+    TEST_ASSERT_EQUAL(0, query.target);
+    TEST_ASSERT_EQUAL(4, query.q);
+
+    query.session = 1;
+    query.target = 1;
+    query.q = 7;
+    TEST_ASSERT_EQUAL_HEX16(0x11B8, r200PackQuery(query));
+    TEST_ASSERT_EQUAL(7, r200UnpackQuery(r200PackQuery(query)).q);
+}
+
+//==============================================================================
+// DECODER
+//==============================================================================
+void test_single_notice()
+{
+    TEST_ASSERT_EQUAL(1, replay(captureNoticeA, sizeof(captureNoticeA), sizeof(captureNoticeA)));
+
+    R200Tag tag;
+    TEST_ASSERT_TRUE(r200ParseTagNotice(frames[0], tag));
+    TEST_ASSERT_EQUAL_HEX8(0xC9, tag.rssi);
+    TEST_ASSERT_EQUAL_HEX16(0x3000, tag.pc);
+    TEST_ASSERT_EQUAL(12, tag.epcLen);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&captureNoticeA[8], tag.epc, 12);
+
+    char hex[2 * R200_MAX_EPC_BYTES + 1];
+    tag.epcToHex(hex, sizeof(hex));
+    TEST_ASSERT_EQUAL_STRING("E28069152000501D1A2B3C4D", hex);
+}
+
+void test_fragmented_chunks()
+{
+    // Mesma captura em pedaços de 1 a 3 bytes, várias sementes
+    for (uint32_t seed = 1; seed < 50; seed++)
+    {
+        setUp();
+        TEST_ASSERT_EQUAL(4, replay(captureBurst, sizeof(captureBurst), 3, seed));
+    }
+}
+
+void test_back_to_back_burst()
+{
+    TEST_ASSERT_EQUAL(4, replay(captureBurst, sizeof(captureBurst), sizeof(captureBurst)));
+    TEST_ASSERT_EQUAL_HEX8(0x22, frames[0].cmd);
+    TEST_ASSERT_EQUAL_HEX8(0x22, frames[1].cmd);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, frames[2].cmd);
+    TEST_ASSERT_EQUAL_HEX8(0x15, frames[2].params[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x22, frames[3].cmd);
+}
+
+void test_epc_with_marker_bytes()
+{
+    // 0xAA e 0xDD dentro do EPC não podem abrir nem fechar frames
+    TEST_ASSERT_EQUAL(1, replay(captureNoticeMarkers, sizeof(captureNoticeMarkers), 5));
+
+    R200Tag tag;
+    TEST_ASSERT_TRUE(r200ParseTagNotice(frames[0], tag));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&captureNoticeMarkers[8], tag.epc, 12);
+}
+
+void test_noise_and_bad_end()
+{
+    TEST_ASSERT_EQUAL(1, replay(captureNoiseBadEnd, sizeof(captureNoiseBadEnd), 6));
+    TEST_ASSERT_EQUAL_HEX8(0x22, frames[0].cmd);
+    TEST_ASSERT_EQUAL(4 + 8, decoder.stats().discardedBytes); // 4 de ruído + os 8 do frame ruim
+    TEST_ASSERT_EQUAL(1, decoder.stats().framingErrors);
+}
+
+void test_oversized_length()
+{
+    TEST_ASSERT_EQUAL(1, replay(captureOversizedLength, sizeof(captureOversizedLength), 2));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, frames[0].cmd);
+    TEST_ASSERT_EQUAL(1, decoder.stats().framingErrors);
+}
+
+void test_truncated_then_good()
+{
+    // O frame cortado engole o início do seguinte; quando o 0xDD não aparece na
+    // posição, a busca recomeça no 0xAA do frame bom, que já está no buffer
+    for (uint32_t seed = 1; seed < 20; seed++)
+    {
+        setUp();
+        TEST_ASSERT_EQUAL(1, replay(captureTruncated, sizeof(captureTruncated), 4, seed));
+        TEST_ASSERT_EQUAL_HEX8(0xC2, frames[0].params[0]);
+    }
+}
+
+void test_bad_checksum_rejected()
+{
+    TEST_ASSERT_EQUAL(1, replay(captureBadChecksum, sizeof(captureBadChecksum), 5));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, frames[0].cmd);
+    TEST_ASSERT_EQUAL(1, decoder.stats().checksumErrors);
+}
+
+void test_resync_on_header_inside_bad_frame()
+{
+    // Frame ruim cujo payload contém um frame completo: a ressincronização o encontra
+    uint8_t stream[64];
+    size_t n = 0;
+    static const uint8_t badStart[] = {0xAA, 0x02, 0x22, 0x00, 0x0A};
+    memcpy(stream, badStart, sizeof(badStart));
+    n += sizeof(badStart);
+    memcpy(stream + n, captureNoTag, sizeof(captureNoTag));
+    n += sizeof(captureNoTag);
+    // Resto do frame ruim (PL 0x0A = 17 bytes no total): o End não é 0xDD
+    while (n < 17)
+        stream[n++] = 0x00;
+
+    TEST_ASSERT_EQUAL(1, replay(stream, n, n));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, frames[0].cmd);
+    TEST_ASSERT_EQUAL_HEX8(0x15, frames[0].params[0]);
+}
+
+void test_tag_notice_rejects_short_frame()
+{
+    R200Frame frame = {};
+    frame.type = 0x02;
+    frame.cmd = 0x22;
+    frame.paramLen = 4;
+
+    R200Tag tag;
+    TEST_ASSERT_FALSE(r200ParseTagNotice(frame, tag));
+    TEST_ASSERT_FALSE(tag.valid);
+}
+
+//==============================================================================
+// TID
+//==============================================================================
+void test_tid_response()
+{
+    TEST_ASSERT_EQUAL(1, replay(captureTidResponse, sizeof(captureTidResponse), 7));
+
+    // EPC que o chip devolveu junto com o TID (o da captureNoticeA)
+    R200Tag expected;
+    memcpy(expected.epc, &captureNoticeA[8], 12);
+    expected.epcLen = 12;
+
+    R200TID tid;
+    TEST_ASSERT_TRUE(r200ParseTidResponse(frames[0], tid, &expected));
+    TEST_ASSERT_EQUAL(R200_TID_BYTES, tid.len);
+
+    char hex[2 * R200_TID_BYTES + 1];
+    tid.toHex(hex, sizeof(hex));
+    TEST_ASSERT_EQUAL_STRING("E28011052000743A9B0C1204", hex);
+}
+
+void test_tid_cross_talk_rejected()
+{
+    replay(captureTidResponse, sizeof(captureTidResponse), sizeof(captureTidResponse));
+
+    // A tag esperada é outra (EPC de captureNoticeB)
+    R200Tag other;
+    memcpy(other.epc, &captureNoticeB[8], 12);
+    other.epcLen = 12;
+
+    R200TID tid;
+    TEST_ASSERT_FALSE(r200ParseTidResponse(frames[0], tid, &other));
+    TEST_ASSERT_EQUAL(0, tid.len);
+}
+
+void test_access_responder()
+{
+    replay(captureTidResponse, sizeof(captureTidResponse), sizeof(captureTidResponse));
+
+    R200Tag responder;
+    TEST_ASSERT_TRUE(r200ParseAccessResponder(frames[0], responder));
+    TEST_ASSERT_EQUAL(12, responder.epcLen);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&captureNoticeA[8], responder.epc, 12);
+}
+
+//==============================================================================
+// TEXT CODEC
+//==============================================================================
+void test_hex_to_bytes()
+{
+    uint8_t bytes[4];
+    TEST_ASSERT_EQUAL(3, r200HexToBytes("e2801A", bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL(0xE2, bytes[0]);
+    TEST_ASSERT_EQUAL(0x1A, bytes[2]);
+
+    // Para no dígito inválido, no dígito sem par e quando o destino enche
+    TEST_ASSERT_EQUAL(1, r200HexToBytes("12G4", bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL(2, r200HexToBytes("12345", bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL(4, r200HexToBytes("00112233445566", bytes, sizeof(bytes)));
+}
+
+void test_text_codec_roundtrip()
+{
+    uint8_t epc[WRITE_PAYLOAD_BYTES];
+    char hex[2 * WRITE_PAYLOAD_BYTES + 1];
+    char text[WRITE_PAYLOAD_BYTES + 1];
+
+    TEST_ASSERT_EQUAL(WRITE_PAYLOAD_BYTES, encodeWritePayload("SENYAR13021", epc, sizeof(epc)));
+    r200BytesToHex(epc, sizeof(epc), hex, sizeof(hex));
+    TEST_ASSERT_EQUAL_STRING("53454E594152313330323100", hex);
+    TEST_ASSERT_EQUAL(11, epcToText(epc, sizeof(epc), text, sizeof(text)));
+    TEST_ASSERT_EQUAL_STRING("SENYAR13021", text);
+
+    // Mais de 12 caracteres: corta nos 96 bits
+    encodeWritePayload("ABCDEFGHIJKLMN", epc, sizeof(epc));
+    epcToText(epc, sizeof(epc), text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("ABCDEFGHIJKL", text);
+}
+
+void test_write_payload_hex_input()
+{
+    uint8_t epc[WRITE_PAYLOAD_BYTES];
+    char hex[2 * WRITE_PAYLOAD_BYTES + 1];
+
+    // Só dígitos hex: é o próprio EPC, completado com zeros à direita
+    encodeWritePayload("e2801a3", epc, sizeof(epc));
+    r200BytesToHex(epc, sizeof(epc), hex, sizeof(hex));
+    TEST_ASSERT_EQUAL_STRING("E2801A300000000000000000", hex);
+
+    // "" limpa o chip (Zero Padding)
+    encodeWritePayload("", epc, sizeof(epc));
+    r200BytesToHex(epc, sizeof(epc), hex, sizeof(hex));
+    TEST_ASSERT_EQUAL_STRING("000000000000000000000000", hex);
+
+    // Destino menor que o payload
+    TEST_ASSERT_EQUAL(4, encodeWritePayload("SKU", epc, 4));
+    TEST_ASSERT_EQUAL(0, epc[3]);
+}
+
+//==============================================================================
+// BENCHMARK
+//==============================================================================
+void test_benchmark_decoder()
+{
+    const size_t rounds = 200000;
+    const size_t framesPerRound = 4;
+    R200Frame frame;
+    R200Tag tag;
+    size_t decoded = 0;
+
+    size_t allocationsBefore = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t r = 0; r < rounds; r++)
+    {
+        uart.inject(captureBurst, sizeof(captureBurst));
+        while (uart.available())
+        {
+            decoder.push(uart.read());
+            while (decoder.next(frame, millis()))
+            {
+                if (frame.cmd == 0x22)
+                    r200ParseTagNotice(frame, tag);
+                decoded++;
+            }
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t allocations = allocationCount - allocationsBefore;
+
+    TEST_ASSERT_EQUAL(rounds * framesPerRound, decoded);
+    char report[160];
+    snprintf(report, sizeof(report), "decoder: %.0f frames/s, %.1f MB/s, %.3f allocations/frame",
+             decoded / seconds, rounds * sizeof(captureBurst) / seconds / 1e6, (double)allocations / decoded);
+    TEST_MESSAGE(report);
+
+    // O caminho quente (remontagem + parse) não pode tocar no heap
+    TEST_ASSERT_EQUAL(0, allocations);
+}
+
+void test_benchmark_text_codec()
+{
+    const size_t rounds = 1000000;
+    uint8_t epc[WRITE_PAYLOAD_BYTES];
+    char hex[2 * WRITE_PAYLOAD_BYTES + 1];
+    char text[WRITE_PAYLOAD_BYTES + 1];
+    size_t checksum = 0;
+
+    size_t allocationsBefore = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+
+    // Caminho de uma tag: payload -> bytes (gravação), bytes -> hex e texto (saída), hex -> bytes
+    for (size_t r = 0; r < rounds; r++)
+    {
+        encodeWritePayload("SENYAR13021", epc, sizeof(epc));
+        r200BytesToHex(epc, sizeof(epc), hex, sizeof(hex));
+        checksum += epcToText(epc, sizeof(epc), text, sizeof(text));
+        checksum += r200HexToBytes(hex, epc, sizeof(epc));
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t allocations = allocationCount - allocationsBefore;
+
+    TEST_ASSERT_EQUAL(rounds * (11 + WRITE_PAYLOAD_BYTES), checksum);
+    char report[160];
+    snprintf(report, sizeof(report), "text codec: %.0f round trips/s, %.3f allocations/round trip",
+             rounds / seconds, (double)allocations / rounds);
+    TEST_MESSAGE(report);
+
+    // Os codecs rodam uma vez por tag: nenhum pode tocar no heap
+    TEST_ASSERT_EQUAL(0, allocations);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_build_frame_checksum);
+    RUN_TEST(test_build_frame_roundtrip);
+    RUN_TEST(test_build_select_params);
+    RUN_TEST(test_build_select_params_refuses_full_epc);
+    RUN_TEST(test_build_tid_select_params);
+    RUN_TEST(test_build_write_params);
+    RUN_TEST(test_query_params_roundtrip);
+    RUN_TEST(test_single_notice);
+    RUN_TEST(test_fragmented_chunks);
+    RUN_TEST(test_back_to_back_burst);
+    RUN_TEST(test_epc_with_marker_bytes);
+    RUN_TEST(test_noise_and_bad_end);
+    RUN_TEST(test_oversized_length);
+    RUN_TEST(test_truncated_then_good);
+    RUN_TEST(test_bad_checksum_rejected);
+    RUN_TEST(test_resync_on_header_inside_bad_frame);
+    RUN_TEST(test_tag_notice_rejects_short_frame);
+    RUN_TEST(test_tid_response);
+    RUN_TEST(test_tid_cross_talk_rejected);
+    RUN_TEST(test_access_responder);
+    RUN_TEST(test_hex_to_bytes);
+    RUN_TEST(test_text_codec_roundtrip);
+    RUN_TEST(test_write_payload_hex_input);
+    RUN_TEST(test_benchmark_decoder);
+    RUN_TEST(test_benchmark_text_codec);
+    return UNITY_END();
+}
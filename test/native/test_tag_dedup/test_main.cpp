@@ -0,0 +1,181 @@
+/**
+ * @file test_main.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Host tests for the time-windowed tag deduplication set.
+ * @date 2026-10-14
+ *
+ * @note Run with `pio test -e native -v`.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "tag_dedup.h"
+
+uint32_t mockMillis = 0;
+
+// 8 slots: at most 6 tags, and short enough to build probe runs by hand
+static TagDedupSlot slots[8];
+static const uint16_t CAPACITY = 8;
+
+void setUp() {}
+void tearDown() {}
+
+/** @brief 4-byte key for tag @p id. */
+static const uint8_t *key(uint32_t id)
+{
+    static uint8_t bytes[4];
+    bytes[0] = id >> 24;
+    bytes[1] = id >> 16;
+    bytes[2] = id >> 8;
+    bytes[3] = id;
+    return bytes;
+}
+
+/** @brief Home slot of tag @p id (same FNV-1a 64 as the set). */
+static uint16_t home(uint32_t id)
+{
+    const uint8_t *bytes = key(id);
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < 4; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return (hash ? hash : 1) & (CAPACITY - 1);
+}
+
+/** @brief Fills @p ids with the first @p count tags whose home slot is @p slot. */
+static void collide(uint16_t slot, uint32_t *ids, uint8_t count)
+{
+    uint32_t id = 1;
+    for (uint8_t n = 0; n < count; id++)
+    {
+        if (home(id) == slot)
+            ids[n++] = id;
+    }
+}
+
+void test_repeat_inside_window_is_suppressed()
+{
+    TagDedup dedup(slots, CAPACITY, 100);
+
+    TEST_ASSERT_FALSE(dedup.checkAndMark(key(1), 4, 0));
+    TEST_ASSERT_TRUE(dedup.checkAndMark(key(1), 4, 50));
+    TEST_ASSERT_FALSE(dedup.checkAndMark(key(2), 4, 50));
+
+    // Each sighting restarts the window: 149 is 99 ms after the refresh at 50
+    TEST_ASSERT_TRUE(dedup.checkAndMark(key(1), 4, 149));
+    TEST_ASSERT_TRUE(dedup.contains(key(1), 4, 248));
+    TEST_ASSERT_EQUAL(1, dedup.size());
+}
+
+void test_repeat_outside_window_is_reported()
+{
+    TagDedup dedup(slots, CAPACITY, 100);
+
+    TEST_ASSERT_FALSE(dedup.checkAndMark(key(1), 4, 0));
+    TEST_ASSERT_FALSE(dedup.checkAndMark(key(1), 4, 100));
+    TEST_ASSERT_TRUE(dedup.checkAndMark(key(1), 4, 150));
+
+    // contains() reports without recording the sighting
+    TEST_ASSERT_FALSE(dedup.contains(key(2), 4, 150));
+    TEST_ASSERT_FALSE(dedup.checkAndMark(key(2), 4, 150));
+    TEST_ASSERT_FALSE(dedup.contains(key(1), 4, 250));
+    TEST_ASSERT_EQUAL(0, dedup.size());
+}
+
+void test_full_set_evicts_least_recently_seen()
+{
+    TagDedup dedup(slots, CAPACITY, 0);
+
+    for (uint32_t id = 1; id <= 6; id++)
+        dedup.mark(key(id), 4, id);
+    TEST_ASSERT_EQUAL(6, dedup.size());
+
+    // A refreshed tag moves to the head, so 2 becomes the oldest
+    TEST_ASSERT_TRUE(dedup.checkAndMark(key(1), 4, 10));
+    TEST_ASSERT_FALSE(dedup.checkAndMark(key(7), 4, 11));
+
+    TEST_ASSERT_EQUAL(6, dedup.size());
+    TEST_ASSERT_FALSE(dedup.contains(key(2), 4, 12));
+    TEST_ASSERT_TRUE(dedup.contains(key(1), 4, 12));
+    TEST_ASSERT_TRUE(dedup.contains(key(3), 4, 12));
+    TEST_ASSERT_TRUE(dedup.contains(key(7), 4, 12));
+
+    // Window 0 never expires: only eviction removes tags
+    TEST_ASSERT_TRUE(dedup.contains(key(3), 4, 1000000));
+}
+
+/** @brief Three tags sharing @p slot; the first one expires out of the middle of the run. */
+static void deleteInsideProbeRun(uint16_t slot)
+{
+    TagDedup dedup(slots, CAPACITY, 100);
+    uint32_t ids[3];
+    collide(slot, ids, 3);
+
+    // Run: ids[0] at its home slot, ids[1] and ids[2] shifted past it
+    dedup.mark(key(ids[0]), 4, 0);
+    dedup.mark(key(ids[1]), 4, 50);
+    dedup.mark(key(ids[2]), 4, 60);
+
+    // ids[0] expires; the other two shift back and must still be found
+    TEST_ASSERT_FALSE(dedup.contains(key(ids[0]), 4, 100));
+    TEST_ASSERT_EQUAL(2, dedup.size());
+    TEST_ASSERT_TRUE(dedup.contains(key(ids[1]), 4, 100));
+    TEST_ASSERT_TRUE(dedup.contains(key(ids[2]), 4, 100));
+
+    // The moved slots keep their LRU links: refresh one, expire the other
+    TEST_ASSERT_TRUE(dedup.checkAndMark(key(ids[1]), 4, 120));
+    TEST_ASSERT_FALSE(dedup.contains(key(ids[2]), 4, 160));
+    TEST_ASSERT_TRUE(dedup.contains(key(ids[1]), 4, 160));
+    TEST_ASSERT_EQUAL(1, dedup.size());
+
+    // A tag inserted after the shifts lands in the run and is found
+    TEST_ASSERT_FALSE(dedup.checkAndMark(key(ids[0]), 4, 170));
+    TEST_ASSERT_TRUE(dedup.contains(key(ids[0]), 4, 170));
+    TEST_ASSERT_TRUE(dedup.contains(key(ids[1]), 4, 170));
+}
+
+void test_delete_inside_probe_run_shifts_back()
+{
+    deleteInsideProbeRun(2);
+}
+
+void test_delete_inside_probe_run_wraps_around()
+{
+    // The run starts at the last slot and continues at slot 0
+    deleteInsideProbeRun(CAPACITY - 1);
+}
+
+void test_mark_hash_restores_a_saved_slot()
+{
+    TagDedup dedup(slots, CAPACITY, 0);
+    dedup.mark(key(42), 4, 0);
+
+    uint64_t saved = 0;
+    for (uint16_t i = 0; i < CAPACITY; i++)
+        if (slots[i].hash != 0)
+            saved = slots[i].hash;
+
+    // Another set, rebuilt from the saved hash alone (as the tag store snapshot does)
+    static TagDedupSlot restoredSlots[8];
+    TagDedup restored(restoredSlots, CAPACITY, 0);
+    restored.markHash(saved, 0);
+    TEST_ASSERT_TRUE(restored.contains(key(42), 4, 1));
+    TEST_ASSERT_FALSE(restored.contains(key(43), 4, 1));
+    TEST_ASSERT_TRUE(restored.checkAndMark(key(42), 4, 2));
+    TEST_ASSERT_EQUAL(1, restored.size());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_repeat_inside_window_is_suppressed);
+    RUN_TEST(test_repeat_outside_window_is_reported);
+    RUN_TEST(test_full_set_evicts_least_recently_seen);
+    RUN_TEST(test_delete_inside_probe_run_shifts_back);
+    RUN_TEST(test_delete_inside_probe_run_wraps_around);
+    RUN_TEST(test_mark_hash_restores_a_saved_slot);
+    return UNITY_END();
+}
@@ -0,0 +1,92 @@
+/**
+ * @file test_main.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Host tests for the SPSC tag report ring.
+ * @date 2026-10-14
+ *
+ * @note Run with `pio test -e native -v`.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "tag_ring.h"
+
+uint32_t mockMillis = 0;
+
+static TagReport slots[8];
+
+void setUp() {}
+void tearDown() {}
+
+static TagReport makeReport(uint8_t id)
+{
+    TagReport report;
+    report.tag.epc[0] = id;
+    report.tag.epcLen = 1;
+    report.tid.len = 0;
+    report.flags = 0;
+    report.endOfSession = false;
+    report.originUs = id;
+    return report;
+}
+
+void test_fifo_order_and_empty()
+{
+    TagRing ring(slots, 8);
+    TagReport out;
+    TEST_ASSERT_FALSE(ring.pop(out));
+
+    for (uint8_t i = 0; i < 3; i++)
+        TEST_ASSERT_TRUE(ring.push(makeReport(i)));
+    TEST_ASSERT_EQUAL(3, ring.size());
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_TRUE(ring.pop(out));
+        TEST_ASSERT_EQUAL(i, out.tag.epc[0]);
+    }
+    TEST_ASSERT_FALSE(ring.pop(out));
+}
+
+void test_full_ring_drops_newest()
+{
+    // Capacidade 8: um slot fica sempre vazio
+    TagRing ring(slots, 8);
+    for (uint8_t i = 0; i < 7; i++)
+        TEST_ASSERT_TRUE(ring.push(makeReport(i)));
+    TEST_ASSERT_FALSE(ring.push(makeReport(99)));
+    TEST_ASSERT_EQUAL(1, ring.dropped());
+    TEST_ASSERT_EQUAL(7, ring.highWater());
+
+    TagReport out;
+    ring.pop(out);
+    TEST_ASSERT_EQUAL(0, out.tag.epc[0]);
+    TEST_ASSERT_TRUE(ring.push(makeReport(7)));
+}
+
+void test_wraparound()
+{
+    TagRing ring(slots, 8);
+    TagReport out;
+    for (uint16_t i = 0; i < 100; i++)
+    {
+        TEST_ASSERT_TRUE(ring.push(makeReport(i & 0xFF)));
+        TEST_ASSERT_TRUE(ring.push(makeReport((i + 1) & 0xFF)));
+        TEST_ASSERT_TRUE(ring.pop(out));
+        TEST_ASSERT_EQUAL(i & 0xFF, out.tag.epc[0]);
+        TEST_ASSERT_TRUE(ring.pop(out));
+        TEST_ASSERT_EQUAL((i + 1) & 0xFF, out.tag.epc[0]);
+    }
+    TEST_ASSERT_EQUAL(0, ring.size());
+    TEST_ASSERT_EQUAL(0, ring.dropped());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_order_and_empty);
+    RUN_TEST(test_full_ring_drops_newest);
+    RUN_TEST(test_wraparound);
+    return UNITY_END();
+}
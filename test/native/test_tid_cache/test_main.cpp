@@ -0,0 +1,61 @@
+/**
+ * @file test_main.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Host tests for the EPC -> TID cache.
+ * @date 2026-10-14
+ *
+ * @note Run with `pio test -e native -v`.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "tid_cache.h"
+
+uint32_t mockMillis = 0;
+
+// EPC de 12 bytes como os das capturas do R200
+static const uint8_t baseEpc[12] = {0xE2, 0x80, 0x68, 0x94, 0x00, 0x00, 0x50, 0x21, 0x3C, 0x4D, 0x17, 0x00};
+
+void setUp() {}
+void tearDown() {}
+
+void test_tid_cache()
+{
+    static TidCacheEntry entries[16];
+    TidCache cache(entries, 16);
+
+    R200Tag tags[20];
+    R200TID tid;
+    for (uint8_t i = 0; i < 20; i++)
+    {
+        memcpy(tags[i].epc, baseEpc, 12);
+        tags[i].epc[11] = i;
+        tags[i].epcLen = 12;
+        tid.bytes[0] = i;
+        tid.len = R200_TID_BYTES;
+        cache.store(tags[i], tid, 1000 + i);
+    }
+
+    // O mais recente sempre está lá; o EPC precisa casar byte a byte
+    TEST_ASSERT_TRUE(cache.lookup(tags[19], tid, 2000));
+    TEST_ASSERT_EQUAL(19, tid.bytes[0]);
+
+    cache.forget(tags[19]);
+    TEST_ASSERT_FALSE(cache.lookup(tags[19], tid, 2001));
+
+    // Chip regravado: o EPC antigo sai pelo TID
+    TEST_ASSERT_TRUE(cache.lookup(tags[18], tid, 2001));
+    cache.forgetTid(tid);
+    TEST_ASSERT_FALSE(cache.lookup(tags[18], tid, 2001));
+
+    cache.clear();
+    TEST_ASSERT_FALSE(cache.lookup(tags[0], tid, 2002));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tid_cache);
+    return UNITY_END();
+}
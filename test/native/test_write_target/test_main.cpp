@@ -0,0 +1,124 @@
+/**
+ * @file test_main.cpp
+ * @author Luis Felipe Patrocinio
+ * @brief Host tests for the write target picker.
+ * @date 2026-10-14
+ *
+ * @note Run with `pio test -e native -v`.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "write_target.h"
+
+uint32_t mockMillis = 0;
+
+static WriteTargetPicker picker(-70, 6);
+
+void setUp() { picker.beginRound(); }
+void tearDown() {}
+
+static R200Tag makeTag(uint8_t id, int8_t rssi)
+{
+    R200Tag tag;
+    memset(tag.epc, 0xE2, 12);
+    tag.epc[11] = id;
+    tag.epcLen = 12;
+    tag.rssi = (uint8_t)rssi;
+    return tag;
+}
+
+void test_empty_round()
+{
+    R200Tag target;
+    TEST_ASSERT_EQUAL(WRITE_TARGET_NONE, picker.pick(target));
+    TEST_ASSERT_EQUAL(0, picker.lead());
+}
+
+void test_single_tag_is_picked()
+{
+    picker.observe(makeTag(1, -50));
+
+    R200Tag target;
+    TEST_ASSERT_EQUAL(WRITE_TARGET_PICKED, picker.pick(target));
+    TEST_ASSERT_EQUAL(1, target.epc[11]);
+}
+
+void test_weak_tag_is_not_a_target()
+{
+    picker.observe(makeTag(1, -75));
+
+    R200Tag target;
+    TEST_ASSERT_EQUAL(WRITE_TARGET_NONE, picker.pick(target));
+}
+
+void test_strongest_wins_regardless_of_order()
+{
+    // A vizinha responde primeiro, mas a tag na antena se destaca
+    picker.observe(makeTag(1, -62));
+    picker.observe(makeTag(2, -45));
+    picker.observe(makeTag(3, -68));
+
+    R200Tag target;
+    TEST_ASSERT_EQUAL(WRITE_TARGET_PICKED, picker.pick(target));
+    TEST_ASSERT_EQUAL(2, target.epc[11]);
+    TEST_ASSERT_EQUAL(17, picker.lead());
+    TEST_ASSERT_EQUAL(3, picker.candidates());
+}
+
+void test_close_pair_is_ambiguous()
+{
+    picker.observe(makeTag(1, -50));
+    picker.observe(makeTag(2, -53));
+
+    R200Tag target;
+    TEST_ASSERT_EQUAL(WRITE_TARGET_AMBIGUOUS, picker.pick(target));
+}
+
+void test_neighbour_below_floor_still_counts()
+{
+    picker.observe(makeTag(1, -68));
+    picker.observe(makeTag(2, -72));
+
+    R200Tag target;
+    TEST_ASSERT_EQUAL(WRITE_TARGET_AMBIGUOUS, picker.pick(target));
+}
+
+void test_repeated_notices_merge()
+{
+    // A mesma tag respondendo duas vezes não é uma segunda candidata
+    picker.observe(makeTag(1, -55));
+    picker.observe(makeTag(1, -48));
+
+    R200Tag target;
+    TEST_ASSERT_EQUAL(WRITE_TARGET_PICKED, picker.pick(target));
+    TEST_ASSERT_EQUAL(1, picker.candidates());
+    TEST_ASSERT_EQUAL(-48, (int8_t)target.rssi);
+}
+
+void test_full_round_keeps_the_strongest()
+{
+    for (uint8_t i = 0; i < WRITE_TARGET_CANDIDATES + 4; i++)
+        picker.observe(makeTag(i, -80 + i));
+    picker.observe(makeTag(99, -40));
+
+    R200Tag target;
+    TEST_ASSERT_EQUAL(WRITE_TARGET_CANDIDATES, picker.candidates());
+    TEST_ASSERT_EQUAL(WRITE_TARGET_PICKED, picker.pick(target));
+    TEST_ASSERT_EQUAL(99, target.epc[11]);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_round);
+    RUN_TEST(test_single_tag_is_picked);
+    RUN_TEST(test_weak_tag_is_not_a_target);
+    RUN_TEST(test_strongest_wins_regardless_of_order);
+    RUN_TEST(test_close_pair_is_ambiguous);
+    RUN_TEST(test_neighbour_below_floor_still_counts);
+    RUN_TEST(test_repeated_notices_merge);
+    RUN_TEST(test_full_round_keeps_the_strongest);
+    return UNITY_END();
+}